@@ -0,0 +1,212 @@
+/** doris_ingestd: watch directories for incoming DORIS RINEX files and, for
+ *  each new file:
+ *    1. parse its header,
+ *    2. write its data blocks to a binary (columnar) archive,
+ *    3. run basic quality checks, and
+ *    4. append a line to the catalog (OUTDIR/catalog.txt).
+ *
+ *  Files are processed on a pool of threads, with bounded concurrency.
+ *  Stops (after processing files already queued) on SIGINT or SIGTERM.
+ */
+#include <getopt.h>
+#include <signal.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "doris_rinex.hpp"
+#include "doris_rinex_archive.hpp"
+#include "doris_rinex_watch.hpp"
+
+using namespace dso;
+
+namespace {
+
+/* the watcher, so that signal handlers can stop it */
+doris_rnx::DirectoryWatcher *g_watcher = nullptr;
+
+void on_signal(int) {
+  if (g_watcher) g_watcher->stop();
+}
+
+/* Basic quality checks of a file's data blocks */
+struct QualityStats {
+  long m_epochs{0};
+  long m_observations{0};
+  long m_missing{0};
+  /* epochs with an epoch flag > 0 */
+  long m_flagged_epochs{0};
+  /* epochs not later than the previous one */
+  long m_out_of_order{0};
+  Datetime<nanoseconds> m_first, m_last;
+
+  void add(const doris_rnx::DataBlock &block,
+           const std::vector<int> &scale_factors) noexcept {
+    const auto &t = block.mheader.m_epoch;
+    if (!m_epochs) m_first = t;
+    if (m_epochs && !(m_last < t)) ++m_out_of_order;
+    m_last = t;
+    ++m_epochs;
+    m_flagged_epochs += (block.mheader.m_flag > 0);
+    for (const auto &bobs : block.mbeacon_obs) {
+      for (std::size_t k = 0; k < bobs.m_values.size(); k++) {
+        ++m_observations;
+        m_missing += (bobs.m_values[k].m_value ==
+                      doris_rnx::OBSERVATION_VALUE_MISSING / scale_factors[k]);
+      }
+    }
+  }
+}; /* struct QualityStats */
+
+/* Epoch as "MJD SECONDS_OF_DAY" */
+std::string epoch_str(const Datetime<nanoseconds> &t) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%ld %.9f",
+                (long)t.imjd().as_underlying_type(),
+                (double)t.sec().as_underlying_type() /
+                    nanoseconds::sec_factor<double>());
+  return buf;
+}
+
+/* Name of file at path, without directories and .Z/.gz extensions */
+std::string base_name(const std::string &path) {
+  std::string name = path.substr(path.find_last_of('/') + 1);
+  for (const char *ext : {".Z", ".gz"}) {
+    const std::size_t n = std::strlen(ext);
+    if (name.size() > n && !name.compare(name.size() - n, n, ext))
+      name.erase(name.size() - n);
+  }
+  return name;
+}
+
+class Ingestor {
+  std::string m_outdir;
+  std::mutex m_catalog_mtx;
+  std::ofstream m_catalog;
+
+ public:
+  explicit Ingestor(const std::string &outdir)
+      : m_outdir(outdir),
+        m_catalog(outdir + "/catalog.txt", std::ios_base::app) {
+    if (!m_catalog.is_open()) {
+      throw std::runtime_error("[ERROR] Failed opening catalog in " + outdir +
+                               "\n");
+    }
+  }
+
+  void operator()(const std::string &path, DorisObsRinex &rnx) {
+    const std::string archive = m_outdir + "/" + base_name(path) + ".rnxa";
+    std::ofstream fout(archive, std::ios_base::binary | std::ios_base::trunc);
+    if (!fout.is_open())
+      throw std::runtime_error("[ERROR] Failed opening " + archive + "\n");
+
+    /* a file failing (e.g. a bad data block) leaves no partial archive */
+    QualityStats qc;
+    try {
+      doris_rnx::ArchiveWriter writer(fout, rnx.header());
+      const auto &scale_factors = rnx.header().obs_scale_factors();
+      for (auto it = rnx.begin(); it != rnx.end(); ++it) {
+        qc.add(*it, scale_factors);
+        if (writer.append(*it))
+          throw std::runtime_error("[ERROR] Failed writing " + archive + "\n");
+      }
+      if (writer.flush() || !fout.flush())
+        throw std::runtime_error("[ERROR] Failed writing " + archive + "\n");
+    } catch (...) {
+      fout.close();
+      std::remove(archive.c_str());
+      throw;
+    }
+
+    /* file satellite first-epoch last-epoch epochs observations missing
+     * flagged-epochs out-of-order archive
+     */
+    std::lock_guard<std::mutex> lock(m_catalog_mtx);
+    m_catalog << path << '\t' << rnx.satellite_name() << '\t'
+              << (qc.m_epochs ? epoch_str(qc.m_first) : "-") << '\t'
+              << (qc.m_epochs ? epoch_str(qc.m_last) : "-") << '\t'
+              << qc.m_epochs << '\t' << qc.m_observations << '\t'
+              << qc.m_missing << '\t' << qc.m_flagged_epochs << '\t'
+              << qc.m_out_of_order << '\t' << archive << '\n';
+    m_catalog.flush();
+    if (qc.m_out_of_order) {
+      fprintf(stderr, "[WRNNG] %ld epochs out of order in %s\n",
+              qc.m_out_of_order, path.c_str());
+    }
+  }
+}; /* class Ingestor */
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [-o OUTDIR] [-j THREADS] [-q MAX_PENDING] [-e] DIR "
+          "[DIR ...]\n"
+          "  -o OUTDIR      where archives and the catalog are written "
+          "(default: .)\n"
+          "  -j THREADS     number of worker threads (default: one per core)\n"
+          "  -q MAX_PENDING max number of files waiting to be processed\n"
+          "  -e             also process files already in the directories\n",
+          prog);
+}
+
+} /* unnamed namespace */
+
+int main(int argc, char *argv[]) {
+  std::string outdir = ".";
+  doris_rnx::WatchOptions opts;
+  int c;
+  while ((c = getopt(argc, argv, "o:j:q:eh")) != -1) {
+    switch (c) {
+      case 'o':
+        outdir = optarg;
+        break;
+      case 'j':
+        opts.m_num_threads = std::atoi(optarg);
+        break;
+      case 'q':
+        opts.m_max_pending = std::atoi(optarg);
+        break;
+      case 'e':
+        opts.m_scan_existing = true;
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    Ingestor ingestor(outdir);
+    doris_rnx::DirectoryWatcher watcher(
+        std::vector<std::string>(argv + optind, argv + argc),
+        [&ingestor](const std::string &path, DorisObsRinex &rnx) {
+          ingestor(path, rnx);
+        },
+        opts);
+
+    g_watcher = &watcher;
+    struct sigaction sa;
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    const int failed = watcher.run();
+    g_watcher = nullptr;
+    printf("Processed %ld files, %d failed\n", watcher.files_processed(),
+           failed);
+    return failed ? 2 : 0;
+  } catch (std::exception &e) {
+    fprintf(stderr, "%s", e.what());
+    return 1;
+  }
+}
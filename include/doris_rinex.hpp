@@ -1,117 +1,155 @@
 #ifndef __DSO_DORIS_RINEX_V3_HPP__
 #define __DSO_DORIS_RINEX_V3_HPP__
 
-#include <fstream>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
+#include "doris_rinex_cursor.hpp"
 #include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+#include "doris_rinex_source.hpp"
 #include "obstypes.hpp"
 
 namespace dso {
 
-/** @class DorisObsRinex
- *  @brief A class to hold DORIS Observation RINEX files for reading.
- *  @see RINEX DORIS 3.0 (Issue 1.7),
- *       ftp://ftp.ids-doris.org/pub/ids/data/RINEX_DORIS.pdf
+class DorisObsRinex;
+
+namespace doris_rnx {
+/* incremental decoder of compact RINEX data blocks */
+class CompactDecoder;
+/* validation policy of DorisObsReader (see doris_rinex_policy.hpp) */
+struct Checked;
+
+/** @class Checkpoint
+ *  @brief The position of a DorisObsRinex reader, i.e. where the next data
+ *         block starts, so that reading can be resumed later (e.g. by
+ *         another process) without re-scanning the file.
+ *
+ *  A checkpoint holds the byte offset of the next data block, the epoch of
+ *  the last block read and the fingerprint of the file's header. It can be
+ *  stored as a fixed-size, little-endian byte string (see serialize()).
  */
-class DorisObsRinex {
+class Checkpoint {
+  friend class dso::DorisObsRinex;
+
+  /* fingerprint of the header (see DorisRinexHeader::fingerprint()) */
+  std::uint64_t m_fingerprint{0};
+  /* byte offset of the next data block */
+  std::int64_t m_offset{-1};
+  /* epoch of the last block read (if m_has_epoch) */
+  Datetime<nanoseconds> m_last_epoch;
+  /* false if no block was read yet */
+  bool m_has_epoch{false};
+  /* true if all blocks were read */
+  bool m_at_end{false};
+
  public:
-  /* Let's not write this more than once. */
-  typedef std::ifstream::pos_type pos_type;
+  /* Size of a serialized checkpoint in bytes */
+  static constexpr std::size_t SERIALIZED_SIZE{32};
 
-  /* No header line can have more than 80 chars. */
-  static constexpr int MAX_HEADER_CHARS{81};
+  /* @brief True if all data blocks were read when the checkpoint was taken */
+  bool at_end() const noexcept { return m_at_end; }
 
-  /* No record line can have more than 3+5*16=83 chars */
-  static constexpr int MAX_RECORD_CHARS{124};
+  /* @brief True if at least one data block was read (i.e. last_epoch() is
+   * valid)
+   */
+  bool has_last_epoch() const noexcept { return m_has_epoch; }
 
- private:
-  /* The name of the file */
-  std::string m_filename;
-  /* The infput (file) stream; open at construction */
-  std::ifstream m_stream;
-  /* RINEX version */
-  float m_version;
+  /* @brief Epoch of the last data block read */
+  Datetime<nanoseconds> last_epoch() const noexcept { return m_last_epoch; }
 
-  char m_char_pool[256];
-  /* Satellite name */
-  static constexpr int m_satellite_name_at = 0;  // [60]
-  /* COSPAR number */
-  static constexpr int m_cospar_number_at = 60;  // [20]
-  /* DORIS chain used (chain1 or chain2), exp. “CHAIN1” */
-  static constexpr int m_rec_chain_at = 80;  // [20]
-  /* DORIS instrument type; exp. “DGXX” */
-  static constexpr int m_rec_type_at = 100;  // [20]
-  /* The software version used on board DORIS/DIODE, exp. “1.00” */
-  static constexpr int m_rec_version_at = 120;  // [20]
-  /* The antenna type is “STAREC” */
-  static constexpr int m_antenna_type_at = 140;  // [20]
-  /* The antenna number is “DORIS” */
-  static constexpr int m_antenna_number_at = 160;  // [20]
+  /* @brief Byte offset of the next data block (-1 if at_end()) */
+  std::int64_t offset() const noexcept { return m_offset; }
 
-  /* Position of 2 GHz phase center, in the platform reference frame (Units:
-   * Meters, System: ITRS recommended)
-   */
-  float m_approx_position[3];
+  /* @brief Write the checkpoint to buf (SERIALIZED_SIZE bytes) */
+  void serialize(char *buf) const noexcept;
 
-  /** The center of mass of the vehicle (for space borne receivers):
-   *  CENTER OF MASS: XYZ, defined at the beginning of the mission.
+  /** @brief Read a checkpoint off buf (SERIALIZED_SIZE bytes), as written
+   *  by serialize().
+   *  @return Anything other than 0 denotes an error (i.e. buf does not hold
+   *          a checkpoint).
    */
-  float m_center_mass[3];
+  int deserialize(const char *buf) noexcept;
+}; /* class Checkpoint */
 
-  /* A vector of ObservationCode contained in the RINEX file */
-  std::vector<DorisObservationCode> m_obs_codes;
-
-  /** A vector of scale factors corresponding to m_obs_codes (aka they have
-   *  the same size with a one-to-one correspondance
+/* A byte range skipped while reading in lenient mode */
+struct SkippedRange {
+  /* offset of the first byte skipped (i.e. start of the bad data block, or
+   * where the error was found if the source cannot seek back); -1 if unknown
    */
-  std::vector<int> m_obs_scale_factors;
-
-  /* Datetime of first observation in RINEX */
-  Datetime<nanoseconds> m_time_of_first_obs;
-
-  /** This date corresponds to the day of the first measurement performed on
-   *  the first time reference beacon in the DORIS RINEX product, at
-   *  00h 00mn 00s.
+  std::int64_t m_begin;
+  /* offset of the first byte not skipped (i.e. next record line or EOF);
+   * -1 if unknown
    */
-  Datetime<nanoseconds> m_time_ref_stat;
+  std::int64_t m_end;
+  /* the error returned when reading the bad data block (> 0) */
+  int m_error;
+}; /* struct SkippedRange */
 
-  /** Constant shift between the date of the 400MHz phase measurement and the
-   *  date of the 2GHz phase measurement in microseconds. Positive if the
-   *  measurement of phase 400 MHz is performed after the measurement of phase
-   *  2 GHz
-   */
-  double m_l12_date_offset;
+/** @brief Called for every byte range skipped in lenient mode; ranges are
+ *  reported in order, from the thread reading the file.
+ */
+using error_sink = std::function<void(const SkippedRange &)>;
+} /* namespace doris_rnx */
 
-  /** Epoch, code, and phase are corrected by applying the realtime-derived
-   *  receiver clock offset: 1=yes, 0=no; default: 0=no
-   */
-  bool rcv_clock_offs_appl{false};
+/* policy-based reader (see doris_rinex_policy.hpp) */
+template <typename Validation = doris_rnx::Checked> class DorisObsReader;
 
-  /* List of stations/beacons recorded in file */
-  std::vector<doris_rnx::Beacon> m_stations;
+/** @class DorisObsRinex
+ *  @brief A class to hold DORIS Observation RINEX files for reading.
+ *  @see RINEX DORIS 3.0 (Issue 1.7),
+ *       ftp://ftp.ids-doris.org/pub/ids/data/RINEX_DORIS.pdf
+ */
+class DorisObsRinex {
+ public:
+  /* Let's not write this more than once. */
+  typedef std::istream::pos_type pos_type;
 
-  /* List of time-reference stations in file (also included in m_stations) */
-  std::vector<doris_rnx::TimeReferenceStation> m_ref_stations;
+  /* No header line can have more than 80 chars. */
+  static constexpr int MAX_HEADER_CHARS{DorisRinexHeader::MAX_HEADER_CHARS};
 
-  /* Mark the 'END OF HEADER' field (next line is record line) */
-  pos_type m_end_of_head;
+  /* No record line can have more than 3+5*16=83 chars */
+  static constexpr int MAX_RECORD_CHARS{124};
 
-  /** Depending on the number of observables, compute the number of lines
-   * needed to hold a full data record (i.e. within a data block). Each data
-   * line can hold up to 5 observable values.
+ private:
+  /* The name of the file (or a description of the input source) */
+  std::string m_filename;
+  /* True if the data is read off a named file (m_filename) */
+  bool m_from_file{false};
+  /* The input source the stream reads from; owned */
+  std::unique_ptr<std::streambuf> m_source;
+  /* The input stream, reading off m_source; open at construction */
+  std::istream m_stream{nullptr};
+  /* The (immutable) header, shared with any cursor created off this file */
+  std::shared_ptr<const DorisRinexHeader> m_header;
+  /* A read-only mapping of the file, created the first time it is needed
+   * (i.e. when a cursor is requested) and shared by all cursors
    */
-  int lines_per_beacon() const noexcept {
-    const int obs = m_obs_codes.size();
-    return 1 + (!(obs % 5) ? (obs / 5 - 1) : (obs / 5));
-  }
+  std::shared_ptr<const doris_rnx::MappedFile> m_map;
+  /* The decoder of data blocks, for compact RINEX files (else null) */
+  std::unique_ptr<doris_rnx::CompactDecoder> m_compact;
+  /* True if the header was read successfully */
+  bool m_header_ok{false};
+  /* Skip bad data blocks, instead of failing (see set_lenient()) */
+  bool m_lenient{false};
+  /* Where byte ranges skipped in lenient mode are reported (may be empty) */
+  doris_rnx::error_sink m_error_sink;
+
+  /** @brief Read the header off the stream (called at construction). On
+   *  failure, errors are reported but the instance is still constructed.
+   *
+   *  @param[in] is_open Whether the input source was opened successfully
+   */
+  void load_header(bool is_open) noexcept;
 
   /** @brief Clear the stream and go to END OF HEADER */
-  void goto_data_block() noexcept {m_stream.clear(); m_stream.seekg(m_end_of_head);}
-
-  /** @brief Read the RINEX's header, and collect all metadata */
-  int read_header() noexcept;
+  void goto_data_block() noexcept;
 
   /** @brief Read next data block and store it in block.
    *
@@ -122,43 +160,124 @@ class DorisObsRinex {
    */
   int get_next_data_block(doris_rnx::DataBlock &block) noexcept;
 
-  char *satellite_name() noexcept { return m_char_pool + m_satellite_name_at; }
-  char *cospar_number() noexcept { return m_char_pool + m_cospar_number_at; }
-  char *rec_chain() noexcept { return m_char_pool + m_rec_chain_at; }
-  char *rec_type() noexcept { return m_char_pool + m_rec_type_at; }
-  char *rec_version() noexcept { return m_char_pool + m_rec_version_at; }
-  char *antenna_type() noexcept { return m_char_pool + m_antenna_type_at; }
-  char *antenna_number() noexcept { return m_char_pool + m_antenna_number_at; }
+  /** @brief After failing (with error) to read a data block starting at
+   *  start, skip to the next record line and report the skipped range.
+   *
+   *  @return 0 if a record line was found (the stream is placed there), else
+   *          (i.e. EOF) -1.
+   */
+  int resynchronise(pos_type start, int error) noexcept;
+
+  /** @brief Called when EOF is met while reading data blocks.
+   *
+   *  @return -1 if the input source ended cleanly; else (e.g. corrupt
+   *          compressed data) the failure is reported and a positive value
+   *          is returned.
+   */
+  int end_of_data() noexcept;
+
+  /* the policy-based reader reads off the stream directly */
+  template <typename Validation> friend class DorisObsReader;
 
  public:
+  /* @brief The (immutable) header of the RINEX file */
+  const DorisRinexHeader &header() const noexcept { return *m_header; }
+
+  /** @brief True if the header was read successfully; if not (errors were
+   *  reported at construction), no data blocks can be read off the instance.
+   */
+  bool header_ok() const noexcept { return m_header_ok; }
+
+  /* @brief The header, in a form that can be shared (e.g. across threads) */
+  std::shared_ptr<const DorisRinexHeader> shared_header() const noexcept {
+    return m_header;
+  }
+
   const char *satellite_name() const noexcept {
-    return m_char_pool + m_satellite_name_at;
+    return m_header->satellite_name();
   }
   const char *cospar_number() const noexcept {
-    return m_char_pool + m_cospar_number_at;
-  }
-  const char *rec_chain() const noexcept {
-    return m_char_pool + m_rec_chain_at;
-  }
-  const char *rec_type() const noexcept { return m_char_pool + m_rec_type_at; }
-  const char *rec_version() const noexcept {
-    return m_char_pool + m_rec_version_at;
+    return m_header->cospar_number();
   }
+  const char *rec_chain() const noexcept { return m_header->rec_chain(); }
+  const char *rec_type() const noexcept { return m_header->rec_type(); }
+  const char *rec_version() const noexcept { return m_header->rec_version(); }
   const char *antenna_type() const noexcept {
-    return m_char_pool + m_antenna_type_at;
+    return m_header->antenna_type();
   }
   const char *antenna_number() const noexcept {
-    return m_char_pool + m_antenna_number_at;
+    return m_header->antenna_number();
+  }
+
+  /** @brief Switch lenient mode on or off.
+   *
+   *  In lenient mode, a data block that cannot be read (e.g. a malformed or
+   *  truncated line) does not stop the iteration; instead, the stream skips
+   *  to the next line starting with '>' and reading resumes there. Each
+   *  skipped byte range is reported to sink (if given). Skipping starts from
+   *  the bad block's record line, so the following block is not lost, unless
+   *  the source cannot seek back (then, skipping starts from where the error
+   *  was found).
+   *
+   *  Not available for compact RINEX files (their blocks depend on the
+   *  previous ones); there, this has no effect.
+   */
+  void set_lenient(bool lenient, doris_rnx::error_sink sink = nullptr) {
+    m_lenient = lenient;
+    m_error_sink = std::move(sink);
   }
 
+  /* @brief True if in lenient mode */
+  bool lenient() const noexcept { return m_lenient; }
+
+  /** @brief Create a cursor to read data blocks off the file.
+   *
+   *  Only available if the instance was constructed from a (named,
+   *  uncompressed, non-compact) file; else an std::runtime_error is thrown.
+   *
+   *  The file is mapped to memory the first time this function is called;
+   *  the mapping and the header are shared by all cursors created, but each
+   *  cursor keeps its own position. Hence, cursors can be handed to
+   *  different threads, to scan (different parts of) the file concurrently.
+   *  Reading through a cursor does not affect the position of this instance
+   *  (or its iterators).
+   *
+   *  @note This function is not thread-safe; create the cursors first and
+   *        then hand them to worker threads.
+   */
+  DorisRinexCursor cursor();
+
   /* @brief Constructor from filename
    *
-   * The c'tor will open the and call read_header(), which will parse through
-   * the RINEXE's header all get all info.
+   * The c'tor will open the and call DorisRinexHeader::read(), which will
+   * parse through the RINEXE's header all get all info.
    * If it fails, an exception will be thrown.
+   * Unix-compressed (.Z) and gzipped (.gz) files are detected by their magic
+   * bytes, and decompressed while streaming (no temporary files); note that
+   * such files can only be iterated once, and cannot be seeked.
+   * Compact RINEX files (see doris_rinex_compact.hpp) are detected by their
+   * header; their data blocks are decoded one at a time, while iterating.
+   * They cannot be iterated backwards.
    */
   explicit DorisObsRinex(const char *);
 
+  /* @brief Constructor from any input source
+   *
+   * The data is read off the given source (which can be e.g. an
+   * doris_rnx::FdSource over a pipe or stdin, an doris_rnx::MemorySource
+   * over a memory buffer, a doris_rnx::ReaderSource pulling from a
+   * user-supplied reader, or any other std::streambuf). Compressed data
+   * (.Z or .gz) are detected and decompressed while streaming. The header is
+   * read at construction, as for the constructor from filename.
+   * Note that iterating more than once, seeking and reverse iteration need
+   * a seekable source.
+   *
+   * @param[in] source The input source; ownership is taken
+   * @param[in] name   A name for the source, used in error messages
+   */
+  explicit DorisObsRinex(std::unique_ptr<std::streambuf> source,
+                         const char *name = "(input source)");
+
   /* @brief Destructor */
   ~DorisObsRinex() noexcept;  // = default;
 
@@ -169,12 +288,10 @@ class DorisObsRinex {
   DorisObsRinex &operator=(const DorisObsRinex &) = delete;
 
   /* @brief Move Constructor. */
-  DorisObsRinex(DorisObsRinex &&a) noexcept(
-      std::is_nothrow_move_constructible<std::ifstream>::value) = default;
+  DorisObsRinex(DorisObsRinex &&a) noexcept;
 
   /* @brief Move assignment operator. */
-  DorisObsRinex &operator=(DorisObsRinex &&a) noexcept(
-      std::is_nothrow_move_assignable<std::ifstream>::value) = default;
+  DorisObsRinex &operator=(DorisObsRinex &&a) noexcept;
 
   /** @brief A data block iterator, enables e.g.:
    * for (auto it = rnx.begin(); it != rnx.end(); ++it) { ... }
@@ -218,9 +335,12 @@ class DorisObsRinex {
     }
 
    private:
-    /* private c'tor */
-    explicit iterator(DorisObsRinex &rnx) : m_rnx(&rnx), m_current() {
-      m_rnx->goto_data_block();
+    /* private c'tor; if rewind is false, iteration starts from the current
+     * position of the stream (which must be at the start of a data block).
+     */
+    explicit iterator(DorisObsRinex &rnx, bool rewind = true)
+        : m_rnx(&rnx), m_current() {
+      if (rewind) m_rnx->goto_data_block();
       ++(*this);
     }
 
@@ -230,8 +350,137 @@ class DorisObsRinex {
     doris_rnx::DataBlock m_current;
   }; /* struct iterator */
 
+  /** @brief A bidirectional data block iterator, enables e.g.:
+   * for (auto it = rnx.bbegin(); it != rnx.bend(); ++it) { ... }
+   * auto last = --rnx.bend();
+   *
+   * Each instance keeps track of the byte offset of the block it points to,
+   * and repositions the (shared) stream before reading. Going backwards is
+   * done by locating the preceding line starting with '>', so there is no
+   * need to cache any blocks.
+   * Decrementing an iterator pointing to the first block, gives bend().
+   */
+  struct bidirectional_iterator {
+    /*  typenames */
+    using value_type = doris_rnx::DataBlock;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = const doris_rnx::DataBlock *;
+    using reference = const doris_rnx::DataBlock &;
+
+    /* make DorisObsRinex class friend */
+    friend class DorisObsRinex;
+
+    /* invalid (singular) iterator */
+    bidirectional_iterator() noexcept = default;
+
+    /* iterator-like behaviour (dereferencing, ...) */
+    reference operator*() const noexcept { return m_current; }
+    pointer operator->() const noexcept { return &m_current; }
+    bidirectional_iterator &operator++();
+    bidirectional_iterator &operator--();
+    bidirectional_iterator operator++(int) {
+      auto t = *this;
+      ++(*this);
+      return t;
+    }
+    bidirectional_iterator operator--(int) {
+      auto t = *this;
+      --(*this);
+      return t;
+    }
+
+    /* @brief Byte offset of the current block (invalid for bend()) */
+    pos_type offset() const noexcept { return m_pos; }
+
+    /* Iterators pointing to the same block of the same instance are equal */
+    friend bool operator==(const bidirectional_iterator &a,
+                           const bidirectional_iterator &b) noexcept {
+      return a.m_rnx == b.m_rnx && a.m_pos == b.m_pos;
+    }
+    friend bool operator!=(const bidirectional_iterator &a,
+                           const bidirectional_iterator &b) noexcept {
+      return !(a == b);
+    }
+
+   private:
+    /* private c'tor; if pos is invalid, the iterator is rnx.bend() */
+    bidirectional_iterator(DorisObsRinex &rnx, pos_type pos)
+        : m_rnx(&rnx), m_pos(pos), m_current() {
+      if (m_pos != pos_type(std::streamoff(-1))) read_at(m_pos);
+    }
+
+    /* read the block starting at byte offset pos */
+    void read_at(pos_type pos);
+
+    /* 'parent' DorisObsRinex instance */
+    DorisObsRinex *m_rnx = nullptr;
+    /* byte offset of current data block */
+    pos_type m_pos = pos_type(std::streamoff(-1));
+    /* byte offset of next data block */
+    pos_type m_next = pos_type(std::streamoff(-1));
+    /* current data block */
+    doris_rnx::DataBlock m_current;
+  }; /* struct bidirectional_iterator */
+
+  /** @brief A reverse data block iterator; walks the blocks from EOF
+   *  backwards, e.g.:
+   * for (auto it = rnx.rbegin(); it != rnx.rend(); ++it) { ... }
+   *
+   * Note that, contrary to std::reverse_iterator, dereferencing gives the
+   * block the underlying bidirectional_iterator points to.
+   */
+  struct reverse_iterator {
+    /*  typenames */
+    using value_type = doris_rnx::DataBlock;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = const doris_rnx::DataBlock *;
+    using reference = const doris_rnx::DataBlock &;
+
+    reverse_iterator() noexcept = default;
+    explicit reverse_iterator(bidirectional_iterator it) : m_it(std::move(it)) {}
+
+    reference operator*() const noexcept { return *m_it; }
+    pointer operator->() const noexcept { return m_it.operator->(); }
+    reverse_iterator &operator++() {
+      --m_it;
+      return *this;
+    }
+    reverse_iterator &operator--() {
+      ++m_it;
+      return *this;
+    }
+    reverse_iterator operator++(int) {
+      auto t = *this;
+      ++(*this);
+      return t;
+    }
+    reverse_iterator operator--(int) {
+      auto t = *this;
+      --(*this);
+      return t;
+    }
+
+    /* @brief the underlying bidirectional_iterator */
+    const bidirectional_iterator &base() const noexcept { return m_it; }
+
+    friend bool operator==(const reverse_iterator &a,
+                           const reverse_iterator &b) noexcept {
+      return a.m_it == b.m_it;
+    }
+    friend bool operator!=(const reverse_iterator &a,
+                           const reverse_iterator &b) noexcept {
+      return !(a == b);
+    }
+
+   private:
+    bidirectional_iterator m_it;
+  }; /* struct reverse_iterator */
+
   /* lvalue-only begin/end (safe) */
-  iterator begin() & noexcept { return iterator{*this}; }
+  /* begin() reads the first block; throws as iterator::operator++ does */
+  iterator begin() & { return iterator{*this}; }
   iterator end() & noexcept { return iterator{}; }
 
   /* forbid begin()/end() on temporaries
@@ -243,6 +492,66 @@ class DorisObsRinex {
   iterator begin() const && = delete;
   iterator end() const && = delete;
 
+  /* lvalue-only bidirectional/reverse iterators */
+  bidirectional_iterator bbegin() & {
+    return bidirectional_iterator{*this, m_header->end_of_header()};
+  }
+  bidirectional_iterator bend() & noexcept {
+    return bidirectional_iterator{*this, pos_type(std::streamoff(-1))};
+  }
+  reverse_iterator rbegin() & { return reverse_iterator{--bend()}; }
+  reverse_iterator rend() & noexcept { return reverse_iterator{bend()}; }
+  bidirectional_iterator bbegin() && = delete;
+  bidirectional_iterator bend() && = delete;
+  reverse_iterator rbegin() && = delete;
+  reverse_iterator rend() && = delete;
+
+  /** @brief Get an iterator to the first data block with an epoch equal to
+   *         or later than t.
+   *
+   *  No (prebuilt) index is needed; the data section of the file is bisected
+   *  on byte offsets, hence the search is logarithmic in the file size.
+   *  Compact RINEX files can only be decoded in order, so for them blocks
+   *  are scanned linearly.
+   *
+   *  @param[in] t The epoch to search for
+   *  @return An iterator to the data block found, or end() if no such block
+   *          exists.
+   */
+  iterator seek(const Datetime<nanoseconds> &t) &;
+  iterator seek(const Datetime<nanoseconds> &t) && = delete;
+
+  /** @brief Take a checkpoint of the reading position, i.e. the data block
+   *         after the one it points to.
+   *
+   *  it must be the iterator currently reading off the instance (i.e. the
+   *  instance's stream must not have been moved since it was last
+   *  advanced). If it is end(), the checkpoint marks that all blocks were
+   *  read.
+   *
+   *  Not available for compact RINEX files (resuming them would need the
+   *  state of the decoder); an std::runtime_error is thrown.
+   */
+  doris_rnx::Checkpoint checkpoint(const iterator &it) &;
+  doris_rnx::Checkpoint checkpoint(const iterator &it) && = delete;
+
+  /** @brief Resume reading from a checkpoint.
+   *
+   *  The stream is placed at the offset stored in the checkpoint and the
+   *  block there is read; nothing before it is parsed. If the source cannot
+   *  seek (e.g. compressed files), the data up to the offset is skipped.
+   *
+   *  @param[in] cp A checkpoint, taken off this or another instance
+   *                reading the same file
+   *  @return An iterator to the first block after the checkpoint, or end()
+   *          if all blocks were read.
+   *  @throw std::runtime_error if the header of the file does not match the
+   *         checkpoint, the data at the stored offset is not the expected
+   *         data block, or the file is a compact RINEX file.
+   */
+  iterator resume(const doris_rnx::Checkpoint &cp) &;
+  iterator resume(const doris_rnx::Checkpoint &cp) && = delete;
+
 }; /* class DorisObsRinex */
 
 } /* namespace dso */
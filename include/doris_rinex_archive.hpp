@@ -0,0 +1,244 @@
+#ifndef __DSO_DORIS_RINEX_ARCHIVE_HPP__
+#define __DSO_DORIS_RINEX_ARCHIVE_HPP__
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+#include "obstypes.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Default number of epochs (data blocks) per archive chunk */
+static constexpr int DEFAULT_ARCHIVE_CHUNK_EPOCHS = 1024;
+
+/** Columnar archive of DORIS observations
+ *
+ *  A compressed binary format for long-term storage of the data blocks of a
+ *  DORIS RINEX file (i.e. as produced by DorisObsRinex iterators). Data
+ *  blocks are grouped in chunks of consecutive epochs; within a chunk, data
+ *  are stored per column:
+ *  - epochs, as a regular grid plus exceptions (integer nanoseconds),
+ *  - epoch/clock flags, run-length encoded,
+ *  - receiver clock offsets, XOR-compressed,
+ *  - the beacons of each epoch (a per-chunk table, plus the beacon list of
+ *    each epoch, if different from the previous one),
+ *  - per beacon and observable, the series of values: integer-valued
+ *    (i.e. RINEX F14.3) series are stored as delta-of-delta residuals,
+ *    others are XOR-compressed; missing values are marked by a run-length
+ *    encoded mask,
+ *  - per beacon and observable, the series of flags, run-length encoded.
+ *  Decoding is lossless (values are restored bitwise), streaming (one chunk
+ *  at a time) and works on contiguous per-column arrays.
+ *
+ *  Each chunk is preceded by its zone map (see ChunkZoneMap), i.e. summary
+ *  statistics allowing readers to skip whole chunks without decoding them.
+ *
+ *  Layout: a file header ("DRXA", version, observables, scale factors and
+ *  satellite name) followed by chunks, each made of the number of epochs,
+ *  the size of the zone map (in bytes), the zone map, the size of the
+ *  payload (in bytes) and the payload. Fixed-width integers are
+ *  little-endian.
+ */
+
+/** @struct ChunkZoneMap
+ *  @brief Summary statistics of an archive chunk (zone map).
+ */
+struct ChunkZoneMap {
+  /* Beacons are mapped to bits by their number, i.e. Dnn to bit nn; ids
+   * not of this form all map to the last bit
+   */
+  static constexpr int MAX_BEACON_BITS = 128;
+
+  /* number of epochs (data blocks) in the chunk */
+  int m_num_epochs{0};
+  /* number of epochs with an epoch flag > 0 */
+  int m_flagged_epochs{0};
+  /* first and last epoch of the chunk */
+  Datetime<nanoseconds> m_first_epoch;
+  Datetime<nanoseconds> m_last_epoch;
+  /* beacons observed in the chunk (see beacon_bit()) */
+  std::bitset<MAX_BEACON_BITS> m_beacons;
+  /* per observable, min and max of (non-missing) values; min > max if all
+   * values are missing
+   */
+  std::vector<double> m_min;
+  std::vector<double> m_max;
+
+  /* @brief The bit of m_beacons a beacon id (e.g. "D31") maps to */
+  static int beacon_bit(const char *id) noexcept {
+    if (id[0] == 'D' && id[1] >= '0' && id[1] <= '9' && id[2] >= '0' &&
+        id[2] <= '9')
+      return (id[1] - '0') * 10 + (id[2] - '0');
+    return MAX_BEACON_BITS - 1;
+  }
+
+  /* @brief False if the beacon is surely not observed in the chunk */
+  bool may_have_beacon(const char *id) const noexcept {
+    return m_beacons.test(beacon_bit(id));
+  }
+
+  /* @brief False if no epoch of the chunk is within [from, to] */
+  bool overlaps(const Datetime<nanoseconds> &from,
+                const Datetime<nanoseconds> &to) const noexcept {
+    return !(m_last_epoch < from || to < m_first_epoch);
+  }
+
+  /* @brief False if no value of observable obs is within [lo, hi] */
+  bool may_have_value(int obs, double lo, double hi) const noexcept {
+    return m_min[obs] <= m_max[obs] && !(m_max[obs] < lo || hi < m_min[obs]);
+  }
+}; /* struct ChunkZoneMap */
+
+/** @class ArchiveWriter
+ *  @brief Write data blocks to a columnar archive.
+ *
+ *  Blocks are buffered until a chunk is complete; the last (partial) chunk
+ *  is written by flush() or at destruction.
+ */
+class ArchiveWriter {
+  std::ostream *m_os;
+  /* scale factors of observables */
+  std::vector<int> m_scale_factors;
+  int m_chunk_epochs;
+  /* blocks of the current chunk */
+  std::vector<DataBlock> m_pending;
+  /* encoding buffer */
+  std::vector<std::uint8_t> m_buf;
+  bool m_error{false};
+
+  int write_chunk() noexcept;
+
+ public:
+  /** @brief Constructor; writes the archive header.
+   *
+   *  @param[in] os The output stream (should be opened in binary mode)
+   *  @param[in] hdr The header of the RINEX file the data blocks come from
+   *  @param[in] chunk_epochs Max number of epochs per chunk
+   *  @throw std::runtime_error if the header cannot be written.
+   */
+  ArchiveWriter(std::ostream &os, const DorisRinexHeader &hdr,
+                int chunk_epochs = DEFAULT_ARCHIVE_CHUNK_EPOCHS);
+
+  /* @brief Destructor; flushes any pending blocks */
+  ~ArchiveWriter() noexcept;
+
+  ArchiveWriter(const ArchiveWriter &) = delete;
+  ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+  /** @brief Append a data block; blocks must be in chronological order, and
+   *  hold the observables of the header given at construction.
+   *  @return Anything other than 0 denotes an error.
+   */
+  int append(const DataBlock &block) noexcept;
+
+  /** @brief Write any pending blocks (as a chunk).
+   *  @return Anything other than 0 denotes an error.
+   */
+  int flush() noexcept;
+}; /* class ArchiveWriter */
+
+/** @class ArchiveReader
+ *  @brief Read data blocks off a columnar archive, one chunk at a time.
+ *
+ *  A chunk filter can be set, to skip chunks based on their zone map; the
+ *  payload of skipped chunks is never decoded (and, if the stream is
+ *  seekable, never read).
+ *
+ *  Functions reading blocks return an int denoting:
+ *    < 0 : No more blocks (EOF); block is invalid
+ *    = 0 : All ok, data collected and stored in block
+ *    > 0 : Error, failed to collect the block; block is invalid
+ */
+class ArchiveReader {
+  /* a decoded chunk; defined in the implementation file */
+  struct Chunk;
+
+  std::istream *m_is;
+  std::vector<DorisObservationCode> m_obs_codes;
+  std::vector<int> m_scale_factors;
+  ObservationColumns m_obs_columns;
+  std::string m_satellite_name;
+  /* raw (encoded) chunk */
+  std::vector<std::uint8_t> m_buf;
+  /* current (decoded) chunk */
+  std::unique_ptr<Chunk> m_chunk;
+
+ public:
+  /* Predicate on chunk zone maps; chunks for which it is false are skipped */
+  using chunk_filter = std::function<bool(const ChunkZoneMap &)>;
+
+ private:
+  /* zone map of the current chunk */
+  ChunkZoneMap m_zone_map;
+  chunk_filter m_filter;
+  /* number of chunks read and skipped */
+  long m_chunks_read{0};
+  long m_chunks_skipped{0};
+
+  int read_chunk() noexcept;
+
+ public:
+  /** @brief Constructor; reads the archive header.
+   *  @throw std::runtime_error if the stream does not hold an archive.
+   */
+  explicit ArchiveReader(std::istream &is);
+
+  /* @brief Destructor */
+  ~ArchiveReader() noexcept;
+
+  ArchiveReader(const ArchiveReader &) = delete;
+  ArchiveReader &operator=(const ArchiveReader &) = delete;
+
+  const std::vector<DorisObservationCode> &obs_codes() const noexcept {
+    return m_obs_codes;
+  }
+  const std::vector<int> &obs_scale_factors() const noexcept {
+    return m_scale_factors;
+  }
+  /* @brief Index of an observable within obs_codes(), -1 if not recorded */
+  int obs_index(DorisObservationCode code) const noexcept {
+    return m_obs_columns(code);
+  }
+  const char *satellite_name() const noexcept {
+    return m_satellite_name.c_str();
+  }
+
+  /** @brief Set (or clear, if empty) the chunk filter; applies to chunks not
+   *  yet read.
+   */
+  void set_chunk_filter(chunk_filter filter) { m_filter = std::move(filter); }
+
+  /* @brief Zone map of the chunk the last block read belongs to */
+  const ChunkZoneMap &zone_map() const noexcept { return m_zone_map; }
+
+  /* @brief Number of chunks decoded so far */
+  long chunks_read() const noexcept { return m_chunks_read; }
+
+  /* @brief Number of chunks skipped (by the filter) so far */
+  long chunks_skipped() const noexcept { return m_chunks_skipped; }
+
+  /** @brief Read the next data block (of chunks passing the filter, if
+   *  any)
+   */
+  int next(DataBlock &block) noexcept;
+
+  /** @brief Skip the remaining blocks of the current chunk; the next block
+   *  read will be the first one of the next chunk passing the filter.
+   */
+  void skip_chunk() noexcept;
+}; /* class ArchiveReader */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
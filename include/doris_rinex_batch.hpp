@@ -0,0 +1,65 @@
+#ifndef __DSO_DORIS_RINEX_BATCH_HPP__
+#define __DSO_DORIS_RINEX_BATCH_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "doris_rinex.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Options for batch ingestion of RINEX files */
+struct BatchOptions {
+  /* number of worker (parsing) threads; 0 means one per hardware thread */
+  int m_num_threads{0};
+  /* max number of files being read concurrently */
+  int m_queue_depth{32};
+  /* use io_uring (if available) for reading files; else plain reads */
+  bool m_use_io_uring{true};
+}; /* struct BatchOptions */
+
+/** @brief Handler called for every file successfully loaded (i.e. read, and
+ *         with a valid header), on a worker thread; index is the index of
+ *         the file in the list given to ingest_files().
+ *
+ *  The DorisObsRinex instance reads off the (in-memory) contents of the file
+ *  and is only valid during the call. Handlers run concurrently, hence they
+ *  should be thread-safe. An exception thrown by the handler marks the file
+ *  as failed.
+ */
+using file_handler = std::function<void(std::size_t index, DorisObsRinex &)>;
+
+/** @brief True if the library was built with io_uring support, and the
+ *         running kernel allows it.
+ */
+bool io_uring_available() noexcept;
+
+/** @brief Read and parse a batch of (plain or compressed) RINEX files.
+ *
+ *  Files are read whole into memory; with io_uring, reads for up to
+ *  m_queue_depth files are submitted at once, so that per-file I/O latency
+ *  is overlapped. Else (not available, or not requested), files are read
+ *  one after the other with plain reads. Each loaded file is handed to a
+ *  pool of worker threads, where a DorisObsRinex instance is constructed
+ *  over the buffer (see doris_rnx::MemorySource) and passed to the handler.
+ *  Loaded files wait in a bounded queue, so memory use is bounded when
+ *  parsing is slower than reading.
+ *
+ *  @param[in] files   The files to read
+ *  @param[in] handler Called for every loaded file (see file_handler)
+ *  @param[in] opts    Options
+ *  @return The number of files that failed (could not be read, had no
+ *          valid header, or the handler threw).
+ */
+int ingest_files(const std::vector<std::string> &files,
+                 const file_handler &handler,
+                 const BatchOptions &opts = BatchOptions{});
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
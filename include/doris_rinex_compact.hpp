@@ -0,0 +1,68 @@
+#ifndef __DSO_DORIS_RINEX_COMPACT_HPP__
+#define __DSO_DORIS_RINEX_COMPACT_HPP__
+
+#include <istream>
+#include <ostream>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** Compact DORIS RINEX
+ *
+ *  A differential text encoding of DORIS RINEX observation files, in the
+ *  style of Hatanaka's compact RINEX (CRX) for GNSS. Observables change
+ *  smoothly from epoch to epoch; hence, per beacon and per observable, only
+ *  (up to 3rd order) differences of the values, in units of the last digit
+ *  recorded (i.e. 1e-3), are written. The resulting files are several times
+ *  smaller, and compress much better with general-purpose compressors.
+ *
+ *  Format:
+ *  - Two header lines are prepended to the (verbatim) RINEX header:
+ *    "CRINEX VERS   / TYPE" and "CRINEX PROG / DATE".
+ *  - Record lines are written in full (starting with '>') for the first
+ *    epoch and after special events; else, they start with '&' followed by a
+ *    text difference with the previous record line.
+ *  - Each beacon is written on one line: the beacon id, then one token per
+ *    observable (separated by a single blank) and then, following a blank,
+ *    the text difference of the LLI/signal-strength flags with those of the
+ *    previous epoch. A token is either "n&v" (start of an arc of order n,
+ *    v is the value), a difference, or empty (value missing; the arc ends).
+ *    A beacon not present in the previous epoch starts new arcs.
+ *  - Text differences keep a blank for each unchanged character, have '&'
+ *    for a character changed to blank and the new character otherwise;
+ *    trailing blanks are dropped.
+ *  - Special event records (flag > 1) and their lines are written verbatim.
+ *
+ *  Compact files (optionally compressed, i.e. .Z or .gz) can be read
+ *  directly via DorisObsRinex; data blocks are decoded one at a time while
+ *  iterating (no expansion to a RINEX file is needed).
+ */
+
+/** @brief Convert a DORIS RINEX file to compact DORIS RINEX.
+ *
+ *  Observation values must be recorded with (at most) 3 decimal digits, as
+ *  dictated by the RINEX format (F14.3).
+ *
+ *  @param[in]  rnx The input (RINEX) stream, placed at the top of the file
+ *  @param[out] crx The output (compact RINEX) stream
+ *  @return Anything other than 0 denotes an error.
+ */
+int rinex_to_compact(std::istream &rnx, std::ostream &crx) noexcept;
+
+/** @brief Convert a compact DORIS RINEX file back to DORIS RINEX.
+ *
+ *  The header and all values/flags are restored exactly; data lines are
+ *  written at full width (i.e. padded with blanks).
+ *
+ *  @param[in]  crx The input (compact RINEX) stream, placed at the top of
+ *                  the file
+ *  @param[out] rnx The output (RINEX) stream
+ *  @return Anything other than 0 denotes an error.
+ */
+int compact_to_rinex(std::istream &crx, std::ostream &rnx) noexcept;
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef __DSO_DORIS_RINEX_CORO_HPP__
+#define __DSO_DORIS_RINEX_CORO_HPP__
+
+/* Coroutine interface; only available when compiling as C++20 (the library
+ * itself is C++17, so everything here is header-only). RNX_HAVE_COROUTINES
+ * is defined when it is.
+ */
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define RNX_HAVE_COROUTINES 1
+
+#include <poll.h>
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "doris_rinex.hpp"
+#include "doris_rinex_follow.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class Generator
+ *  @brief A (lazy, single-pass) coroutine generator, yielding references
+ *         (Ref must be a reference type, e.g. const DataBlock &).
+ *
+ *  Values are not copied: the reference yielded stays valid until the
+ *  iterator is incremented. An exception thrown by the coroutine is
+ *  rethrown by begin() or operator++.
+ */
+template <typename Ref> class Generator {
+  static_assert(std::is_reference_v<Ref>, "Generator yields references");
+
+ public:
+  using value_type = std::remove_cvref_t<Ref>;
+
+  struct promise_type {
+    std::add_pointer_t<Ref> m_value{nullptr};
+    std::exception_ptr m_exception;
+
+    Generator get_return_object() noexcept {
+      return Generator{
+          std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+    std::suspend_always yield_value(Ref v) noexcept {
+      m_value = std::addressof(v);
+      return {};
+    }
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept {
+      m_exception = std::current_exception();
+    }
+    /* generators cannot co_await */
+    template <typename U> void await_transform(U &&) = delete;
+  }; /* struct promise_type */
+
+  struct iterator {
+    using value_type = Generator::value_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+
+    std::coroutine_handle<promise_type> m_handle;
+
+    Ref operator*() const noexcept {
+      return static_cast<Ref>(*m_handle.promise().m_value);
+    }
+    auto operator->() const noexcept { return m_handle.promise().m_value; }
+    iterator &operator++() {
+      m_handle.resume();
+      rethrow();
+      return *this;
+    }
+    void operator++(int) { ++(*this); }
+    friend bool operator==(const iterator &it,
+                           std::default_sentinel_t) noexcept {
+      return it.m_handle.done();
+    }
+
+    void rethrow() const {
+      if (m_handle.done() && m_handle.promise().m_exception)
+        std::rethrow_exception(m_handle.promise().m_exception);
+    }
+  }; /* struct iterator */
+
+ private:
+  std::coroutine_handle<promise_type> m_handle;
+
+  explicit Generator(std::coroutine_handle<promise_type> h) noexcept
+      : m_handle(h) {}
+
+ public:
+  Generator(const Generator &) = delete;
+  Generator &operator=(const Generator &) = delete;
+  Generator(Generator &&other) noexcept
+      : m_handle(std::exchange(other.m_handle, nullptr)) {}
+  Generator &operator=(Generator &&other) noexcept {
+    if (this != &other) {
+      if (m_handle) m_handle.destroy();
+      m_handle = std::exchange(other.m_handle, nullptr);
+    }
+    return *this;
+  }
+  ~Generator() noexcept {
+    if (m_handle) m_handle.destroy();
+  }
+
+  /* @brief Start (i.e. run up to the first value); call once */
+  iterator begin() {
+    iterator it{m_handle};
+    ++it;
+    return it;
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+}; /* class Generator */
+
+/** @brief The data blocks of a file, in order (from the first one); e.g.
+ *    for (const auto &block : doris_rnx::blocks(rnx)) { ... }
+ *  @throw std::runtime_error (on iteration) if a block fails.
+ */
+inline Generator<const DataBlock &> blocks(DorisObsRinex &rnx) {
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) co_yield *it;
+}
+
+/** @brief The data blocks of a followed file, as they are appended; ends
+ *         when no block becomes available within timeout_ms (see
+ *         DorisRinexFollower::next), or when the follower is stopped.
+ *  @throw std::runtime_error (on iteration) if a block fails.
+ */
+inline Generator<const DataBlock &> blocks(DorisRinexFollower &f,
+                                           int timeout_ms = -1) {
+  DataBlock block;
+  int status;
+  while (!(status = f.next(block, timeout_ms))) co_yield block;
+  if (status > 0)
+    throw std::runtime_error("[ERROR] Failed reading followed data block\n");
+}
+
+/** @class FollowLoop
+ *  @brief A single-threaded event loop, running coroutines that read data
+ *         blocks off (many) followed files, interleaved, without blocking.
+ *
+ *  Tasks are coroutines returning FollowLoop::Task, that await blocks via
+ *  next(); e.g.
+ *    FollowLoop loop;
+ *    auto stage = [&](DorisRinexFollower &f) -> FollowLoop::Task {
+ *      doris_rnx::DataBlock block;
+ *      while (!co_await loop.next(f, block)) { ... }
+ *    };
+ *    loop.spawn(stage(f1));
+ *    loop.spawn(stage(f2));
+ *    loop.run();
+ *  An awaiting task is resumed once the next block of its file is complete
+ *  (or on error, or once the follower is stopped); co_await gives the
+ *  status of DorisRinexFollower::next. Tasks take turns in order of
+ *  readiness, so a file with many blocks pending does not starve others.
+ *  While no task can run, the loop sleeps in poll(2) on the wait_fd() of
+ *  the followers awaited, until one of the files grows (or a follower is
+ *  stopped); followers without inotify are checked every poll interval.
+ *  Other schedulers can do the same, see DorisRinexFollower::wait_fd.
+ *
+ *  Only next() can be awaited by tasks. Followers must outlive the tasks
+ *  reading off them; the loop is not thread-safe (followers can still be
+ *  stopped from any thread).
+ */
+class FollowLoop {
+ public:
+  class NextBlock;
+
+  class Task {
+   public:
+    struct promise_type {
+      std::exception_ptr m_exception;
+
+      Task get_return_object() noexcept {
+        return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+      /* started by the loop */
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      /* destroyed by the loop */
+      std::suspend_always final_suspend() const noexcept { return {}; }
+      void return_void() const noexcept {}
+      void unhandled_exception() noexcept {
+        m_exception = std::current_exception();
+      }
+      NextBlock await_transform(NextBlock a) const noexcept { return a; }
+    }; /* struct promise_type */
+
+   private:
+    friend class FollowLoop;
+    std::coroutine_handle<promise_type> m_handle;
+    explicit Task(std::coroutine_handle<promise_type> h) noexcept
+        : m_handle(h) {}
+
+   public:
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    Task(Task &&other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task &operator=(Task &&other) noexcept {
+      if (this != &other) {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, nullptr);
+      }
+      return *this;
+    }
+    ~Task() noexcept {
+      if (m_handle) m_handle.destroy();
+    }
+  }; /* class Task */
+
+  /* awaitable, returned by next() */
+  class NextBlock {
+    friend class FollowLoop;
+    FollowLoop *m_loop;
+    DorisRinexFollower *m_follower;
+    DataBlock *m_block;
+    std::coroutine_handle<> m_handle{};
+    int m_status{-1};
+
+    NextBlock(FollowLoop &loop, DorisRinexFollower &f,
+              DataBlock &block) noexcept
+        : m_loop(&loop), m_follower(&f), m_block(&block) {}
+
+    /* try to read the block, without waiting; true if done */
+    bool poll() noexcept {
+      m_status = m_follower->next(*m_block, 0);
+      return m_status >= 0 || m_follower->stopped();
+    }
+
+   public:
+    /* always suspend, so that tasks take turns */
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      m_handle = h;
+      if (poll())
+        m_loop->m_ready.push_back(h);
+      else
+        m_loop->m_waiting.push_back(this);
+    }
+    int await_resume() const noexcept { return m_status; }
+  }; /* class NextBlock */
+
+ private:
+  /* tasks spawned and not yet finished */
+  std::vector<Task> m_tasks;
+  /* tasks that can be resumed, in order */
+  std::deque<std::coroutine_handle<>> m_ready;
+  /* tasks waiting for a block (awaitables live in the coroutine frames) */
+  std::vector<NextBlock *> m_waiting;
+  /* descriptors of the followers awaited, reused across waits */
+  std::vector<struct pollfd> m_fds;
+  int m_poll_interval_ms;
+
+  /* destroy finished tasks; rethrow the exception of a failed one */
+  void reap() {
+    for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+      if (!it->m_handle.done()) {
+        ++it;
+        continue;
+      }
+      const auto e = it->m_handle.promise().m_exception;
+      it = m_tasks.erase(it);
+      if (e) std::rethrow_exception(e);
+    }
+  }
+
+  /* sleep until a file awaited may have changed (or a follower is stopped),
+   * or for the shortest wait interval of the followers (and of the loop)
+   */
+  void wait() {
+    if (m_waiting.empty()) return;
+    int timeout_ms = m_poll_interval_ms;
+    m_fds.clear();
+    for (const auto *a : m_waiting) {
+      m_fds.push_back({a->m_follower->wait_fd(), POLLIN, 0});
+      const int ms = a->m_follower->wait_interval_ms();
+      if (ms >= 0 && (timeout_ms < 0 || ms < timeout_ms)) timeout_ms = ms;
+    }
+    /* EINTR or else, the files are checked anyway */
+    ::poll(m_fds.data(), m_fds.size(), timeout_ms);
+  }
+
+ public:
+  /** @brief Constructor.
+   *  @param[in] poll_interval_ms Max interval (in milliseconds) between
+   *             checks of the files, while all tasks are waiting; < 0 means
+   *             as long as the followers allow (i.e. until notified, see
+   *             DorisRinexFollower::wait_interval_ms)
+   */
+  explicit FollowLoop(int poll_interval_ms = -1) noexcept
+      : m_poll_interval_ms(poll_interval_ms) {}
+
+  FollowLoop(const FollowLoop &) = delete;
+  FollowLoop &operator=(const FollowLoop &) = delete;
+
+  /* @brief Await the next data block of a followed file (in a Task) */
+  NextBlock next(DorisRinexFollower &f, DataBlock &block) noexcept {
+    return NextBlock(*this, f, block);
+  }
+
+  /* @brief Add a task; it starts running within run() */
+  void spawn(Task &&task) {
+    m_ready.push_back(task.m_handle);
+    m_tasks.push_back(std::move(task));
+  }
+
+  /* @brief Number of tasks not yet finished */
+  std::size_t size() const noexcept { return m_tasks.size(); }
+
+  /** @brief Run all tasks, until they are finished.
+   *  @throw Whatever a task throws; the other tasks are left suspended (run
+   *         can be called again to resume them).
+   */
+  void run() {
+    while (!m_tasks.empty()) {
+      while (!m_ready.empty()) {
+        const auto h = m_ready.front();
+        m_ready.pop_front();
+        h.resume();
+      }
+      reap();
+
+      /* move tasks whose block is there to the ready queue */
+      for (auto it = m_waiting.begin(); it != m_waiting.end();) {
+        if ((*it)->poll()) {
+          m_ready.push_back((*it)->m_handle);
+          it = m_waiting.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (m_ready.empty() && !m_tasks.empty()) wait();
+    }
+  }
+}; /* class FollowLoop */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif /* coroutines */
+
+#endif
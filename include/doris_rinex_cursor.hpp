@@ -0,0 +1,137 @@
+#ifndef __DSO_DORIS_RINEX_CURSOR_HPP__
+#define __DSO_DORIS_RINEX_CURSOR_HPP__
+
+#include <cstddef>
+#include <memory>
+
+#include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class MappedFile
+ *  @brief A read-only memory mapping of a whole file.
+ *
+ *  The mapping is never modified, so it can be shared (e.g. via
+ *  std::shared_ptr<const MappedFile>) across threads.
+ */
+class MappedFile {
+  const char *m_data{nullptr};
+  std::size_t m_size{0};
+
+ public:
+  /** @brief Map the file fn to memory.
+   *  @throw std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const char *fn);
+
+  /* @brief Destructor; unmaps the file */
+  ~MappedFile() noexcept;
+
+  /* @brief Copy not allowed ! */
+  MappedFile(const MappedFile &) = delete;
+
+  /* @brief Assignment not allowed ! */
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const noexcept { return m_data; }
+  std::size_t size() const noexcept { return m_size; }
+}; /* class MappedFile */
+
+} /* namespace doris_rnx */
+
+/** @class DorisRinexCursor
+ *  @brief A lightweight, bidirectional reader of data blocks, over a memory
+ *         mapped DORIS RINEX file.
+ *
+ *  A cursor shares the (immutable) header and the (read-only) mapping with
+ *  any other cursor created off the same file, but keeps its own position.
+ *  Hence, any number of cursors can read the same file concurrently (e.g.
+ *  each one in its own thread), without reopening it or re-parsing its
+ *  header. A single cursor instance is not thread-safe.
+ *
+ *  A cursor sits between data blocks; next() reads the block after the
+ *  cursor and moves past it, while prev() reads the block before the cursor
+ *  and moves in front of it (hence next() followed by prev() gives the same
+ *  block).
+ *
+ *  Functions reading blocks return an int denoting:
+ *    < 0 : No (more) blocks in this direction; block is invalid
+ *    = 0 : All ok, data collected and stored in block
+ *    > 0 : Error, failed to collect the block; block is invalid
+ */
+class DorisRinexCursor {
+ public:
+  /* Let's not write this more than once. */
+  typedef DorisRinexHeader::pos_type pos_type;
+
+ private:
+  /* an input stream over the mapping; defined in the implementation file */
+  struct Stream;
+
+  /* the header of the file, shared */
+  std::shared_ptr<const DorisRinexHeader> m_header;
+  /* the mapped file, shared */
+  std::shared_ptr<const doris_rnx::MappedFile> m_map;
+  /* own stream over the mapping */
+  std::unique_ptr<Stream> m_stream;
+  /* current position (byte offset) */
+  pos_type m_pos;
+
+ public:
+  /** @brief Constructor; the cursor is placed in front of the first data
+   *         block.
+   *
+   *  @param[in] hdr The header, as read off the mapped file
+   *  @param[in] map The mapped file
+   */
+  DorisRinexCursor(std::shared_ptr<const DorisRinexHeader> hdr,
+                   std::shared_ptr<const doris_rnx::MappedFile> map);
+
+  /* @brief Destructor */
+  ~DorisRinexCursor() noexcept;
+
+  /* @brief Copy constructor; the copy is independent, at the same position */
+  DorisRinexCursor(const DorisRinexCursor &other);
+
+  /* @brief Copy assignment; the copy is independent, at the same position */
+  DorisRinexCursor &operator=(const DorisRinexCursor &other);
+
+  /* @brief Move Constructor. */
+  DorisRinexCursor(DorisRinexCursor &&other) noexcept;
+
+  /* @brief Move assignment operator. */
+  DorisRinexCursor &operator=(DorisRinexCursor &&other) noexcept;
+
+  /* @brief The (shared) header */
+  const DorisRinexHeader &header() const noexcept { return *m_header; }
+
+  /* @brief Current position of the cursor, as byte offset in the file */
+  pos_type tell() const noexcept { return m_pos; }
+
+  /* @brief Place the cursor in front of the first data block */
+  void rewind() noexcept;
+
+  /* @brief Place the cursor after the last data block */
+  void seek_end() noexcept;
+
+  /** @brief Place the cursor in front of the first data block with an epoch
+   *         equal to or later than t (bisection, no index needed).
+   *
+   *  @return 0 if such a block exists; else -1, and the cursor is placed
+   *          after the last data block.
+   */
+  int seek(const Datetime<nanoseconds> &t) noexcept;
+
+  /* @brief Read the data block after the cursor and move past it */
+  int next(doris_rnx::DataBlock &block) noexcept;
+
+  /* @brief Read the data block before the cursor and move in front of it */
+  int prev(doris_rnx::DataBlock &block) noexcept;
+}; /* class DorisRinexCursor */
+
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef __DSO_DORIS_RINEX_DECOMPRESS_HPP__
+#define __DSO_DORIS_RINEX_DECOMPRESS_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <vector>
+
+#include "doris_rinex_source.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @enum Compression
+ *  Compression formats recognised (by their magic bytes) in input sources.
+ */
+enum class Compression : char {
+  none, ///< plain (uncompressed) data
+  lzw,  ///< Unix compress (.Z), magic bytes 0x1f 0x9d
+  gzip  ///< gzip (.gz), magic bytes 0x1f 0x8b
+}; /* enum Compression */
+
+/** @brief Wrap an input source in a decompressing source, if needed.
+ *
+ *  The first bytes of the source are inspected; if they match the magic
+ *  bytes of a known compression format, a decompressing source (LzwSource
+ *  or GzipSource) reading off the given source is returned. Else, the source
+ *  is returned as is (nothing is consumed from it).
+ *
+ *  @param[in] source The (possibly compressed) input source
+ *  @param[out] type  If not null, set to the compression format detected
+ *  @return The source to read uncompressed data from
+ */
+std::unique_ptr<std::streambuf> decompressing_source(
+    std::unique_ptr<std::streambuf> source, Compression *type = nullptr);
+
+/** @class LzwSource
+ *  @brief Input source decompressing Unix compress (.Z) data, as read off
+ *         another source, while streaming.
+ *
+ *  The decoder is self-contained (no external library is needed). Data is
+ *  decompressed straight into the buffer of the source, chunk by chunk; no
+ *  temporary files are used. The source is not seekable (except within its
+ *  buffer).
+ */
+class LzwSource : public InputSource {
+  /* the compressed input */
+  std::unique_ptr<std::streambuf> m_in;
+  /* bit buffer (codes are packed LSB first) */
+  std::uint32_t m_bitbuf{0};
+  int m_bitcnt{0};
+  /* max number of bits per code and block (i.e. CLEAR) mode, from header */
+  int m_maxbits{16};
+  bool m_block_mode{true};
+  /* current number of bits per code, and largest code for this width */
+  int m_nbits{9};
+  std::uint32_t m_maxcode{511};
+  /* next free dictionary entry */
+  std::uint32_t m_free{256};
+  /* codes read since last width change (codes come in groups of 8) */
+  int m_codes_in_group{0};
+  /* previous code (-1 at start/after CLEAR) and its first char */
+  int m_oldcode{-1};
+  std::uint8_t m_finchar{0};
+  /* dictionary */
+  std::vector<std::uint16_t> m_prefix;
+  std::vector<std::uint8_t> m_suffix;
+  /* decoded string(s) not yet delivered, stored in reverse */
+  std::vector<std::uint8_t> m_stack;
+  /* true after EOF of input (or on error) */
+  bool m_done{false};
+  bool m_error{false};
+
+  int read_byte() noexcept;
+  bool read_header() noexcept;
+  int next_code() noexcept;
+  void skip_group() noexcept;
+
+ protected:
+  std::size_t read_chunk(char *buf, std::size_t n) override;
+
+ public:
+  /** @param[in] in The compressed source
+   *  @param[in] magic_consumed True if the two magic bytes have already been
+   *             read off in
+   *  @param[in] buffer_size Size of internal (decompressed data) buffer
+   */
+  explicit LzwSource(std::unique_ptr<std::streambuf> in,
+                     bool magic_consumed = false,
+                     std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE);
+
+  /* @brief True if the compressed data were found invalid */
+  bool error() const noexcept override { return m_error; }
+}; /* class LzwSource */
+
+/** @class GzipSource
+ *  @brief Input source decompressing gzip (.gz) data, as read off another
+ *         source, while streaming.
+ *
+ *  The (deflate) decoder is self-contained (no external library is needed).
+ *  Data is decompressed straight into the buffer of the source, chunk by
+ *  chunk; no temporary files are used. Concatenated gzip members are
+ *  supported, and the CRC-32 and size of each member are verified. The
+ *  source is not seekable (except within its buffer).
+ */
+class GzipSource : public InputSource {
+ public:
+  /* A canonical Huffman code, with a lookup table for short codes */
+  struct Huffman {
+    static constexpr int FAST_BITS = 9;
+    std::int16_t m_count[16];
+    std::int16_t m_symbol[288];
+    /* (length << 9) | symbol, for codes of length <= FAST_BITS; 0 if n/a */
+    std::uint16_t m_fast[1 << FAST_BITS];
+    int build(const std::uint8_t *lengths, int n) noexcept;
+  }; /* struct Huffman */
+
+ private:
+  enum class State : char {
+    member_header,
+    block_header,
+    stored,
+    huffman,
+    member_trailer,
+    done
+  };
+
+  /* the compressed input */
+  std::unique_ptr<std::streambuf> m_in;
+  bool m_input_eof{false};
+  bool m_error{false};
+  /* bit buffer (LSB first) */
+  std::uint64_t m_bitbuf{0};
+  int m_bitcnt{0};
+  /* where we are */
+  State m_state{State::member_header};
+  bool m_final_block{false};
+  bool m_magic_consumed;
+  /* remaining bytes of stored block */
+  std::uint32_t m_stored_left{0};
+  /* pending match (length/distance) */
+  int m_copy_len{0};
+  int m_copy_dist{0};
+  /* the codes of the current block */
+  Huffman m_lencode;
+  Huffman m_distcode;
+  /* sliding window (32KB) */
+  std::vector<std::uint8_t> m_window;
+  std::uint32_t m_wpos{0};
+  /* CRC-32 and size of the current member's output */
+  std::uint32_t m_crc{0};
+  std::uint64_t m_size{0};
+
+  int read_byte() noexcept;
+  bool need(int nbits) noexcept;
+  int bits(int nbits) noexcept;
+  int decode(const Huffman &h) noexcept;
+  bool read_member_header() noexcept;
+  bool read_block_header() noexcept;
+  bool read_dynamic_tables() noexcept;
+  bool read_member_trailer() noexcept;
+
+ protected:
+  std::size_t read_chunk(char *buf, std::size_t n) override;
+
+ public:
+  /** @param[in] in The compressed source
+   *  @param[in] magic_consumed True if the two magic bytes have already been
+   *             read off in
+   *  @param[in] buffer_size Size of internal (decompressed data) buffer
+   */
+  explicit GzipSource(std::unique_ptr<std::streambuf> in,
+                      bool magic_consumed = false,
+                      std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE);
+
+  /* @brief True if the compressed data were found invalid */
+  bool error() const noexcept override { return m_error; }
+}; /* class GzipSource */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
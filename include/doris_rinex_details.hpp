@@ -1,8 +1,11 @@
 #ifndef __DSO_DORIS_RINEX_DETAILS_PR_HPP__
 #define __DSO_DORIS_RINEX_DETAILS_PR_HPP__
 
+#include <cstdint>
 #include <limits>
+#include <vector>
 #include "datetime/calendar.hpp"
+#include "obstypes.hpp"
 
 namespace dso {
 
@@ -28,6 +31,67 @@ static constexpr double OBSERVATION_VALUE_MISSING =
  */
 static constexpr int MAX_OBS_PER_DATA_LINE = 5;
 
+/** @struct ObservationColumns
+ *  @brief Maps an observable (DorisObservationCode) to its column, i.e. its
+ *         index within the observables of a RINEX file (and hence within
+ *         the values of any beacon/data block of the file), in O(1).
+ *
+ *  The table is indexed by (type, frequency) and is built once, off the
+ *  observables of the header.
+ */
+struct ObservationColumns {
+  /* number of DorisObservationType's and of frequencies (0, 1 or 2) */
+  static constexpr int NUM_TYPES = 7;
+  static constexpr int NUM_FREQS = 3;
+
+  /* column of every (type, frequency), -1 if not recorded */
+  signed char m_column[NUM_TYPES * NUM_FREQS];
+
+  /* @brief Default constructor; no observable is recorded */
+  ObservationColumns() noexcept {
+    for (auto &c : m_column) c = -1;
+  }
+
+  /* @brief Constructor, off the observables of a file (in order) */
+  explicit ObservationColumns(
+      const std::vector<DorisObservationCode> &codes) noexcept
+      : ObservationColumns() {
+    for (int k = codes.size() - 1; k >= 0; k--) m_column[slot(codes[k])] = k;
+  }
+
+  static int slot(DorisObservationCode code) noexcept {
+    return static_cast<int>(code.m_type) * NUM_FREQS + code.m_freq;
+  }
+
+  /* @brief The column of an observable, -1 if not recorded */
+  int operator()(DorisObservationCode code) const noexcept {
+    return m_column[slot(code)];
+  }
+}; /* struct ObservationColumns */
+
+/* nanoseconds per day */
+static constexpr std::int64_t NS_PER_DAY =
+    86400L * nanoseconds::sec_factor<std::int64_t>();
+
+/* @brief An epoch as (integer) nanoseconds since MJD 0, e.g. to order or
+ *        difference epochs cheaply
+ */
+inline std::int64_t epoch_to_ns(const Datetime<nanoseconds> &t) noexcept {
+  return (std::int64_t)t.imjd().as_underlying_type() * NS_PER_DAY +
+         t.sec().as_underlying_type();
+}
+
+/* @brief Inverse of epoch_to_ns */
+inline Datetime<nanoseconds> ns_to_epoch(std::int64_t ns) noexcept {
+  std::int64_t mjd = ns / NS_PER_DAY;
+  std::int64_t sec = ns % NS_PER_DAY;
+  if (sec < 0) {
+    sec += NS_PER_DAY;
+    --mjd;
+  }
+  return Datetime<nanoseconds>(modified_julian_day(mjd), nanoseconds(sec));
+}
+
 /* @brief A station (aka beacon) as defined in RINEX DORIS 3.0 (Issue 1.7) */
 struct Beacon {
 
@@ -169,35 +233,62 @@ struct RinexDataRecordHeader {
   }
 }; /* class RinexDataRecordHeader */
 
-struct RinexObservationValue {
-  RinexObservationValue(double v, char f1, char f2) noexcept
+/** An observation value, with its m1 and m2 flags; T is the type holding
+ *  the value (see doris_rinex_policy.hpp for the types supported).
+ */
+template <typename T> struct BasicObservationValue {
+  BasicObservationValue(T v, char f1, char f2) noexcept
       : m_value(v), m_flag1(f1), m_flag2(f2) {};
   /* The actual value parsed from the corresponding RINEX field */
-  double m_value;
+  T m_value;
   /* The m1 and m2 flags */
   char m_flag1, m_flag2;
-}; /* struct RinexObservationValue */
+}; /* struct BasicObservationValue */
 
-struct BeaconObservations {
+template <typename T> struct BasicBeaconObservations {
   /* internal beacon id (refernced in RINEX) */
   char m_beacon_id[4] = {'\0'};
   
   /* the observations made from the beacon at a selected epoch */
-  std::vector<RinexObservationValue> m_values;
+  std::vector<BasicObservationValue<T>> m_values;
 
-  explicit BeaconObservations(int size_hint = 10) noexcept {
+  explicit BasicBeaconObservations(int size_hint = 10) noexcept {
     m_values.reserve(size_hint);
   }
 
   const char *id() const noexcept { return m_beacon_id; }
-}; /* struct BeaconObservations */
+}; /* struct BasicBeaconObservations */
 
-struct DataBlock {
+template <typename T> struct BasicDataBlock {
   /* the block header */
   RinexDataRecordHeader mheader;
   /**/
-  std::vector<BeaconObservations> mbeacon_obs;
-}; /* struct DorisObsRinexDataBlock */
+  std::vector<BasicBeaconObservations<T>> mbeacon_obs;
+  /* columns of the observables (within m_values), as in the file header */
+  ObservationColumns mcolumns;
+
+  /* @brief Column of an observable within m_values, -1 if not recorded */
+  int column(DorisObservationCode code) const noexcept {
+    return mcolumns(code);
+  }
+
+  /** @brief The observation of an observable, for the beacon at the given
+   *         index (in mbeacon_obs); nullptr if the observable is not
+   *         recorded in the file. E.g.
+   *         block.value(0, DorisObservationCode{DorisObservationType::phase, 1})
+   */
+  const BasicObservationValue<T> *value(int beacon,
+                                        DorisObservationCode code) const
+      noexcept {
+    const int k = mcolumns(code);
+    return (k < 0) ? nullptr : &mbeacon_obs[beacon].m_values[k];
+  }
+}; /* struct BasicDataBlock */
+
+/* Observation values, beacon observations and data blocks, as double */
+using RinexObservationValue = BasicObservationValue<double>;
+using BeaconObservations = BasicBeaconObservations<double>;
+using DataBlock = BasicDataBlock<double>;
 
 
 } /* namespace doris_rnx */
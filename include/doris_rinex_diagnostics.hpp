@@ -0,0 +1,101 @@
+#ifndef __DSO_DORIS_RINEX_DIAGNOSTICS_HPP__
+#define __DSO_DORIS_RINEX_DIAGNOSTICS_HPP__
+
+#include <cstdint>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Severity of a diagnostic */
+enum class DiagLevel : int { debug = 0, info = 1, warning = 2, error = 3 };
+
+/** Diagnostics with a level lower than this are compiled out of the library
+ *  (i.e. they cost nothing at runtime). Set at build time, via the CMake
+ *  variable RNX_DIAG_MIN_LEVEL (0=debug, 1=info, 2=warning, 3=error, 4=none).
+ */
+#ifndef RNX_DIAG_MIN_LEVEL
+#define RNX_DIAG_MIN_LEVEL 1
+#endif
+static constexpr int DIAG_MIN_LEVEL{RNX_DIAG_MIN_LEVEL};
+
+/** Numeric diagnostic codes.
+ *
+ *  [10, 300): header fields; these are the error codes of
+ *             DorisRinexHeader::read(), e.g. 90-92 for APPROX POSITION XYZ
+ *  [1000, 2000): data blocks
+ *  [2000, 3000): compact RINEX
+ */
+namespace diag {
+constexpr int HEADER_LINE_IGNORED = 1;
+constexpr int HEADER_READ_FAILED = 2;
+constexpr int HEADER_STATION_REFERENCE = 171;
+constexpr int HEADER_TIME_REF_STATION_UNKNOWN = 193;
+
+constexpr int DATA_READ_LINE = 1000;
+constexpr int DATA_RECORD_EPOCH = 1001;
+constexpr int DATA_RECORD_FLAG = 1002;
+constexpr int DATA_RECORD_NUM_STATIONS = 1003;
+constexpr int DATA_RECORD_CLOCK_OFFSET = 1004;
+constexpr int DATA_RECORD_CLOCK_FLAG = 1005;
+constexpr int DATA_BLOCK_HEADER = 1006;
+constexpr int DATA_BLOCK_TRUNCATED = 1007;
+constexpr int DATA_EXPECTED_BEACON = 1008;
+constexpr int DATA_OBSERVATION_VALUE = 1009;
+constexpr int DATA_INVALID_BLOCK = 1010;
+constexpr int DATA_SOURCE_FAILED = 1011;
+
+constexpr int COMPACT_READ_LINE = 2000;
+constexpr int COMPACT_EXPECTED_RECORD = 2001;
+constexpr int COMPACT_RECORD_LINE = 2002;
+constexpr int COMPACT_EXPECTED_BEACON = 2003;
+constexpr int COMPACT_ARC_TOKEN = 2004;
+constexpr int COMPACT_DIFF_TOKEN = 2005;
+constexpr int COMPACT_SPECIAL_EVENT = 2006;
+constexpr int COMPACT_VALUE = 2007;
+} /* namespace diag */
+
+/** @struct Diagnostic
+ *  @brief A message from the library (e.g. a parsing error), as handed to
+ *         the diagnostics sink.
+ *
+ *  Pointers are only valid during the call to the sink.
+ */
+struct Diagnostic {
+  DiagLevel m_level;
+  /* numeric code (see namespace diag) */
+  int m_code;
+  /* function reporting the diagnostic */
+  const char *m_func;
+  /* line number in the file (1-based), or -1 if unknown */
+  long m_line;
+  /* byte offset of the (start of the) line in the file, or -1 if unknown */
+  std::int64_t m_offset;
+  /* the offending line or field, or null */
+  const char *m_text;
+}; /* struct Diagnostic */
+
+/** @brief Function receiving diagnostics; data is the pointer given to
+ *  set_diagnostics_sink(). It may be called concurrently, from any thread
+ *  reading a file.
+ */
+using diagnostics_sink = void (*)(const Diagnostic &, void *data);
+
+/** @brief Install the sink receiving all diagnostics (of all readers); a
+ *  null sink discards them. The default sink (see stderr_sink) writes them
+ *  to stderr.
+ *
+ *  @note Should be called before any file is read.
+ */
+void set_diagnostics_sink(diagnostics_sink sink, void *data = nullptr) noexcept;
+
+/* @brief Sink writing a line per diagnostic to stderr (the default) */
+void stderr_sink(const Diagnostic &d, void *data) noexcept;
+
+/* @brief A (static) description of a diagnostic code */
+const char *diagnostic_message(int code) noexcept;
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef __DSO_DORIS_RINEX_EIGEN_HPP__
+#define __DSO_DORIS_RINEX_EIGEN_HPP__
+
+#include <Eigen/Core>
+
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* A (dynamic) row-major matrix, i.e. the layout of an ObservationMatrix */
+template <typename T>
+using RowMajorMatrix =
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+/* Views over the values of an ObservationMatrix (beacons x observables) */
+template <typename T> using MatrixView = Eigen::Map<RowMajorMatrix<T>>;
+template <typename T>
+using ConstMatrixView = Eigen::Map<const RowMajorMatrix<T>>;
+
+/* View over an observable of an ObservationMatrix (one value per beacon) */
+template <typename T>
+using ConstStridedView =
+    Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, 1>, Eigen::Unaligned,
+               Eigen::InnerStride<>>;
+
+/* View over an observable of an ObservationTable (one value per row) */
+template <typename T>
+using ConstColumnView = Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, 1>>;
+
+/** @brief The values of a data block, as a (beacons x observables) matrix.
+ *
+ *  These are views (no copies): they remain valid until the storage is
+ *  read into again; e.g.
+ *    const Eigen::VectorXd mean = observations(m).colwise().mean();
+ *  T should be double or float (i.e. not FixedPoint).
+ */
+template <typename T>
+ConstMatrixView<T> observations(const ObservationMatrix<T> &m) noexcept {
+  return ConstMatrixView<T>(m.m_values.data(), m.num_beacons(), m.num_obs());
+}
+template <typename T>
+MatrixView<T> observations(ObservationMatrix<T> &m) noexcept {
+  return MatrixView<T>(m.m_values.data(), m.num_beacons(), m.num_obs());
+}
+
+/* @brief The values of an observable (given by index) in a data block */
+template <typename T>
+ConstStridedView<T> observable(const ObservationMatrix<T> &m,
+                               int obs) noexcept {
+  return ConstStridedView<T>(m.m_values.data() + obs, m.num_beacons(),
+                             Eigen::InnerStride<>(m.num_obs()));
+}
+
+/* @brief The values of an observable in a data block; empty if the
+ *        observable is not recorded
+ */
+template <typename T>
+ConstStridedView<T> observable(const ObservationMatrix<T> &m,
+                               DorisObservationCode code) noexcept {
+  const int k = m.column(code);
+  return (k < 0) ? ConstStridedView<T>(nullptr, 0, Eigen::InnerStride<>(1))
+                 : observable(m, k);
+}
+
+/* @brief The values of an observable (given by index) in a whole file */
+template <typename T>
+ConstColumnView<T> observable(const ObservationTable<T> &t,
+                              int obs) noexcept {
+  return ConstColumnView<T>(t.values(obs), t.num_rows());
+}
+
+/* @brief The values of an observable in a whole file; empty if the
+ *        observable is not recorded
+ */
+template <typename T>
+ConstColumnView<T> observable(const ObservationTable<T> &t,
+                              DorisObservationCode code) noexcept {
+  const int k = t.column(code);
+  return (k < 0) ? ConstColumnView<T>(nullptr, 0) : observable(t, k);
+}
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef __DSO_DORIS_RINEX_FLAGS_HPP__
+#define __DSO_DORIS_RINEX_FLAGS_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "doris_rinex_kernels.hpp"
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* A bit per row (bit i % 64 of word i / 64 for row i) */
+using RowMask = std::vector<std::uint64_t>;
+
+/** @class FlagColumns
+ *  @brief The m1 and m2 flags of a whole file (e.g. of an ObservationTable),
+ *         packed by observable: 4 bits per flag (see kernels::flag_code),
+ *         i.e. a quarter of the memory of the raw chars.
+ *
+ *  Screening is done on bit masks of the rows, built off the packed
+ *  columns with (runtime-dispatched) vector kernels; e.g. the number of
+ *  values with an m2 flag, per beacon:
+ *    FlagColumns f(table);
+ *    const auto counts = f.count_by_beacon(f.flagged(obs, 2));
+ */
+class FlagColumns {
+  std::size_t m_num_rows{0};
+  int m_num_obs{0};
+  /* packed m1 and m2 flags, per observable ((num_rows + 1) / 2 bytes) */
+  std::vector<std::vector<std::uint8_t>> m_flags1;
+  std::vector<std::vector<std::uint8_t>> m_flags2;
+  /* per row, the index of its beacon (in m_beacon_ids) */
+  std::vector<int> m_beacon;
+  /* distinct beacon ids, in order of first appearance */
+  std::vector<std::string> m_beacon_ids;
+
+  /* set the beacons of the rows, off their (4-char) ids */
+  void set_beacons(const char *ids, std::size_t num_rows);
+
+ public:
+  /* @brief Constructor, off an ObservationTable (flags are copied) */
+  template <typename T> explicit FlagColumns(const ObservationTable<T> &t) {
+    m_num_rows = t.num_rows();
+    m_num_obs = t.num_obs();
+    for (int k = 0; k < m_num_obs; k++) {
+      m_flags1.emplace_back((m_num_rows + 1) / 2);
+      m_flags2.emplace_back((m_num_rows + 1) / 2);
+      kernels::pack_flags(t.m_flags1[k].data(), m_num_rows,
+                          m_flags1.back().data());
+      kernels::pack_flags(t.m_flags2[k].data(), m_num_rows,
+                          m_flags2.back().data());
+    }
+    set_beacons(t.m_beacon_ids.data(), m_num_rows);
+  }
+
+  std::size_t num_rows() const noexcept { return m_num_rows; }
+  int num_obs() const noexcept { return m_num_obs; }
+
+  /* @brief Packed flags (1 for m1, 2 for m2) of an observable */
+  const std::uint8_t *packed(int obs, int which) const noexcept {
+    return (which == 1 ? m_flags1 : m_flags2)[obs].data();
+  }
+
+  /** @brief The flag (1 for m1, 2 for m2) of a value, as a char; flags
+   *         other than blanks and digits are given as '?'
+   */
+  char flag(std::size_t row, int obs, int which) const noexcept;
+
+  /* @brief Beacons (ids) counted by count_by_beacon, in that order */
+  const std::vector<std::string> &beacon_ids() const noexcept {
+    return m_beacon_ids;
+  }
+
+  /** @brief Mask of the rows where the flag (1 for m1, 2 for m2) of an
+   *         observable has a code in [lo, hi] (see kernels::flag_code).
+   */
+  RowMask mask(int obs, int which, std::uint8_t lo, std::uint8_t hi) const;
+
+  /* @brief Mask of the rows where the flag is set (i.e. not blank) */
+  RowMask flagged(int obs, int which) const {
+    return mask(obs, which, kernels::FLAG_BLANK + 1, kernels::FLAG_OTHER);
+  }
+
+  /* @brief Mask of the rows where the flag is the given char */
+  RowMask equal(int obs, int which, char c) const {
+    const std::uint8_t code = kernels::flag_code(c);
+    return mask(obs, which, code, code);
+  }
+
+  /* @brief Number of rows in a mask */
+  static std::size_t count(const RowMask &m) noexcept;
+
+  /* @brief Number of rows in a mask, per beacon (see beacon_ids) */
+  std::vector<std::size_t> count_by_beacon(const RowMask &m) const;
+}; /* class FlagColumns */
+
+/* @brief Rows in both masks (of the same size) */
+inline RowMask mask_and(const RowMask &a, const RowMask &b) {
+  RowMask m(a.size());
+  for (std::size_t w = 0; w < m.size(); w++) m[w] = a[w] & b[w];
+  return m;
+}
+
+/* @brief Rows in any of the masks (of the same size) */
+inline RowMask mask_or(const RowMask &a, const RowMask &b) {
+  RowMask m(a.size());
+  for (std::size_t w = 0; w < m.size(); w++) m[w] = a[w] | b[w];
+  return m;
+}
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
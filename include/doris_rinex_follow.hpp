@@ -0,0 +1,148 @@
+#ifndef __DSO_DORIS_RINEX_FOLLOW_HPP__
+#define __DSO_DORIS_RINEX_FOLLOW_HPP__
+
+#include <istream>
+#include <memory>
+
+#include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Options for following a growing RINEX file */
+struct FollowOptions {
+  /* use inotify to get notified of appended data; else (or if inotify is
+   * not available) the file size is polled
+   */
+  bool m_use_inotify{true};
+  /* interval (in milliseconds) between checks of the file size, when
+   * polling
+   */
+  int m_poll_interval_ms{200};
+}; /* struct FollowOptions */
+
+} /* namespace doris_rnx */
+
+/** @class DorisRinexFollower
+ *  @brief Read data blocks off a DORIS RINEX file that is still being
+ *         written (i.e. a 'tail -f' for RINEX files).
+ *
+ *  The header must already be in the file at construction. Data blocks are
+ *  then read as they are appended: before parsing, the follower checks that
+ *  the next block is complete (i.e. its record line and all its beacon lines
+ *  are there, newline-terminated). If not, the stream is left at the offset
+ *  of the block (i.e. right after the last complete block) and the follower
+ *  waits for the file to grow, via inotify or by polling its size. Hence,
+ *  a partially written block is never parsed, and nothing before the last
+ *  complete block is ever read again.
+ *
+ *  Only plain (uncompressed, non-compact) RINEX files can be followed. An
+ *  instance is not thread-safe, except for stop() which can be called from
+ *  any thread.
+ *
+ *  next() returns an int denoting:
+ *    < 0 : No complete block became available within the timeout (or the
+ *          follower was stopped); block is invalid
+ *    = 0 : All ok, data collected and stored in block
+ *    > 0 : Error, failed to collect the block; block is invalid
+ */
+class DorisRinexFollower {
+ public:
+  /* Let's not write this more than once. */
+  typedef DorisRinexHeader::pos_type pos_type;
+
+ private:
+  /* file descriptors and stream; defined in the implementation file */
+  struct Impl;
+
+  /* the header, read at construction */
+  std::shared_ptr<const DorisRinexHeader> m_header;
+  std::unique_ptr<Impl> m_impl;
+  /* offset of the next block to be read (i.e. after the last complete one) */
+  pos_type m_pos;
+
+  /* @brief Check if a complete data block starts at m_pos; returns < 0 if
+   * not (yet), 0 if it does, > 0 on error. The stream is left at m_pos.
+   */
+  int block_complete() noexcept;
+
+  /* @brief Wait for the file to change, for up to timeout_ms (< 0 means
+   * forever); returns false on timeout or stop.
+   */
+  bool wait_for_data(int timeout_ms) noexcept;
+
+ public:
+  /** @brief Constructor; opens the file and reads its header.
+   *  @throw std::runtime_error if the file cannot be opened, its header
+   *         cannot be read, or it is a compact RINEX file.
+   */
+  explicit DorisRinexFollower(
+      const char *fn,
+      const doris_rnx::FollowOptions &opts = doris_rnx::FollowOptions{});
+
+  /* @brief Destructor */
+  ~DorisRinexFollower() noexcept;
+
+  /* @brief Copy not allowed ! */
+  DorisRinexFollower(const DorisRinexFollower &) = delete;
+
+  /* @brief Assignment not allowed ! */
+  DorisRinexFollower &operator=(const DorisRinexFollower &) = delete;
+
+  /* @brief The (immutable) header of the RINEX file */
+  const DorisRinexHeader &header() const noexcept { return *m_header; }
+
+  /* @brief The header, in a form that can be shared (e.g. across threads) */
+  std::shared_ptr<const DorisRinexHeader> shared_header() const noexcept {
+    return m_header;
+  }
+
+  /* @brief Byte offset of the next block to be read */
+  pos_type tell() const noexcept { return m_pos; }
+
+  /* @brief True if inotify is used to wait for data (else, polling) */
+  bool uses_inotify() const noexcept;
+
+  /** @brief A file descriptor that becomes readable when the file may have
+   *         grown (if inotify is used) or once the follower is stopped;
+   *         e.g. to wait on many followers with one poll(2), or to drive
+   *         followers off any event loop (or coroutine scheduler):
+   *           struct pollfd p{f.wait_fd(), POLLIN, 0};
+   *           ::poll(&p, 1, f.wait_interval_ms());
+   *           while (!f.next(block, 0)) { ... }
+   *         Pending notifications are cleared by next(). The descriptor is
+   *         owned by the follower; it must not be read off or closed.
+   */
+  int wait_fd() const noexcept;
+
+  /* @brief Max time (in milliseconds) to wait on wait_fd() before checking
+   * the file again: -1 (i.e. no limit) if inotify is used, else the poll
+   * interval
+   */
+  int wait_interval_ms() const noexcept;
+
+  /** @brief Read the next data block, waiting for it if needed.
+   *
+   *  @param[out] block      The data block read
+   *  @param[in]  timeout_ms Max time to wait for a complete block (in
+   *                         milliseconds); 0 means do not wait, < 0 means
+   *                         wait until a block is available or stop() is
+   *                         called
+   */
+  int next(doris_rnx::DataBlock &block, int timeout_ms = -1) noexcept;
+
+  /** @brief Wake up a (blocked) call to next() and make it return; further
+   *  calls to next() only return blocks already available, without waiting.
+   *  Thread-safe.
+   */
+  void stop() noexcept;
+
+  /* @brief True if stop() has been called. Thread-safe. */
+  bool stopped() const noexcept;
+}; /* class DorisRinexFollower */
+
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef __DSO_DORIS_RINEX_HEADER_HPP__
+#define __DSO_DORIS_RINEX_HEADER_HPP__
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+#include "doris_rinex_details.hpp"
+#include "obstypes.hpp"
+
+namespace dso {
+
+/** @class DorisRinexHeader
+ *  @brief Metadata collected from the header of a DORIS Observation RINEX
+ *         file.
+ *
+ *  An instance is filled once (via read()) and is never modified afterwards;
+ *  hence it can be shared (e.g. via std::shared_ptr<const DorisRinexHeader>)
+ *  between any number of readers/cursors of the same file, even across
+ *  threads.
+ *
+ *  @see RINEX DORIS 3.0 (Issue 1.7),
+ *       ftp://ftp.ids-doris.org/pub/ids/data/RINEX_DORIS.pdf
+ */
+class DorisRinexHeader {
+ public:
+  /* Let's not write this more than once. */
+  typedef std::istream::pos_type pos_type;
+
+  /* No header line can have more than 80 chars. */
+  static constexpr int MAX_HEADER_CHARS{81};
+
+ private:
+  /* RINEX version */
+  float m_version;
+
+  char m_char_pool[256];
+  /* Satellite name */
+  static constexpr int m_satellite_name_at = 0;  // [60]
+  /* COSPAR number */
+  static constexpr int m_cospar_number_at = 60;  // [20]
+  /* DORIS chain used (chain1 or chain2), exp. “CHAIN1” */
+  static constexpr int m_rec_chain_at = 80;  // [20]
+  /* DORIS instrument type; exp. “DGXX” */
+  static constexpr int m_rec_type_at = 100;  // [20]
+  /* The software version used on board DORIS/DIODE, exp. “1.00” */
+  static constexpr int m_rec_version_at = 120;  // [20]
+  /* The antenna type is “STAREC” */
+  static constexpr int m_antenna_type_at = 140;  // [20]
+  /* The antenna number is “DORIS” */
+  static constexpr int m_antenna_number_at = 160;  // [20]
+
+  /* Position of 2 GHz phase center, in the platform reference frame (Units:
+   * Meters, System: ITRS recommended)
+   */
+  float m_approx_position[3];
+
+  /** The center of mass of the vehicle (for space borne receivers):
+   *  CENTER OF MASS: XYZ, defined at the beginning of the mission.
+   */
+  float m_center_mass[3];
+
+  /* A vector of ObservationCode contained in the RINEX file */
+  std::vector<DorisObservationCode> m_obs_codes;
+
+  /** A vector of scale factors corresponding to m_obs_codes (aka they have
+   *  the same size with a one-to-one correspondance
+   */
+  std::vector<int> m_obs_scale_factors;
+
+  /* Column of every observable in m_obs_codes, for O(1) look-ups */
+  doris_rnx::ObservationColumns m_obs_columns;
+
+  /* Datetime of first observation in RINEX */
+  Datetime<nanoseconds> m_time_of_first_obs;
+
+  /** This date corresponds to the day of the first measurement performed on
+   *  the first time reference beacon in the DORIS RINEX product, at
+   *  00h 00mn 00s.
+   */
+  Datetime<nanoseconds> m_time_ref_stat;
+
+  /** Constant shift between the date of the 400MHz phase measurement and the
+   *  date of the 2GHz phase measurement in microseconds. Positive if the
+   *  measurement of phase 400 MHz is performed after the measurement of phase
+   *  2 GHz
+   */
+  double m_l12_date_offset;
+
+  /** Epoch, code, and phase are corrected by applying the realtime-derived
+   *  receiver clock offset: 1=yes, 0=no; default: 0=no
+   */
+  bool rcv_clock_offs_appl{false};
+
+  /* List of stations/beacons recorded in file */
+  std::vector<doris_rnx::Beacon> m_stations;
+
+  /* List of time-reference stations in file (also included in m_stations) */
+  std::vector<doris_rnx::TimeReferenceStation> m_ref_stations;
+
+  /* True if this is a compact (i.e. differenced) RINEX file */
+  bool m_compact{false};
+
+  /* Mark the 'END OF HEADER' field (next line is record line) */
+  pos_type m_end_of_head;
+
+  /* Hash (64-bit FNV-1a) of all header lines, up to END OF HEADER */
+  std::uint64_t m_fingerprint{0};
+
+  char *satellite_name() noexcept { return m_char_pool + m_satellite_name_at; }
+  char *cospar_number() noexcept { return m_char_pool + m_cospar_number_at; }
+  char *rec_chain() noexcept { return m_char_pool + m_rec_chain_at; }
+  char *rec_type() noexcept { return m_char_pool + m_rec_type_at; }
+  char *rec_version() noexcept { return m_char_pool + m_rec_version_at; }
+  char *antenna_type() noexcept { return m_char_pool + m_antenna_type_at; }
+  char *antenna_number() noexcept { return m_char_pool + m_antenna_number_at; }
+
+ public:
+  /* @brief Default constructor; (pre-)allocates memory */
+  DorisRinexHeader() noexcept;
+
+  /** @brief Read a RINEX header off a stream, and collect all metadata.
+   *
+   *  The stream must be open and in good state. If it is not placed at the
+   *  top of the file, it will be rewinded to the top. Both RINEX and compact
+   *  RINEX headers are accepted. On success, the stream
+   *  is left at the first line after 'END OF HEADER'.
+   *
+   *  @return Anything other than 0 denotes an error.
+   */
+  int read(std::istream &is) noexcept;
+
+  const char *satellite_name() const noexcept {
+    return m_char_pool + m_satellite_name_at;
+  }
+  const char *cospar_number() const noexcept {
+    return m_char_pool + m_cospar_number_at;
+  }
+  const char *rec_chain() const noexcept {
+    return m_char_pool + m_rec_chain_at;
+  }
+  const char *rec_type() const noexcept { return m_char_pool + m_rec_type_at; }
+  const char *rec_version() const noexcept {
+    return m_char_pool + m_rec_version_at;
+  }
+  const char *antenna_type() const noexcept {
+    return m_char_pool + m_antenna_type_at;
+  }
+  const char *antenna_number() const noexcept {
+    return m_char_pool + m_antenna_number_at;
+  }
+
+  float version() const noexcept { return m_version; }
+  const float *approx_position() const noexcept { return m_approx_position; }
+  const float *center_of_mass() const noexcept { return m_center_mass; }
+  const std::vector<DorisObservationCode> &obs_codes() const noexcept {
+    return m_obs_codes;
+  }
+  const std::vector<int> &obs_scale_factors() const noexcept {
+    return m_obs_scale_factors;
+  }
+  const doris_rnx::ObservationColumns &obs_columns() const noexcept {
+    return m_obs_columns;
+  }
+
+  /** @brief Index of an observable within obs_codes() (and hence within the
+   *         values of any beacon in the data blocks), in O(1); -1 if the
+   *         observable is not recorded in the file.
+   */
+  int obs_index(DorisObservationCode code) const noexcept {
+    return m_obs_columns(code);
+  }
+  Datetime<nanoseconds> time_of_first_obs() const noexcept {
+    return m_time_of_first_obs;
+  }
+  Datetime<nanoseconds> time_ref_stat() const noexcept {
+    return m_time_ref_stat;
+  }
+  double l12_date_offset() const noexcept { return m_l12_date_offset; }
+  bool rcv_clock_offset_applied() const noexcept { return rcv_clock_offs_appl; }
+  const std::vector<doris_rnx::Beacon> &stations() const noexcept {
+    return m_stations;
+  }
+  const std::vector<doris_rnx::TimeReferenceStation> &ref_stations()
+      const noexcept {
+    return m_ref_stations;
+  }
+
+  /** @brief True if the file is a compact RINEX file, i.e. data blocks are
+   *  differenced (see doris_rinex_compact.hpp)
+   */
+  bool is_compact() const noexcept { return m_compact; }
+
+  /* @brief Byte offset of the first line after 'END OF HEADER' */
+  pos_type end_of_header() const noexcept { return m_end_of_head; }
+
+  /** @brief A hash of the header lines (up to and including END OF HEADER),
+   *  used to tell if two headers (e.g. of a file and of a checkpoint) match
+   */
+  std::uint64_t fingerprint() const noexcept { return m_fingerprint; }
+
+  /** Depending on the number of observables, compute the number of lines
+   * needed to hold a full data record (i.e. within a data block). Each data
+   * line can hold up to 5 observable values.
+   */
+  int lines_per_beacon() const noexcept {
+    const int obs = m_obs_codes.size();
+    return 1 + (!(obs % 5) ? (obs / 5 - 1) : (obs / 5));
+  }
+}; /* class DorisRinexHeader */
+
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef __DSO_DORIS_RINEX_KERNELS_HPP__
+#define __DSO_DORIS_RINEX_KERNELS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** Hot kernels, built in several variants (one per instruction set) within
+ *  the same library; the best variant the CPU supports is selected at load
+ *  time (via CPUID), so the library need not be built for a specific CPU
+ *  (e.g. with -march=native).
+ */
+namespace kernels {
+
+/* Instruction sets kernels are built for */
+enum class Isa : int { generic = 0, sse2, avx2, avx512 };
+
+/* @brief The instruction set of the kernels in use */
+Isa active_isa() noexcept;
+
+/* @brief Name of an instruction set (e.g. "avx2") */
+const char *isa_name(Isa isa) noexcept;
+
+/** @brief Use the kernels of another instruction set (e.g. for testing or
+ *         benchmarking).
+ *
+ *  @return false if the instruction set is not supported by the CPU (or
+ *          the library was built without it); nothing changes then.
+ *  @note Not thread-safe; call before any file is read.
+ */
+bool select_isa(Isa isa) noexcept;
+
+/* Status of a decoded observation field (see decode_fields) */
+enum : std::uint8_t { FIELD_VALUE = 0, FIELD_BLANK = 1, FIELD_IRREGULAR = 2 };
+
+/* Width of an observation field (F14.3) plus its two flags */
+static constexpr int FIELD_CHARS = 16;
+
+/** @brief Decode (up to 5) consecutive observation fields of a data line.
+ *
+ *  Each field is FIELD_CHARS wide and all n * FIELD_CHARS characters must be
+ *  readable (i.e. short lines should be padded with blanks). The value of
+ *  field k (14 chars, F14.3) is classified as:
+ *    FIELD_BLANK     : all blanks (missing value)
+ *    FIELD_VALUE     : of the form [blanks][-]digits.ddd; mantissa[k] is
+ *                      the value in units of 1e-3 (i.e. exact)
+ *    FIELD_IRREGULAR : anything else (e.g. another number of decimals, or
+ *                      not a number), or a negative zero (e.g. -0.000,
+ *                      which a mantissa cannot hold); should be parsed
+ *                      otherwise
+ *
+ *  Note that mantissa[k] / 1e3 is the (correctly rounded) double nearest
+ *  to the field, i.e. as given by std::from_chars.
+ */
+void decode_fields(const char *fields, int n, std::int64_t *mantissa,
+                   std::uint8_t *status) noexcept;
+
+/** @brief Resolve scaled values off integer mantissas:
+ *         out[i] = (mantissa[i] / unit) / scale
+ *  The operations (and hence the results) are the ones of the RINEX parser
+ *  (for unit = 1e3).
+ */
+void scale_values(const std::int64_t *mantissa, std::size_t n, double unit,
+                  double scale, double *out) noexcept;
+
+/* Encoding of m1/m2 flags in packed flag columns (4 bits per flag):
+ * FLAG_BLANK for ' ', digit d as d + 1 and FLAG_OTHER for anything else
+ */
+enum : std::uint8_t { FLAG_BLANK = 0, FLAG_OTHER = 15 };
+
+/* @brief The (4-bit) code of a flag */
+inline std::uint8_t flag_code(char c) noexcept {
+  if (c == ' ') return FLAG_BLANK;
+  return (c >= '0' && c <= '9') ? (c - '0' + 1) : FLAG_OTHER;
+}
+
+/** @brief Pack n flags (chars) into a flag column of (n + 1) / 2 bytes; flag
+ *         i goes to the low (even i) or high (odd i) nibble of byte i / 2.
+ */
+void pack_flags(const char *flags, std::size_t n,
+                std::uint8_t *packed) noexcept;
+
+/** @brief Bit mask (of (n + 63) / 64 words) of the flags in a packed column
+ *         with a code in [lo, hi]; bit i % 64 of word i / 64 stands for
+ *         flag i. Bits past n are cleared.
+ */
+void flag_mask(const std::uint8_t *packed, std::size_t n, std::uint8_t lo,
+               std::uint8_t hi, std::uint64_t *mask) noexcept;
+
+} /* namespace kernels */
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
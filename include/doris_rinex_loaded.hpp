@@ -0,0 +1,199 @@
+#ifndef __DSO_DORIS_RINEX_LOADED_HPP__
+#define __DSO_DORIS_RINEX_LOADED_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @struct EpochView
+ *  @brief A (non-owning) view of the observations of an epoch, within an
+ *         ObservationTable; cheap to copy.
+ */
+template <typename T> struct EpochView {
+  const ObservationTable<T> *m_table;
+  /* the epoch (index in m_table->m_epochs); it may have no rows */
+  std::size_t m_epoch;
+  /* first row of the epoch, and number of rows (i.e. beacons) */
+  std::size_t m_first;
+  int m_num_beacons;
+
+  const RinexDataRecordHeader &header() const noexcept {
+    return m_table->m_epochs[m_epoch];
+  }
+  const Datetime<nanoseconds> &epoch() const noexcept {
+    return header().m_epoch;
+  }
+  int num_beacons() const noexcept { return m_num_beacons; }
+  int num_obs() const noexcept { return m_table->num_obs(); }
+  /* @brief Row (in the table) of a beacon (given by index) */
+  std::size_t row(int beacon) const noexcept { return m_first + beacon; }
+  const char *beacon_id(int beacon) const noexcept {
+    return m_table->beacon_id(m_first + beacon);
+  }
+  T value(int beacon, int obs) const noexcept {
+    return m_table->value(m_first + beacon, obs);
+  }
+  /* @brief Value of an observable; nullptr if not recorded */
+  const T *value(int beacon, DorisObservationCode code) const noexcept {
+    const int k = m_table->column(code);
+    return (k < 0) ? nullptr : m_table->values(k) + m_first + beacon;
+  }
+  char flag1(int beacon, int obs) const noexcept {
+    return m_table->flag1(m_first + beacon, obs);
+  }
+  char flag2(int beacon, int obs) const noexcept {
+    return m_table->flag2(m_first + beacon, obs);
+  }
+}; /* struct EpochView */
+
+/** @struct RecordView
+ *  @brief A (non-owning) view of an observation record, i.e. of the
+ *         observations of a beacon at an epoch; cheap to copy.
+ */
+template <typename T> struct RecordView {
+  const ObservationTable<T> *m_table;
+  std::size_t m_row;
+
+  const RinexDataRecordHeader &header() const noexcept {
+    return m_table->epoch(m_row);
+  }
+  const Datetime<nanoseconds> &epoch() const noexcept {
+    return m_table->epoch(m_row).m_epoch;
+  }
+  const char *beacon_id() const noexcept { return m_table->beacon_id(m_row); }
+  T value(int obs) const noexcept { return m_table->value(m_row, obs); }
+  char flag1(int obs) const noexcept { return m_table->flag1(m_row, obs); }
+  char flag2(int obs) const noexcept { return m_table->flag2(m_row, obs); }
+}; /* struct RecordView */
+
+/* A pair of iterators, usable as a range (e.g. in range-for loops) */
+template <typename It> struct Subrange {
+  It m_begin, m_end;
+  It begin() const noexcept { return m_begin; }
+  It end() const noexcept { return m_end; }
+  std::size_t size() const noexcept { return m_end - m_begin; }
+  bool empty() const noexcept { return m_begin == m_end; }
+  decltype(auto) operator[](std::size_t i) const noexcept {
+    return m_begin[i];
+  }
+}; /* struct Subrange */
+
+/** @class LoadedRinex
+ *  @brief A DORIS RINEX file, loaded in memory (in an ObservationTable),
+ *         with random-access iteration over its epochs.
+ *
+ *  Iterators are random-access iterators over (real, stored) EpochView's,
+ *  hence the epochs can be handed to standard algorithms, including the
+ *  parallel ones, or split among the threads of a pool by index; e.g.
+ *    LoadedRinex<> data("file.rnx");
+ *    std::for_each(std::execution::par, data.begin(), data.end(),
+ *                  [](const EpochView<double> &e) { ... });
+ *  All views refer to the storage of the instance; they are valid as long
+ *  as the instance is (including after a move). Special events (i.e. blocks
+ *  without observations) are not listed as epochs.
+ */
+template <typename T = double> class LoadedRinex {
+  std::unique_ptr<ObservationTable<T>> m_table;
+  std::vector<EpochView<T>> m_epochs;
+
+  /* read all blocks, and list the epochs */
+  template <typename Validation> void load(DorisObsReader<Validation> &reader) {
+    reader.rewind();
+    int status;
+    while (!(status = reader.next(*m_table)))
+      ;
+    if (status > 0)
+      throw std::runtime_error("[ERROR] Failed loading RINEX data blocks\n");
+
+    const auto &t = *m_table;
+    std::size_t row = 0;
+    for (std::size_t e = 0; e < t.num_epochs(); e++) {
+      std::size_t end = row;
+      while (end < t.num_rows() && t.m_epoch_index[end] == (int)e) ++end;
+      if (t.m_epochs[e].m_flag <= 1)
+        m_epochs.push_back(EpochView<T>{&t, e, row, (int)(end - row)});
+      row = end;
+    }
+  }
+
+ public:
+  using const_iterator = typename std::vector<EpochView<T>>::const_iterator;
+  using iterator = const_iterator;
+  using value_type = EpochView<T>;
+
+  /** @brief Constructor; loads all data blocks via a DorisObsReader, with
+   *         its validation policy (see doris_rinex_policy.hpp).
+   *  @throw std::runtime_error if a data block fails (unless in lenient
+   *         mode, see DorisObsRinex).
+   */
+  template <typename Validation>
+  explicit LoadedRinex(DorisObsReader<Validation> &reader)
+      : m_table(std::make_unique<ObservationTable<T>>()) {
+    load(reader);
+  }
+
+  /** @brief Constructor off a filename (Checked).
+   *  @throw std::runtime_error if the file cannot be read (see
+   *         DorisObsRinex) or a data block fails.
+   */
+  explicit LoadedRinex(const char *fn)
+      : m_table(std::make_unique<ObservationTable<T>>()) {
+    DorisObsReader<Checked> reader(fn);
+    load(reader);
+  }
+
+  LoadedRinex(const LoadedRinex &) = delete;
+  LoadedRinex &operator=(const LoadedRinex &) = delete;
+  LoadedRinex(LoadedRinex &&) noexcept = default;
+  LoadedRinex &operator=(LoadedRinex &&) noexcept = default;
+
+  /* @brief The underlying table (i.e. all records, by observable) */
+  const ObservationTable<T> &table() const noexcept { return *m_table; }
+
+  /* Epochs */
+  const_iterator begin() const noexcept { return m_epochs.cbegin(); }
+  const_iterator end() const noexcept { return m_epochs.cend(); }
+  std::size_t size() const noexcept { return m_epochs.size(); }
+  bool empty() const noexcept { return m_epochs.empty(); }
+  const EpochView<T> &operator[](std::size_t i) const noexcept {
+    return m_epochs[i];
+  }
+
+  /** @brief The epochs in [t0, t1), in O(log n); epochs are taken to be in
+   *         chronological order.
+   */
+  Subrange<const_iterator> between(const Datetime<nanoseconds> &t0,
+                                   const Datetime<nanoseconds> &t1) const {
+    const auto cmp = [](const EpochView<T> &e, const Datetime<nanoseconds> &t) {
+      return e.epoch() < t;
+    };
+    const auto first = std::lower_bound(begin(), end(), t0, cmp);
+    return {first, std::lower_bound(first, end(), t1, cmp)};
+  }
+
+  /** @brief The records of a beacon (given by its 3-char id), in the order
+   *         of the file; a random-access container of RecordView's.
+   */
+  std::vector<RecordView<T>> beacon(const char *id) const {
+    std::vector<RecordView<T>> records;
+    const auto &t = *m_table;
+    for (const auto &e : m_epochs)
+      for (int b = 0; b < e.num_beacons(); b++)
+        if (!std::strncmp(t.beacon_id(e.row(b)), id, 3))
+          records.push_back(RecordView<T>{&t, e.row(b)});
+    return records;
+  }
+}; /* class LoadedRinex */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
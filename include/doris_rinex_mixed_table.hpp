@@ -0,0 +1,264 @@
+#ifndef __DSO_DORIS_RINEX_MIXED_TABLE_HPP__
+#define __DSO_DORIS_RINEX_MIXED_TABLE_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Value types a column of a MixedPrecisionTable can hold */
+enum class ColumnPrecision : char {
+  float32, /* float (4 bytes) */
+  float64, /* double (8 bytes), same values as DataBlock */
+  fixed    /* FixedPoint (8 bytes), exact */
+};
+
+/** @brief The default precision of an observable: double for phase and
+ *         pseudorange, float for the low-precision ones (power levels,
+ *         frequency offset and meteorological data).
+ */
+inline ColumnPrecision default_precision(DorisObservationCode code) noexcept {
+  switch (code.m_type) {
+    case DorisObservationType::phase:
+    case DorisObservationType::pseudorange:
+      return ColumnPrecision::float64;
+    default:
+      return ColumnPrecision::float32;
+  }
+}
+
+/** @class MixedPrecisionTable
+ *  @brief All data blocks of a file, stored by observable (as in an
+ *         ObservationTable), with a value type chosen per observable.
+ *
+ *  Low-precision observables kept as float use half the memory of doubles;
+ *  e.g. with the default precisions, values of a file with the usual ten
+ *  observables take 56 bytes per (epoch, beacon) record, instead of 160 for
+ *  a DataBlock. Columns are read into by DorisObsReader::next (as any
+ *  storage), off the exact (fixed-point) value of every field:
+ *    float64 : (value / 1e3) / scale, bit-identical to DataBlock values
+ *    float32 : the above, rounded to float
+ *    fixed   : the FixedPoint value (scale factor not applied)
+ *  Missing values are marked per column (see missing()).
+ */
+class MixedPrecisionTable {
+ public:
+  /* a column; only the vector of its precision is used */
+  struct Column {
+    ColumnPrecision m_precision;
+    int m_scale;
+    std::vector<float> m_f32;
+    std::vector<double> m_f64;
+    std::vector<FixedPoint> m_fixed;
+    std::vector<char> m_flags1;
+    std::vector<char> m_flags2;
+
+    void resize(std::size_t n) {
+      switch (m_precision) {
+        case ColumnPrecision::float32:
+          m_f32.resize(n);
+          break;
+        case ColumnPrecision::float64:
+          m_f64.resize(n);
+          break;
+        case ColumnPrecision::fixed:
+          m_fixed.resize(n);
+          break;
+      }
+      m_flags1.resize(n);
+      m_flags2.resize(n);
+    }
+  }; /* struct Column */
+
+  /* missing values of float32 columns */
+  static constexpr float MISSING_FLOAT32 = ValueTraits<float>::missing();
+
+ private:
+  ObservationColumns m_columns;
+  std::vector<Column> m_data;
+  std::vector<RinexDataRecordHeader> m_epochs;
+  std::vector<int> m_epoch_index;
+  std::vector<char> m_beacon_ids;
+  std::size_t m_num_rows{0};
+  std::size_t m_num_epochs{0};
+
+  friend struct StorageTraits<MixedPrecisionTable>;
+
+  /* drop rows and epochs past the ones read in full */
+  void truncate() {
+    m_epochs.resize(m_num_epochs);
+    m_epoch_index.resize(m_num_rows);
+    m_beacon_ids.resize(4 * m_num_rows);
+    for (auto &c : m_data) c.resize(m_num_rows);
+  }
+
+ public:
+  /* @brief Constructor; precisions as given by default_precision */
+  explicit MixedPrecisionTable(const DorisRinexHeader &hdr)
+      : m_columns(hdr.obs_columns()) {
+    const auto &codes = hdr.obs_codes();
+    const auto &scale = hdr.obs_scale_factors();
+    for (std::size_t k = 0; k < codes.size(); k++)
+      m_data.push_back(Column{default_precision(codes[k]), scale[k], {}, {},
+                              {}, {}, {}});
+  }
+
+  /** @brief Constructor, given the precision of every observable (in the
+   *         order of the header).
+   *  @throw std::runtime_error if the number of precisions is wrong.
+   */
+  MixedPrecisionTable(const DorisRinexHeader &hdr,
+                      const std::vector<ColumnPrecision> &precisions)
+      : m_columns(hdr.obs_columns()) {
+    const auto &scale = hdr.obs_scale_factors();
+    if (precisions.size() != scale.size())
+      throw std::runtime_error(
+          "[ERROR] Expected one precision per observable\n");
+    for (std::size_t k = 0; k < scale.size(); k++)
+      m_data.push_back(Column{precisions[k], scale[k], {}, {}, {}, {}, {}});
+  }
+
+  std::size_t num_rows() const noexcept { return m_num_rows; }
+  std::size_t num_epochs() const noexcept { return m_num_epochs; }
+  int num_obs() const noexcept { return m_data.size(); }
+  const RinexDataRecordHeader &epoch(std::size_t row) const noexcept {
+    return m_epochs[m_epoch_index[row]];
+  }
+  const char *beacon_id(std::size_t row) const noexcept {
+    return m_beacon_ids.data() + 4 * row;
+  }
+  /* @brief Column of an observable, -1 if not recorded */
+  int column(DorisObservationCode code) const noexcept {
+    return m_columns(code);
+  }
+  ColumnPrecision precision(int obs) const noexcept {
+    return m_data[obs].m_precision;
+  }
+
+  /* @brief Values of a column; nullptr if of another precision */
+  const float *float32_values(int obs) const noexcept {
+    return m_data[obs].m_precision == ColumnPrecision::float32
+               ? m_data[obs].m_f32.data()
+               : nullptr;
+  }
+  const double *float64_values(int obs) const noexcept {
+    return m_data[obs].m_precision == ColumnPrecision::float64
+               ? m_data[obs].m_f64.data()
+               : nullptr;
+  }
+  const FixedPoint *fixed_values(int obs) const noexcept {
+    return m_data[obs].m_precision == ColumnPrecision::fixed
+               ? m_data[obs].m_fixed.data()
+               : nullptr;
+  }
+
+  /* @brief True if the value is missing */
+  bool missing(std::size_t row, int obs) const noexcept {
+    const auto &c = m_data[obs];
+    switch (c.m_precision) {
+      case ColumnPrecision::float32:
+        return c.m_f32[row] == MISSING_FLOAT32;
+      case ColumnPrecision::float64:
+        return c.m_f64[row] == OBSERVATION_VALUE_MISSING / c.m_scale;
+      default:
+        return c.m_fixed[row] == ValueTraits<FixedPoint>::missing();
+    }
+  }
+
+  /** @brief A value, as a double (scale factor applied), whatever the
+   *         precision of its column; missing values are given as in a
+   *         DataBlock (i.e. OBSERVATION_VALUE_MISSING / scale).
+   */
+  double value(std::size_t row, int obs) const noexcept {
+    const auto &c = m_data[obs];
+    if (missing(row, obs)) return OBSERVATION_VALUE_MISSING / c.m_scale;
+    switch (c.m_precision) {
+      case ColumnPrecision::float32:
+        return c.m_f32[row];
+      case ColumnPrecision::float64:
+        return c.m_f64[row];
+      default:
+        return (c.m_fixed[row].m_value / 1e3) / c.m_scale;
+    }
+  }
+  char flag1(std::size_t row, int obs) const noexcept {
+    return m_data[obs].m_flags1[row];
+  }
+  char flag2(std::size_t row, int obs) const noexcept {
+    return m_data[obs].m_flags2[row];
+  }
+
+  /* @brief Bytes used by the values (i.e. not counting flags) */
+  std::size_t value_bytes() const noexcept {
+    std::size_t bytes = 0;
+    for (const auto &c : m_data)
+      bytes += m_num_rows *
+               (c.m_precision == ColumnPrecision::float32 ? sizeof(float)
+                                                          : sizeof(double));
+    return bytes;
+  }
+
+  /* @brief Drop all blocks */
+  void clear() {
+    m_num_rows = m_num_epochs = 0;
+    truncate();
+  }
+}; /* class MixedPrecisionTable */
+
+/* Values are read as FixedPoint (exact), then stored per column */
+template <> struct StorageTraits<MixedPrecisionTable> {
+  using value_type = FixedPoint;
+  static void begin_block(MixedPrecisionTable &s,
+                          const RinexDataRecordHeader &h,
+                          const ObservationColumns &, int num_beacons, int) {
+    /* drop what is left of a block that failed */
+    s.truncate();
+    const std::size_t rows = s.m_num_rows + num_beacons;
+    s.m_epochs.push_back(h);
+    s.m_epoch_index.resize(rows, s.m_num_epochs);
+    s.m_beacon_ids.resize(4 * rows, '\0');
+    for (auto &c : s.m_data) c.resize(rows);
+  }
+  static void begin_beacon(MixedPrecisionTable &s, int beacon,
+                           const char *id) noexcept {
+    std::memcpy(s.m_beacon_ids.data() + 4 * (s.m_num_rows + beacon), id, 3);
+  }
+  static void value(MixedPrecisionTable &s, int beacon, int obs, FixedPoint v,
+                    char f1, char f2) noexcept {
+    const std::size_t row = s.m_num_rows + beacon;
+    auto &c = s.m_data[obs];
+    const bool missing = (v == ValueTraits<FixedPoint>::missing());
+    switch (c.m_precision) {
+      case ColumnPrecision::float32:
+        c.m_f32[row] = missing ? MixedPrecisionTable::MISSING_FLOAT32
+                               : static_cast<float>((v.m_value / 1e3) /
+                                                    c.m_scale);
+        break;
+      case ColumnPrecision::float64:
+        c.m_f64[row] =
+            (missing ? OBSERVATION_VALUE_MISSING : v.m_value / 1e3) /
+            c.m_scale;
+        break;
+      case ColumnPrecision::fixed:
+        c.m_fixed[row] = v;
+        break;
+    }
+    c.m_flags1[row] = f1;
+    c.m_flags2[row] = f2;
+  }
+  static void end_block(MixedPrecisionTable &s) noexcept {
+    s.m_num_rows = s.m_epoch_index.size();
+    s.m_num_epochs = s.m_epochs.size();
+  }
+};
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef __DSO_DORIS_RINEX_PIPELINE_HPP__
+#define __DSO_DORIS_RINEX_PIPELINE_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Statistics of a pipeline stage (or of the source), after a run */
+struct StageStats {
+  /* blocks received */
+  std::size_t m_blocks_in{0};
+  /* blocks passed on (i.e. not dropped) */
+  std::size_t m_blocks_out{0};
+  /* times a block could not be passed on at once, because the next queue
+   * was full (i.e. how much the stage was held back by later ones); for the
+   * source, also times an ordered stage was waiting for an earlier block
+   */
+  std::size_t m_full_waits{0};
+}; /* struct StageStats */
+
+/** @class Pipeline
+ *  @brief Multi-stage, multi-threaded processing of data blocks: a source,
+ *         followed by stages (transforms, filters, sinks), each run by its
+ *         own threads.
+ *
+ *  Stages are connected by lock-free bounded queues; a stage waits when the
+ *  queue after it is full, so a slow stage holds back the ones before it
+ *  (backpressure) and the number of blocks in flight (hence memory use) is
+ *  bounded. Blocks are moved along, never copied, and their buffers are
+ *  recycled to the source. E.g.
+ *    DorisObsReader<> reader("file.rnx");
+ *    ObservationTable<double> table;
+ *    Pipeline(next_source(reader))
+ *        .transform([](DataBlock &b) { return b.mheader.m_flag <= 1; }, 4)
+ *        .transform(segment_passes)
+ *        .sink(storage_sink(table))
+ *        .run();
+ *  A stage run by a single thread sees blocks in the order of the source
+ *  (whatever the number of threads of the stages before it), so it can
+ *  keep state across blocks (e.g. per beacon, for pass segmentation or
+ *  cycle slip detection); stages run by more threads see blocks in any
+ *  order and must be thread-safe. Blocks arriving early at such a stage
+ *  are kept aside until their turn; the source is held back so that at
+ *  most a queue's worth (plus one per thread feeding the queue) are.
+ */
+class Pipeline {
+ public:
+  /* Reads the next block; returns as DorisObsReader::next, i.e. 0 if ok,
+   * < 0 at the end, > 0 on error
+   */
+  using source_fn = std::function<int(DataBlock &)>;
+  /* Processes a block (in place); returns false to drop it */
+  using transform_fn = std::function<bool(DataBlock &)>;
+  /* Consumes a block */
+  using sink_fn = std::function<void(const DataBlock &)>;
+
+ private:
+  struct Stage {
+    transform_fn m_fn;
+    int m_threads;
+  };
+
+  source_fn m_source;
+  std::vector<Stage> m_stages;
+  std::size_t m_capacity;
+  /* statistics of the last run; the source first, then every stage */
+  std::vector<StageStats> m_stats;
+
+ public:
+  /** @brief Constructor.
+   *
+   *  @param[in] source Where blocks come from (see next_source)
+   *  @param[in] queue_capacity Capacity of the queues between stages (in
+   *             blocks; rounded up to a power of 2)
+   */
+  explicit Pipeline(source_fn source, std::size_t queue_capacity = 64);
+
+  /** @brief Add a stage, processing (and possibly dropping) blocks.
+   *  @param[in] threads Number of threads running the stage (> 0)
+   *  @throw std::runtime_error if the number of threads is not positive
+   */
+  Pipeline &transform(transform_fn fn, int threads = 1);
+
+  /* @brief Add a stage consuming blocks (passing them on unchanged) */
+  Pipeline &sink(sink_fn fn, int threads = 1);
+
+  /* @brief Number of stages (the source not counted) */
+  std::size_t num_stages() const noexcept { return m_stages.size(); }
+
+  /** @brief Read all blocks off the source and through the stages; returns
+   *         once all are processed. Can be called again (e.g. with a
+   *         rewound source).
+   *  @throw The first exception thrown by a stage, or std::runtime_error if
+   *         the source fails; all threads are stopped then.
+   */
+  void run();
+
+  /* @brief Statistics of the last run: the source first, then every stage */
+  const std::vector<StageStats> &stats() const noexcept { return m_stats; }
+}; /* class Pipeline */
+
+/** @brief A pipeline source, off anything with a next(DataBlock &) member
+ *         function (e.g. a DorisObsReader, a DorisRinexCursor or an
+ *         ArchiveReader), which must outlive the pipeline.
+ */
+template <typename Source> Pipeline::source_fn next_source(Source &s) {
+  return [&s](DataBlock &block) { return s.next(block); };
+}
+
+/** @brief Append a data block to a storage (see StorageTraits), as if read
+ *         into it; values are converted to the value type of the storage.
+ */
+template <typename Storage, typename U>
+void store_block(Storage &s, const BasicDataBlock<U> &block) {
+  using Traits = StorageTraits<Storage>;
+  using T = typename Traits::value_type;
+  static_assert(std::is_arithmetic_v<T>,
+                "Blocks can only be stored as arithmetic values");
+  const int num_beacons = block.mbeacon_obs.size();
+  const int num_obs =
+      num_beacons ? (int)block.mbeacon_obs[0].m_values.size() : 0;
+  Traits::begin_block(s, block.mheader, block.mcolumns, num_beacons, num_obs);
+  for (int b = 0; b < num_beacons; b++) {
+    const auto &bobs = block.mbeacon_obs[b];
+    Traits::begin_beacon(s, b, bobs.id());
+    for (int k = 0; k < num_obs; k++) {
+      const auto &v = bobs.m_values[k];
+      Traits::value(s, b, k, static_cast<T>(v.m_value), v.m_flag1, v.m_flag2);
+    }
+  }
+  Traits::end_block(s);
+}
+
+/** @brief A pipeline sink, appending blocks to a storage (e.g. an
+ *         ObservationTable); run it by a single thread.
+ */
+template <typename Storage> Pipeline::sink_fn storage_sink(Storage &s) {
+  return [&s](const DataBlock &block) { store_block(s, block); };
+}
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
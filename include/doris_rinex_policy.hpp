@@ -0,0 +1,616 @@
+#ifndef __DSO_DORIS_RINEX_POLICY_HPP__
+#define __DSO_DORIS_RINEX_POLICY_HPP__
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "doris_rinex.hpp"
+#include "doris_rinex_diagnostics.hpp"
+#include "doris_rinex_kernels.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* -------------------------------------------------------------------------
+ * Validation policies
+ * ------------------------------------------------------------------------- */
+
+/** Full checks (the default); every data line is validated (beacon lines
+ *  must start with 'D', values must be numbers, blocks must be complete),
+ *  errors are reported (see doris_rinex_diagnostics.hpp) and lenient mode
+ *  is honoured. For files of unknown origin.
+ */
+struct Checked {
+  static constexpr bool checks = true;
+};
+
+/** Trusted input (e.g. files already validated, as when reprocessing an
+ *  archive); data lines are taken to be well-formed and no errors are
+ *  reported. Only the record lines and the end of the stream are checked;
+ *  malformed data lines give meaningless values (but are read safely).
+ */
+struct Trusted {
+  static constexpr bool checks = false;
+};
+
+/* -------------------------------------------------------------------------
+ * Value types
+ * ------------------------------------------------------------------------- */
+
+/** A fixed-point observation value, in units of 1e-3 of the value recorded
+ *  in the RINEX file. Observation fields are F14.3, hence values are stored
+ *  exactly. Note that the scale factor of the observable (if any) is not
+ *  applied; use to_double() to get the actual value.
+ */
+struct FixedPoint {
+  std::int64_t m_value;
+
+  /* @brief The actual value, given the scale factor of the observable */
+  double to_double(double scale_factor = 1e0) const noexcept {
+    return m_value / (1e3 * scale_factor);
+  }
+
+  bool operator==(const FixedPoint &other) const noexcept {
+    return m_value == other.m_value;
+  }
+  bool operator!=(const FixedPoint &other) const noexcept {
+    return m_value != other.m_value;
+  }
+}; /* struct FixedPoint */
+
+/** How values of type T are parsed off an (non-blank) observation field and
+ *  scaled. Specialized for double, float and FixedPoint.
+ */
+template <typename T> struct ValueTraits;
+
+template <> struct ValueTraits<double> {
+  /* value of missing observations (see OBSERVATION_VALUE_MISSING) */
+  static constexpr double missing() noexcept {
+    return OBSERVATION_VALUE_MISSING;
+  }
+  /* parse the field [begin, end); false on error (v is left as is) */
+  static bool parse(const char *begin, const char *end, double &v) noexcept {
+    return std::from_chars(begin, end, v).ec == std::errc{};
+  }
+  /* the value of a F14.3 field, off its mantissa (see
+   * kernels::decode_fields); false if that is not exact (then parse it)
+   */
+  static bool from_mantissa(std::int64_t m, double &v) noexcept {
+    v = m / 1e3;
+    return true;
+  }
+  /* apply the scale factor of the observable */
+  static double scale(double v, double factor) noexcept { return v / factor; }
+};
+
+template <> struct ValueTraits<float> {
+  static constexpr float missing() noexcept {
+    return std::numeric_limits<float>::min();
+  }
+  static bool parse(const char *begin, const char *end, float &v) noexcept {
+    return std::from_chars(begin, end, v).ec == std::errc{};
+  }
+  /* correctly rounded as long as the mantissa is a float */
+  static bool from_mantissa(std::int64_t m, float &v) noexcept {
+    if (m > (1 << 24) || m < -(1 << 24)) return false;
+    v = static_cast<float>(m) / 1e3f;
+    return true;
+  }
+  static float scale(float v, double factor) noexcept {
+    return v / static_cast<float>(factor);
+  }
+};
+
+template <> struct ValueTraits<FixedPoint> {
+  static constexpr FixedPoint missing() noexcept {
+    return FixedPoint{std::numeric_limits<std::int64_t>::min()};
+  }
+  /* [sign]digits[.digits], at most 3 decimals */
+  static bool parse(const char *begin, const char *end,
+                    FixedPoint &v) noexcept {
+    bool negative = false;
+    if (begin < end && (*begin == '-' || *begin == '+'))
+      negative = (*begin++ == '-');
+    std::int64_t x = 0;
+    int digits = 0, decimals = -1;
+    for (; begin < end; ++begin) {
+      if (*begin == '.' && decimals < 0) {
+        decimals = 0;
+      } else if (*begin >= '0' && *begin <= '9' && decimals < 3) {
+        x = x * 10 + (*begin - '0');
+        ++digits;
+        if (decimals >= 0) ++decimals;
+      } else {
+        return false;
+      }
+    }
+    if (!digits) return false;
+    for (decimals = std::max(decimals, 0); decimals < 3; ++decimals) x *= 10;
+    v.m_value = negative ? -x : x;
+    return true;
+  }
+  static bool from_mantissa(std::int64_t m, FixedPoint &v) noexcept {
+    v.m_value = m;
+    return true;
+  }
+  static FixedPoint scale(FixedPoint v, double) noexcept { return v; }
+};
+
+/* -------------------------------------------------------------------------
+ * Storage
+ * ------------------------------------------------------------------------- */
+
+/** @struct ObservationMatrix
+ *  @brief A data block stored as structure-of-arrays: the values of the
+ *         block form a (row-major) beacons x observables matrix, and so do
+ *         the m1 and m2 flags.
+ *
+ *  Storage is reused from block to block, so reading into the same
+ *  instance allocates only while blocks grow.
+ */
+template <typename T> struct ObservationMatrix {
+  /* the block header */
+  RinexDataRecordHeader mheader;
+  /* number of observables (i.e. columns) */
+  int m_num_obs{0};
+  /* beacon ids, 4 (null-terminated) chars per beacon */
+  std::vector<char> m_beacon_ids;
+  /* values, flags m1 and m2; num_beacons() x m_num_obs, row-major */
+  std::vector<T> m_values;
+  std::vector<char> m_flags1;
+  std::vector<char> m_flags2;
+  /* columns of the observables, as in the file header */
+  ObservationColumns m_columns;
+
+  int num_beacons() const noexcept { return m_beacon_ids.size() / 4; }
+  int num_obs() const noexcept { return m_num_obs; }
+  const char *beacon_id(int beacon) const noexcept {
+    return m_beacon_ids.data() + 4 * beacon;
+  }
+  T value(int beacon, int obs) const noexcept {
+    return m_values[beacon * m_num_obs + obs];
+  }
+  /* @brief Column of an observable, -1 if not recorded */
+  int column(DorisObservationCode code) const noexcept {
+    return m_columns(code);
+  }
+  /* @brief Value of an observable; nullptr if not recorded */
+  const T *value(int beacon, DorisObservationCode code) const noexcept {
+    const int k = m_columns(code);
+    return (k < 0) ? nullptr : m_values.data() + beacon * m_num_obs + k;
+  }
+  char flag1(int beacon, int obs) const noexcept {
+    return m_flags1[beacon * m_num_obs + obs];
+  }
+  char flag2(int beacon, int obs) const noexcept {
+    return m_flags2[beacon * m_num_obs + obs];
+  }
+}; /* struct ObservationMatrix */
+
+/** @struct ObservationTable
+ *  @brief All data blocks of a file (appended block by block), stored by
+ *         observable: the values of every observable form a contiguous
+ *         column, with one row per (epoch, beacon) observation record.
+ *
+ *  Rows of a block are only kept once the whole block is read; i.e. a block
+ *  that failed is dropped when the next one is read. A table holds blocks of
+ *  a single file (call clear() to reuse it).
+ */
+template <typename T> struct ObservationTable {
+  /* the block headers, in the order read */
+  std::vector<RinexDataRecordHeader> m_epochs;
+  /* number of observables (i.e. columns) */
+  int m_num_obs{0};
+  /* columns of the observables, as in the file header */
+  ObservationColumns m_columns;
+  /* per row: index of the epoch (in m_epochs) and beacon id (4 chars) */
+  std::vector<int> m_epoch_index;
+  std::vector<char> m_beacon_ids;
+  /* per observable: values, flags m1 and m2 (one per row) */
+  std::vector<std::vector<T>> m_values;
+  std::vector<std::vector<char>> m_flags1;
+  std::vector<std::vector<char>> m_flags2;
+  /* rows and epochs of the blocks read in full */
+  std::size_t m_num_rows{0};
+  std::size_t m_num_epochs{0};
+
+  std::size_t num_rows() const noexcept { return m_num_rows; }
+  std::size_t num_epochs() const noexcept { return m_num_epochs; }
+  int num_obs() const noexcept { return m_num_obs; }
+  const RinexDataRecordHeader &epoch(std::size_t row) const noexcept {
+    return m_epochs[m_epoch_index[row]];
+  }
+  const char *beacon_id(std::size_t row) const noexcept {
+    return m_beacon_ids.data() + 4 * row;
+  }
+  /* @brief Column of an observable, -1 if not recorded */
+  int column(DorisObservationCode code) const noexcept {
+    return m_columns(code);
+  }
+  /* @brief All values of an observable (num_rows() of them) */
+  const T *values(int obs) const noexcept { return m_values[obs].data(); }
+  T value(std::size_t row, int obs) const noexcept {
+    return m_values[obs][row];
+  }
+  char flag1(std::size_t row, int obs) const noexcept {
+    return m_flags1[obs][row];
+  }
+  char flag2(std::size_t row, int obs) const noexcept {
+    return m_flags2[obs][row];
+  }
+
+  /* @brief Drop all blocks */
+  void clear() noexcept {
+    m_num_rows = m_num_epochs = 0;
+    truncate();
+  }
+
+  /* drop rows and epochs past the ones read in full */
+  void truncate() noexcept {
+    m_epochs.resize(m_num_epochs);
+    m_epoch_index.resize(m_num_rows);
+    m_beacon_ids.resize(4 * m_num_rows);
+    for (int k = 0; k < m_num_obs; k++) {
+      m_values[k].resize(m_num_rows);
+      m_flags1[k].resize(m_num_rows);
+      m_flags2[k].resize(m_num_rows);
+    }
+  }
+}; /* struct ObservationTable */
+
+/** @struct CallbackStorage
+ *  @brief Storage handing each observation to a callback, as it is parsed
+ *         (nothing is stored). The callback is called as:
+ *         f(const RinexDataRecordHeader &, const char *beacon_id, int obs,
+ *           const BasicObservationValue<T> &)
+ *         Blocks without observations (i.e. special events) are not seen.
+ */
+template <typename T, typename F> struct CallbackStorage {
+  F m_callback;
+  const RinexDataRecordHeader *m_header{nullptr};
+  char m_beacon_id[4] = {'\0'};
+}; /* struct CallbackStorage */
+
+/* @brief Create a CallbackStorage, for values of type T */
+template <typename T, typename F>
+CallbackStorage<T, std::decay_t<F>> callback_storage(F &&f) {
+  return CallbackStorage<T, std::decay_t<F>>{std::forward<F>(f)};
+}
+
+/** How data blocks are stored; specialized for BasicDataBlock<T> (array of
+ *  structs), ObservationMatrix<T> (struct of arrays), ObservationTable<T>
+ *  (whole file, by observable) and CallbackStorage.
+ *  Specialize it to read into other types. The parser calls, in order:
+ *    begin_block(storage, header, columns, num_beacons, num_obs)
+ *    and, for every beacon: begin_beacon(storage, beacon, id)
+ *      and, for every observable: value(storage, beacon, obs, v, m1, m2)
+ *    end_block(storage), once the block is read in full
+ */
+template <typename S> struct StorageTraits;
+
+template <typename T> struct StorageTraits<BasicDataBlock<T>> {
+  using value_type = T;
+  static void begin_block(BasicDataBlock<T> &s, const RinexDataRecordHeader &h,
+                          const ObservationColumns &c, int num_beacons,
+                          int) noexcept {
+    s.mheader = h;
+    s.mcolumns = c;
+    s.mbeacon_obs.clear();
+    s.mbeacon_obs.reserve(num_beacons);
+  }
+  static void begin_beacon(BasicDataBlock<T> &s, int,
+                           const char *id) noexcept {
+    s.mbeacon_obs.emplace_back();
+    std::memcpy(s.mbeacon_obs.back().m_beacon_id, id, 3);
+  }
+  static void value(BasicDataBlock<T> &s, int, int, T v, char f1,
+                    char f2) noexcept {
+    s.mbeacon_obs.back().m_values.emplace_back(v, f1, f2);
+  }
+  static void end_block(BasicDataBlock<T> &) noexcept {}
+};
+
+template <typename T> struct StorageTraits<ObservationMatrix<T>> {
+  using value_type = T;
+  static void begin_block(ObservationMatrix<T> &s,
+                          const RinexDataRecordHeader &h,
+                          const ObservationColumns &c, int num_beacons,
+                          int num_obs) noexcept {
+    s.mheader = h;
+    s.m_columns = c;
+    s.m_num_obs = num_obs;
+    s.m_beacon_ids.assign(4 * num_beacons, '\0');
+    s.m_values.resize(num_beacons * num_obs);
+    s.m_flags1.resize(num_beacons * num_obs);
+    s.m_flags2.resize(num_beacons * num_obs);
+  }
+  static void begin_beacon(ObservationMatrix<T> &s, int beacon,
+                           const char *id) noexcept {
+    std::memcpy(s.m_beacon_ids.data() + 4 * beacon, id, 3);
+  }
+  static void value(ObservationMatrix<T> &s, int beacon, int obs, T v,
+                    char f1, char f2) noexcept {
+    const int i = beacon * s.m_num_obs + obs;
+    s.m_values[i] = v;
+    s.m_flags1[i] = f1;
+    s.m_flags2[i] = f2;
+  }
+  static void end_block(ObservationMatrix<T> &) noexcept {}
+};
+
+template <typename T> struct StorageTraits<ObservationTable<T>> {
+  using value_type = T;
+  static void begin_block(ObservationTable<T> &s,
+                          const RinexDataRecordHeader &h,
+                          const ObservationColumns &c, int num_beacons,
+                          int num_obs) {
+    if (s.m_num_obs != num_obs) {
+      s.m_num_obs = num_obs;
+      s.m_values.resize(num_obs);
+      s.m_flags1.resize(num_obs);
+      s.m_flags2.resize(num_obs);
+    }
+    s.m_columns = c;
+    /* drop what is left of a block that failed */
+    s.truncate();
+    const std::size_t rows = s.m_num_rows + num_beacons;
+    s.m_epochs.push_back(h);
+    s.m_epoch_index.resize(rows, s.m_num_epochs);
+    s.m_beacon_ids.resize(4 * rows, '\0');
+    for (int k = 0; k < num_obs; k++) {
+      s.m_values[k].resize(rows);
+      s.m_flags1[k].resize(rows);
+      s.m_flags2[k].resize(rows);
+    }
+  }
+  static void begin_beacon(ObservationTable<T> &s, int beacon,
+                           const char *id) noexcept {
+    std::memcpy(s.m_beacon_ids.data() + 4 * (s.m_num_rows + beacon), id, 3);
+  }
+  static void value(ObservationTable<T> &s, int beacon, int obs, T v,
+                    char f1, char f2) noexcept {
+    const std::size_t row = s.m_num_rows + beacon;
+    s.m_values[obs][row] = v;
+    s.m_flags1[obs][row] = f1;
+    s.m_flags2[obs][row] = f2;
+  }
+  static void end_block(ObservationTable<T> &s) noexcept {
+    s.m_num_rows = s.m_epoch_index.size();
+    s.m_num_epochs = s.m_epochs.size();
+  }
+};
+
+template <typename T, typename F> struct StorageTraits<CallbackStorage<T, F>> {
+  using value_type = T;
+  static void begin_block(CallbackStorage<T, F> &s,
+                          const RinexDataRecordHeader &h,
+                          const ObservationColumns &, int, int) noexcept {
+    s.m_header = &h;
+  }
+  static void begin_beacon(CallbackStorage<T, F> &s, int,
+                           const char *id) noexcept {
+    std::memcpy(s.m_beacon_id, id, 3);
+  }
+  static void value(CallbackStorage<T, F> &s, int, int obs, T v, char f1,
+                    char f2) {
+    s.m_callback(*s.m_header, s.m_beacon_id, obs,
+                 BasicObservationValue<T>(v, f1, f2));
+  }
+  static void end_block(CallbackStorage<T, F> &) noexcept {}
+};
+
+/* -------------------------------------------------------------------------
+ * Parsing
+ * ------------------------------------------------------------------------- */
+
+/** @brief Read the record line of the next data block off is and resolve it
+ *         into hdr. Special events without an epoch (and the special
+ *         records following any special event) are skipped.
+ *
+ *  @return An int denoting:
+ *    < 0 : EOF encountered
+ *    = 0 : All ok; if hdr.m_flag > 1, the block is a special event without
+ *          observations
+ *    > 0 : Error (reported)
+ */
+int read_record_line(std::istream &is, RinexDataRecordHeader &hdr) noexcept;
+
+/** @brief Report an error found in a data line (just read off is, consumed
+ *  characters including the newline); see doris_rinex_diagnostics.hpp.
+ */
+void report_data_error(int code, const char *line, std::istream &is,
+                       std::streamsize consumed) noexcept;
+
+/** @brief Read the next data block off is and store it in storage, using
+ *         the given validation policy (Checked or Trusted). The value type is
+ *         the one of the storage.
+ *
+ *  The stream should be placed at the start of a data block, as for
+ *  DorisObsRinex iteration; the header is only used to resolve the
+ *  observables and their scale factors.
+ *
+ *  @return An int denoting:
+ *    < 0 : EOF encountered; storage is invalid
+ *    = 0 : All ok, data collected and stored
+ *    > 0 : Error, failed to collect next block; storage is invalid
+ */
+template <typename Validation, typename Storage>
+int read_block(std::istream &is, const DorisRinexHeader &hdr,
+               Storage &storage) {
+  using Traits = StorageTraits<Storage>;
+  using T = typename Traits::value_type;
+  using Values = ValueTraits<T>;
+  constexpr bool checks = Validation::checks;
+  constexpr int MAX_RECORD_CHARS = DorisObsRinex::MAX_RECORD_CHARS;
+  /* an observation field is F14.3 followed by the m1 and m2 flags */
+  constexpr int FIELD_CHARS = kernels::FIELD_CHARS;
+  /* characters of a full data line (beacon id or blanks, then fields) */
+  constexpr int LINE_CHARS = 3 + MAX_OBS_PER_DATA_LINE * FIELD_CHARS;
+  static_assert(LINE_CHARS < MAX_RECORD_CHARS);
+
+  RinexDataRecordHeader rec;
+  if (const int status = read_record_line(is, rec)) return status;
+
+  const int num_obs = hdr.obs_codes().size();
+  const auto *scale = hdr.obs_scale_factors().data();
+  const int num_beacons = (rec.m_flag > 1) ? 0 : rec.m_num_stations;
+  Traits::begin_block(storage, rec, hdr.obs_columns(), num_beacons, num_obs);
+
+  char line[MAX_RECORD_CHARS];
+  std::int64_t mantissa[MAX_OBS_PER_DATA_LINE];
+  std::uint8_t status[MAX_OBS_PER_DATA_LINE];
+  for (int beacon = 0; beacon < num_beacons; beacon++) {
+    /* one data line per (up to) MAX_OBS_PER_DATA_LINE observables; a
+     * beacon starts on a new line
+     */
+    for (int k0 = 0; k0 < num_obs; k0 += MAX_OBS_PER_DATA_LINE) {
+      if (!is.getline(line, MAX_RECORD_CHARS) && !is.gcount()) {
+        if constexpr (checks)
+          report_data_error(diag::DATA_BLOCK_TRUNCATED, nullptr, is, 0);
+        return 1;
+      }
+      if constexpr (checks) {
+        /* a record line, before all lines of the beacon were read */
+        if (k0 && *line == '>') {
+          report_data_error(diag::DATA_BLOCK_TRUNCATED, line, is,
+                            is.gcount());
+          return 1;
+        }
+        if (!k0 && *line != 'D') {
+          report_data_error(diag::DATA_EXPECTED_BEACON, line, is,
+                            is.gcount());
+          return 1;
+        }
+      }
+      if (!k0) Traits::begin_beacon(storage, beacon, line);
+
+      /* characters past the end of the line are blank; decode all fields
+       * of the line at once
+       */
+      const int len = std::strlen(line);
+      if (len < LINE_CHARS) {
+        std::memset(line + len, ' ', LINE_CHARS - len);
+        line[LINE_CHARS] = '\0';
+      }
+      const int n = std::min(num_obs - k0, MAX_OBS_PER_DATA_LINE);
+      kernels::decode_fields(line + 3, n, mantissa, status);
+
+      for (int col = 0; col < n; col++) {
+        const int k = k0 + col;
+        const char *field = line + 3 + col * FIELD_CHARS;
+
+        /* a value left blank is missing */
+        T v = Values::missing();
+        const bool decoded = status[col] == kernels::FIELD_BLANK ||
+                             (status[col] == kernels::FIELD_VALUE &&
+                              Values::from_mantissa(mantissa[col], v));
+        if (!decoded) {
+          const char *begin = field;
+          const char *end = field + FIELD_CHARS - 2;
+          while (begin < end && *begin == ' ') ++begin;
+          if constexpr (checks) {
+            if (!Values::parse(begin, end, v)) {
+              report_data_error(diag::DATA_OBSERVATION_VALUE, line, is,
+                                is.gcount());
+              return 2;
+            }
+          } else {
+            Values::parse(begin, end, v);
+          }
+        }
+
+        /* scale factors are in one-to-one correspondance with the
+         * observables (1 if the observable has none)
+         */
+        Traits::value(storage, beacon, k, Values::scale(v, scale[k]),
+                      field[FIELD_CHARS - 2], field[FIELD_CHARS - 1]);
+      }
+    }
+  }
+
+  Traits::end_block(storage);
+  return 0;
+}
+
+} /* namespace doris_rnx */
+
+/** @class DorisObsReader
+ *  @brief A reader of DORIS RINEX data blocks, parameterised by policies:
+ *    - the validation policy (doris_rnx::Checked or doris_rnx::Trusted) is
+ *      a template parameter of the reader,
+ *    - the storage policy is the type of the storage passed to next(), i.e.
+ *      a doris_rnx::BasicDataBlock<T> (array of structs), an
+ *      doris_rnx::ObservationMatrix<T> (struct of arrays), a
+ *      doris_rnx::ObservationTable<T> (all blocks of the file, by
+ *      observable), a doris_rnx::CallbackStorage, or any type
+ *      doris_rnx::StorageTraits is specialized for,
+ *    - the value type T of the storage is double, float or
+ *      doris_rnx::FixedPoint.
+ *
+ *  All choices are made at compile time; e.g. with Trusted, no data line
+ *  checks and no error bookkeeping are compiled in.
+ *
+ *  Compact RINEX files are not supported (an std::runtime_error is thrown
+ *  at construction); read them via DorisObsRinex.
+ */
+template <typename Validation> class DorisObsReader {
+  DorisObsRinex m_rnx;
+
+ public:
+  /* @brief Constructor from filename (see DorisObsRinex) */
+  explicit DorisObsReader(const char *fn) : DorisObsReader(DorisObsRinex(fn)) {}
+
+  /* @brief Constructor off a DorisObsRinex instance (e.g. over a source) */
+  explicit DorisObsReader(DorisObsRinex &&rnx) : m_rnx(std::move(rnx)) {
+    if (m_rnx.header().is_compact())
+      throw std::runtime_error(
+          "[ERROR] Policy reader not available for compact RINEX files\n");
+    m_rnx.goto_data_block();
+  }
+
+  /* @brief The (immutable) header of the RINEX file */
+  const DorisRinexHeader &header() const noexcept { return m_rnx.header(); }
+
+  /* @brief The underlying instance (e.g. to switch lenient mode on) */
+  DorisObsRinex &rinex() noexcept { return m_rnx; }
+
+  /* @brief Go (back) to the first data block */
+  void rewind() noexcept { m_rnx.goto_data_block(); }
+
+  /** @brief Read the next data block into storage.
+   *
+   *  @return An int denoting:
+   *    < 0 : EOF encountered; storage is invalid
+   *    = 0 : All ok, data collected and stored
+   *    > 0 : Error, failed to collect next block; storage is invalid
+   */
+  template <typename Storage> int next(Storage &storage) {
+    auto &is = m_rnx.m_stream;
+    const auto &hdr = *m_rnx.m_header;
+    if constexpr (Validation::checks) {
+      /* lenient: on error, skip to the next record line and try again */
+      while (m_rnx.m_lenient) {
+        const auto start = is.tellg();
+        const int status = doris_rnx::read_block<Validation>(is, hdr, storage);
+        if (status == 0) return 0;
+        if (status < 0 || m_rnx.resynchronise(start, status))
+          return m_rnx.end_of_data();
+      }
+    }
+    const int status = doris_rnx::read_block<Validation>(is, hdr, storage);
+    return (status < 0) ? m_rnx.end_of_data() : status;
+  }
+}; /* class DorisObsReader */
+
+} /* namespace dso */
+
+#endif
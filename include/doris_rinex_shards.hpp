@@ -0,0 +1,153 @@
+#ifndef __DSO_DORIS_RINEX_SHARDS_HPP__
+#define __DSO_DORIS_RINEX_SHARDS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "doris_rinex_pipeline.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class BeaconIndex
+ *  @brief Interned beacons: a dense index (0, 1, ...) per beacon id, so that
+ *         per-beacon state can be kept in plain vectors.
+ *
+ *  Beacons listed in the header come first, in the order of the header;
+ *  beacons met in data blocks but not in the header are appended as they
+ *  are interned.
+ */
+class BeaconIndex {
+  std::unordered_map<std::uint32_t, int> m_index;
+  /* ids, 4 chars (null-terminated) per beacon */
+  std::vector<char> m_ids;
+
+  static std::uint32_t key(const char *id) noexcept {
+    return (std::uint32_t)(unsigned char)id[0] |
+           (std::uint32_t)(unsigned char)id[1] << 8 |
+           (std::uint32_t)(unsigned char)id[2] << 16;
+  }
+
+ public:
+  explicit BeaconIndex(const DorisRinexHeader &hdr);
+
+  /* @brief Number of beacons interned */
+  int size() const noexcept { return m_ids.size() / 4; }
+
+  /* @brief Index of a beacon (by its 3-char id); -1 if not interned */
+  int find(const char *id) const noexcept {
+    const auto it = m_index.find(key(id));
+    return (it == m_index.end()) ? -1 : it->second;
+  }
+
+  /* @brief Index of a beacon (by its 3-char id), interning it if new */
+  int intern(const char *id);
+
+  /* @brief The (3-char) id of a beacon */
+  const char *id(int index) const noexcept { return m_ids.data() + 4 * index; }
+}; /* class BeaconIndex */
+
+/* The observations of a beacon at an epoch, as handed to a shard */
+struct BeaconRecord {
+  /* the beacon (see BeaconIndex) */
+  int m_beacon;
+  /* beacons interned when the block was dispatched (> m_beacon), i.e. the
+   * size per-beacon state needs for this record
+   */
+  int m_num_beacons;
+  /* the header of the block (epoch, clock offset, ...) */
+  const RinexDataRecordHeader *m_header;
+  /* the observations (id and values) */
+  const BeaconObservations *m_obs;
+}; /* struct BeaconRecord */
+
+/** @class BeaconShards
+ *  @brief Per-beacon processing of data blocks, in parallel: the beacons of
+ *         every block are dispatched to a number of shards (worker threads),
+ *         each beacon always to the same shard.
+ *
+ *  Hence, a shard owns the state of its beacons (e.g. for cycle slip
+ *  detection, pass building or clock smoothing), with no locks needed, and
+ *  sees their records in the order of the source. Beacons are spread over
+ *  shards by index (see BeaconIndex): beacon i goes to shard i % N. Beacons
+ *  not in the header are interned as they are met, while shards run, so
+ *  indices up to (not including) r.m_num_beacons can come up; each shard
+ *  keeps (and grows) its own state, indexed by beacon; e.g.
+ *    std::vector<std::vector<State>> state(4);
+ *    BeaconShards shards(reader.header(), 4,
+ *        [&](int shard, const BeaconRecord &r) {
+ *          auto &s = state[shard];
+ *          if (r.m_beacon >= (int)s.size()) s.resize(r.m_num_beacons);
+ *          s[r.m_beacon].update(*r.m_header, *r.m_obs);
+ *        });
+ *    shards.run(next_source(reader));
+ *  Blocks are read on the calling thread and shared (not copied) among the
+ *  shards; a shard that falls behind holds back reading, once its queue
+ *  (of queue_capacity blocks) is full.
+ */
+class BeaconShards {
+ public:
+  /* Processes a record, on the thread of the given shard */
+  using handler = std::function<void(int shard, const BeaconRecord &)>;
+
+ private:
+  BeaconIndex m_beacons;
+  int m_num_shards;
+  handler m_handler;
+  std::size_t m_capacity;
+  /* records processed by every shard, in the last run */
+  std::vector<std::size_t> m_records;
+  /* true while run() is on (beacons are interned then) */
+  bool m_running{false};
+
+ public:
+  /** @brief Constructor.
+   *
+   *  @param[in] hdr The header of the file blocks will come from
+   *  @param[in] num_shards Number of shards (i.e. worker threads; > 0)
+   *  @param[in] h Handler called for every record
+   *  @param[in] queue_capacity Number of blocks a shard can lag behind
+   *  @throw std::runtime_error if the number of shards is not positive
+   */
+  BeaconShards(const DorisRinexHeader &hdr, int num_shards, handler h,
+               std::size_t queue_capacity = 64);
+
+  int num_shards() const noexcept { return m_num_shards; }
+
+  /* @brief Shard of a beacon (by index) */
+  int shard(int beacon) const noexcept { return beacon % m_num_shards; }
+
+  /** @brief The beacons interned (so far); handlers have the id of their
+   *         beacon in the record (i.e. r.m_obs->id()).
+   *  @throw std::runtime_error if called while run() is on (e.g. from a
+   *         handler), as beacons may be interned meanwhile
+   */
+  const BeaconIndex &beacons() const {
+    if (m_running)
+      throw std::runtime_error(
+          "[ERROR] Beacons cannot be queried while shards run\n");
+    return m_beacons;
+  }
+
+  /** @brief Read all blocks off the source and process their records;
+   *         returns once all are processed.
+   *  @throw The first exception thrown by a handler, or std::runtime_error
+   *         if the source fails; all shards are stopped then.
+   */
+  void run(const Pipeline::source_fn &source);
+
+  /* @brief Records processed by every shard, in the last run */
+  const std::vector<std::size_t> &records() const noexcept {
+    return m_records;
+  }
+}; /* class BeaconShards */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef __DSO_DORIS_RINEX_SOURCE_HPP__
+#define __DSO_DORIS_RINEX_SOURCE_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <streambuf>
+#include <vector>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Default size of the internal buffer of input sources (1MB) */
+static constexpr std::size_t DEFAULT_SOURCE_BUFFER_SIZE = 1024 * 1024;
+
+/** @class InputSource
+ *  @brief Base class for (buffered) input sources, feeding the RINEX header
+ *         and data block parsers.
+ *
+ *  Derived classes only need to implement read_chunk(), i.e. fill a buffer
+ *  with the next bytes of the source. Data is read in large chunks, into an
+ *  internal buffer, and lines are extracted from there.
+ *
+ *  The current position can always be queried (i.e. tellg works), as can
+ *  seeking within the current buffer. Seeking anywhere else is only possible
+ *  if the derived class implements reposition() (e.g. regular files); else
+ *  the source can only be read once, sequentially (e.g. pipes).
+ */
+class InputSource : public std::streambuf {
+  /* internal buffer */
+  std::vector<char> m_buffer;
+  /* offset (in the source) of the first byte in the buffer */
+  std::streamoff m_buffer_offset{0};
+
+ protected:
+  /** @brief Read (at most) n bytes off the source, into buf.
+   *  @return The number of bytes read; 0 signals EOF (or error).
+   */
+  virtual std::size_t read_chunk(char *buf, std::size_t n) = 0;
+
+  /** @brief Reposition the source so that the next read_chunk() starts at
+   *         (absolute) offset off.
+   *  @return true on success; the default implementation always fails (i.e.
+   *          the source is not seekable).
+   */
+  virtual bool reposition(std::streamoff) { return false; }
+
+  /* @brief Size of the source in bytes, or -1 if unknown */
+  virtual std::streamoff source_size() { return -1; }
+
+  int_type underflow() override;
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+
+ public:
+  explicit InputSource(std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE);
+  virtual ~InputSource() noexcept = default;
+
+  InputSource(const InputSource &) = delete;
+  InputSource &operator=(const InputSource &) = delete;
+
+  /** @brief True if reading failed (e.g. corrupt compressed data), i.e. the
+   *         EOF met is not the end of the data.
+   */
+  virtual bool error() const noexcept { return false; }
+}; /* class InputSource */
+
+/** @class FdSource
+ *  @brief Input source reading off a file descriptor, e.g. an open file, a
+ *         pipe or stdin (i.e. STDIN_FILENO).
+ *
+ *  If the descriptor refers to a regular file, the source is seekable.
+ */
+class FdSource : public InputSource {
+  int m_fd;
+  bool m_owns_fd;
+
+ protected:
+  std::size_t read_chunk(char *buf, std::size_t n) override;
+  bool reposition(std::streamoff off) override;
+  std::streamoff source_size() override;
+
+ public:
+  /** @param[in] fd The file descriptor to read from
+   *  @param[in] owns_fd If true, the descriptor is closed at destruction
+   *  @param[in] buffer_size Size of internal buffer
+   */
+  explicit FdSource(int fd, bool owns_fd = false,
+                    std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE);
+  ~FdSource() noexcept override;
+
+  bool is_open() const noexcept { return m_fd >= 0; }
+  int fd() const noexcept { return m_fd; }
+}; /* class FdSource */
+
+/** @class FileSource
+ *  @brief Input source reading off a (named) file; the file is opened at
+ *         construction (check is_open()) and closed at destruction.
+ */
+class FileSource : public FdSource {
+ public:
+  explicit FileSource(const char *fn,
+                      std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE);
+}; /* class FileSource */
+
+/** @class MemorySource
+ *  @brief A read-only, seekable input source over a (non-owned) memory
+ *         region; no copies are made, and the region is never written to.
+ *         The memory must outlive the source.
+ */
+class MemorySource : public std::streambuf {
+ public:
+  MemorySource(const char *data, std::size_t size) noexcept {
+    char *p = const_cast<char *>(data);
+    setg(p, p, p + size);
+  }
+
+ protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+}; /* class MemorySource */
+
+/** @class ReaderSource
+ *  @brief Input source pulling data from a user-supplied chunk reader.
+ *
+ *  The reader is called as reader(buf, n) and should copy at most n bytes to
+ *  buf, returning the number of bytes copied (0 signals EOF). This source is
+ *  not seekable.
+ */
+class ReaderSource : public InputSource {
+ public:
+  using reader_type = std::function<std::size_t(char *, std::size_t)>;
+
+ private:
+  reader_type m_reader;
+
+ protected:
+  std::size_t read_chunk(char *buf, std::size_t n) override {
+    return m_reader(buf, n);
+  }
+
+ public:
+  explicit ReaderSource(reader_type reader,
+                        std::size_t buffer_size = DEFAULT_SOURCE_BUFFER_SIZE)
+      : InputSource(buffer_size), m_reader(std::move(reader)) {}
+}; /* class ReaderSource */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
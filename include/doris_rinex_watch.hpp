@@ -0,0 +1,115 @@
+#ifndef __DSO_DORIS_RINEX_WATCH_HPP__
+#define __DSO_DORIS_RINEX_WATCH_HPP__
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "doris_rinex.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Options for watching directories for incoming RINEX files */
+struct WatchOptions {
+  /* number of worker (parsing) threads; 0 means one per hardware thread */
+  int m_num_threads{0};
+  /* max number of files waiting to be processed */
+  int m_max_pending{64};
+  /* only files ending with one of these are processed; a trailing .Z or .gz
+   * is ignored when matching (e.g. "cs2rx20001.001.Z" matches ".001")
+   */
+  std::vector<std::string> m_suffixes{".001", ".rnx"};
+  /* also process matching files already in the directories at
+   * construction
+   */
+  bool m_scan_existing{false};
+}; /* struct WatchOptions */
+
+/** @brief Handler called for every incoming file, on a worker thread; files
+ *         with no valid header are counted as failed and not handed over.
+ *
+ *  The DorisObsRinex instance reads off the file at path and is only valid
+ *  during the call. Handlers run concurrently, hence they should be
+ *  thread-safe. An exception thrown by the handler marks the file as failed.
+ */
+using watch_handler =
+    std::function<void(const std::string &path, DorisObsRinex &)>;
+
+/** @class DirectoryWatcher
+ *  @brief Watch directories (via inotify) for incoming RINEX files, and
+ *         process each one on a pool of worker threads.
+ *
+ *  A file is picked up when it is closed after writing, or when it is
+ *  moved (renamed) into a watched directory; hence, writers should either
+ *  write the file in place, or (better) write it elsewhere and move it in.
+ *  Incoming files wait in a bounded queue; when it is full, events are
+ *  left in the (kernel) inotify queue until workers catch up.
+ *
+ *  Directories are watched from construction on, so files arriving before
+ *  run() is called are not missed. A file written while the watcher is
+ *  being constructed may be processed twice (if m_scan_existing is set).
+ */
+class DirectoryWatcher {
+  std::vector<std::string> m_dirs;
+  watch_handler m_handler;
+  WatchOptions m_opts;
+  /* inotify instance */
+  int m_inotify{-1};
+  /* eventfd used by stop() to wake up run() */
+  int m_wake{-1};
+  /* watch descriptor to index in m_dirs */
+  std::map<int, std::size_t> m_watches;
+  /* matching files found at construction (if m_scan_existing) */
+  std::vector<std::string> m_existing;
+  std::atomic<bool> m_stopped{false};
+  std::atomic<long> m_processed{0};
+  std::atomic<long> m_failed{0};
+
+  /* @brief True if name ends with one of the m_suffixes */
+  bool matches(const char *name) const noexcept;
+
+ public:
+  /** @brief Constructor; starts watching the directories.
+   *  @throw std::runtime_error if inotify is not available or a directory
+   *         cannot be watched.
+   */
+  DirectoryWatcher(const std::vector<std::string> &dirs,
+                   watch_handler handler,
+                   const WatchOptions &opts = WatchOptions{});
+
+  /* @brief Destructor */
+  ~DirectoryWatcher() noexcept;
+
+  /* @brief Copy not allowed ! */
+  DirectoryWatcher(const DirectoryWatcher &) = delete;
+
+  /* @brief Assignment not allowed ! */
+  DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+  /** @brief Process incoming files, until stop() is called. Files already
+   *  queued when stopped are processed before returning.
+   *
+   *  @return The number of files that failed (during this call)
+   */
+  int run();
+
+  /** @brief Make run() return. Thread-safe and async-signal-safe (i.e. can
+   *  be called from a signal handler).
+   */
+  void stop() noexcept;
+
+  /* @brief Number of files processed so far (including failed ones) */
+  long files_processed() const noexcept { return m_processed; }
+
+  /* @brief Number of files failed so far */
+  long files_failed() const noexcept { return m_failed; }
+}; /* class DirectoryWatcher */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
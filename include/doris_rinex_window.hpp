@@ -0,0 +1,184 @@
+#ifndef __DSO_DORIS_RINEX_WINDOW_HPP__
+#define __DSO_DORIS_RINEX_WINDOW_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "doris_rinex_policy.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class ObservationWindow
+ *  @brief The data blocks of a sliding time window, i.e. the latest blocks
+ *         spanning at most a given time interval (and at most a given
+ *         number of blocks), e.g. for range-rates, smoothing or cycle slip
+ *         detection.
+ *
+ *  Blocks are kept in a ring of ObservationMatrix slots, allocated at
+ *  construction and reused; once the window is full, feeding it allocates
+ *  nothing (as long as blocks have no more beacons than the slots were
+ *  sized for). It is fed either block by block off an iterator (push), or
+ *  read into directly, as a storage:
+ *    ObservationWindow<> w(reader.header(), 30e0, 16);
+ *    while (!reader.next(w)) {
+ *      const double *prev = w.value(1, w.block(0).beacon_id(0), k);
+ *      ...
+ *    }
+ *  Blocks are given by age: 0 is the latest block, size() - 1 the oldest.
+ *  Special events (i.e. blocks without observations) are not kept.
+ */
+template <typename T = double> class ObservationWindow {
+  /* slots; one more than the capacity, so that the oldest block is only
+   * dropped once a new one is read in full
+   */
+  std::vector<ObservationMatrix<T>> m_slots;
+  /* epoch of the block in every slot, in nanoseconds since MJD 0 */
+  std::vector<std::int64_t> m_epochs;
+  /* time span of the window, in nanoseconds */
+  std::int64_t m_span;
+  /* slot of the oldest block, and number of blocks */
+  std::size_t m_first{0};
+  std::size_t m_size{0};
+
+  friend struct StorageTraits<ObservationWindow>;
+
+  std::size_t slot(std::size_t age) const noexcept {
+    return (m_first + m_size - 1 - age) % m_slots.size();
+  }
+
+  /* the slot the next block is read into */
+  ObservationMatrix<T> &next_slot() noexcept {
+    return m_slots[(m_first + m_size) % m_slots.size()];
+  }
+
+  /* keep the block just read into the next slot, and drop old ones */
+  void commit() noexcept {
+    const std::size_t s = (m_first + m_size) % m_slots.size();
+    if (m_slots[s].mheader.m_flag > 1) return;
+    m_epochs[s] = epoch_to_ns(m_slots[s].mheader.m_epoch);
+    if (++m_size == m_slots.size()) {
+      m_first = (m_first + 1) % m_slots.size();
+      --m_size;
+    }
+    while (m_size > 1 && m_epochs[s] - m_epochs[m_first] > m_span) {
+      m_first = (m_first + 1) % m_slots.size();
+      --m_size;
+    }
+  }
+
+ public:
+  /** @brief Constructor.
+   *
+   *  @param[in] hdr The header of the file blocks will come from
+   *  @param[in] span_sec Time span of the window, in seconds: blocks older
+   *             than the latest one by more than that are dropped
+   *  @param[in] capacity Maximum number of blocks kept (> 0)
+   *  @param[in] max_beacons Number of beacons slots are allocated for
+   *  @throw std::runtime_error if capacity is 0
+   */
+  ObservationWindow(const DorisRinexHeader &hdr, double span_sec,
+                    std::size_t capacity, int max_beacons = 16)
+      : m_slots(capacity + 1), m_epochs(capacity + 1),
+        m_span(static_cast<std::int64_t>(
+            span_sec * nanoseconds::sec_factor<double>())) {
+    if (!capacity)
+      throw std::runtime_error("[ERROR] Window capacity must be positive\n");
+    const int num_obs = hdr.obs_codes().size();
+    for (auto &s : m_slots) {
+      s.m_num_obs = num_obs;
+      s.m_columns = hdr.obs_columns();
+      s.m_beacon_ids.reserve(4 * max_beacons);
+      s.m_values.reserve(max_beacons * num_obs);
+      s.m_flags1.reserve(max_beacons * num_obs);
+      s.m_flags2.reserve(max_beacons * num_obs);
+    }
+  }
+
+  /* @brief Number of blocks in the window */
+  std::size_t size() const noexcept { return m_size; }
+  bool empty() const noexcept { return !m_size; }
+  /* @brief Maximum number of blocks kept */
+  std::size_t capacity() const noexcept { return m_slots.size() - 1; }
+
+  /* @brief Drop all blocks */
+  void clear() noexcept { m_first = m_size = 0; }
+
+  /* @brief The block of the given age (0 for the latest) */
+  const ObservationMatrix<T> &block(std::size_t age) const noexcept {
+    return m_slots[slot(age)];
+  }
+
+  /* @brief Epoch of the block of the given age */
+  const Datetime<nanoseconds> &epoch(std::size_t age) const noexcept {
+    return block(age).mheader.m_epoch;
+  }
+
+  /* @brief Row (i.e. beacon index) of a beacon in the block of the given
+   *        age; -1 if the beacon was not observed then
+   */
+  int find_beacon(std::size_t age, const char *id) const noexcept {
+    const auto &b = block(age);
+    for (int i = 0; i < b.num_beacons(); i++)
+      if (!std::strncmp(b.beacon_id(i), id, 3)) return i;
+    return -1;
+  }
+
+  /* @brief Value of an observable of a beacon in the block of the given
+   *        age; nullptr if the beacon was not observed then
+   */
+  const T *value(std::size_t age, const char *id, int obs) const noexcept {
+    const int i = find_beacon(age, id);
+    return (i < 0) ? nullptr : block(age).m_values.data() +
+                                   i * block(age).m_num_obs + obs;
+  }
+
+  /** @brief Add a block (e.g. off a DorisObsRinex iterator); values are
+   *         copied into a slot.
+   */
+  template <typename U> void push(const BasicDataBlock<U> &block) {
+    auto &s = next_slot();
+    const int num_beacons = block.mbeacon_obs.size();
+    StorageTraits<ObservationMatrix<T>>::begin_block(
+        s, block.mheader, block.mcolumns, num_beacons, s.m_num_obs);
+    for (int b = 0; b < num_beacons; b++) {
+      const auto &bobs = block.mbeacon_obs[b];
+      StorageTraits<ObservationMatrix<T>>::begin_beacon(s, b, bobs.id());
+      for (int k = 0; k < s.m_num_obs; k++) {
+        const auto &v = bobs.m_values[k];
+        StorageTraits<ObservationMatrix<T>>::value(
+            s, b, k, static_cast<T>(v.m_value), v.m_flag1, v.m_flag2);
+      }
+    }
+    commit();
+  }
+}; /* class ObservationWindow */
+
+/* Blocks are read into the next slot of the window */
+template <typename T> struct StorageTraits<ObservationWindow<T>> {
+  using value_type = T;
+  using Slot = StorageTraits<ObservationMatrix<T>>;
+  static void begin_block(ObservationWindow<T> &s,
+                          const RinexDataRecordHeader &h,
+                          const ObservationColumns &c, int num_beacons,
+                          int num_obs) {
+    Slot::begin_block(s.next_slot(), h, c, num_beacons, num_obs);
+  }
+  static void begin_beacon(ObservationWindow<T> &s, int beacon,
+                           const char *id) noexcept {
+    Slot::begin_beacon(s.next_slot(), beacon, id);
+  }
+  static void value(ObservationWindow<T> &s, int beacon, int obs, T v,
+                    char f1, char f2) noexcept {
+    Slot::value(s.next_slot(), beacon, obs, v, f1, f2);
+  }
+  static void end_block(ObservationWindow<T> &s) noexcept { s.commit(); }
+};
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -1,3 +1,6 @@
 include(CMakeFindDependencyMacro)
-# find_dependency(xxx 2.0)
+# Eigen is on the public interface (header-only views)
+find_dependency(Eigen3)
+# rnx is static; its private link to Threads is exported as $<LINK_ONLY:...>
+find_dependency(Threads)
 include(${CMAKE_CURRENT_LIST_DIR}/rnxTargets.cmake)
@@ -0,0 +1,269 @@
+#ifndef __DSO_DORIS_RINEX_ARCHIVE_CODEC_HPP__
+#define __DSO_DORIS_RINEX_ARCHIVE_CODEC_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "doris_rinex_details.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+namespace archive {
+
+/* Sanity limits on the sizes in a chunk frame; larger ones can only come
+ * from a corrupt archive
+ */
+static constexpr std::size_t MAX_ZONE_MAP_SIZE = 1024 * 1024;
+static constexpr std::size_t MAX_CHUNK_SIZE = 1024 * 1024 * 1024;
+
+inline std::uint64_t zigzag(std::int64_t v) noexcept {
+  return ((std::uint64_t)v << 1) ^ (std::uint64_t)(v >> 63);
+}
+inline std::int64_t unzigzag(std::uint64_t v) noexcept {
+  return (std::int64_t)(v >> 1) ^ -(std::int64_t)(v & 1);
+}
+
+/** Append-only byte buffer; fixed-width integers are little-endian, varints
+ *  are LEB128 and signed varints are zigzag-encoded.
+ */
+class ByteWriter {
+  std::vector<std::uint8_t> &m_buf;
+
+ public:
+  explicit ByteWriter(std::vector<std::uint8_t> &buf) noexcept : m_buf(buf) {}
+
+  void u8(std::uint8_t v) { m_buf.push_back(v); }
+  void u32(std::uint32_t v) {
+    for (int i = 0; i < 4; i++) m_buf.push_back((v >> (8 * i)) & 0xff);
+  }
+  void u64(std::uint64_t v) {
+    for (int i = 0; i < 8; i++) m_buf.push_back((v >> (8 * i)) & 0xff);
+  }
+  void f64(double v) {
+    std::uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    u64(u);
+  }
+  void varint(std::uint64_t v) {
+    while (v >= 0x80) {
+      m_buf.push_back((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+    m_buf.push_back(v);
+  }
+  void svarint(std::int64_t v) { varint(zigzag(v)); }
+  void bytes(const void *data, std::size_t n) {
+    const auto *p = static_cast<const std::uint8_t *>(data);
+    m_buf.insert(m_buf.end(), p, p + n);
+  }
+}; /* class ByteWriter */
+
+/** Reader for data written by ByteWriter; reading past the end sets the
+ *  error flag (and returns zeros).
+ */
+class ByteReader {
+  const std::uint8_t *m_ptr;
+  const std::uint8_t *m_end;
+  bool m_error{false};
+
+ public:
+  ByteReader(const std::uint8_t *data, std::size_t n) noexcept
+      : m_ptr(data), m_end(data + n) {}
+
+  bool error() const noexcept { return m_error; }
+  const std::uint8_t *ptr() const noexcept { return m_ptr; }
+  std::size_t left() const noexcept { return m_end - m_ptr; }
+
+  std::uint8_t u8() noexcept {
+    if (m_ptr >= m_end) {
+      m_error = true;
+      return 0;
+    }
+    return *m_ptr++;
+  }
+  std::uint32_t u32() noexcept {
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (std::uint32_t)u8() << (8 * i);
+    return v;
+  }
+  std::uint64_t u64() noexcept {
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (std::uint64_t)u8() << (8 * i);
+    return v;
+  }
+  double f64() noexcept {
+    const std::uint64_t u = u64();
+    double v;
+    std::memcpy(&v, &u, sizeof(v));
+    return v;
+  }
+  std::uint64_t varint() noexcept {
+    std::uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const std::uint8_t b = u8();
+      v |= (std::uint64_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    m_error = true;
+    return 0;
+  }
+  std::int64_t svarint() noexcept { return unzigzag(varint()); }
+  bool skip(std::size_t n) noexcept {
+    if (left() < n) {
+      m_error = true;
+      return false;
+    }
+    m_ptr += n;
+    return true;
+  }
+}; /* class ByteReader */
+
+/* Bit-level writer (MSB first), for the XOR codec */
+class BitWriter {
+  std::vector<std::uint8_t> &m_buf;
+  std::uint64_t m_acc{0};
+  int m_nbits{0};
+
+ public:
+  explicit BitWriter(std::vector<std::uint8_t> &buf) noexcept : m_buf(buf) {}
+
+  /* write the n (<= 64) least significant bits of v */
+  void put(std::uint64_t v, int n) {
+    if (n > 32) {
+      put(v >> 32, n - 32);
+      n = 32;
+    }
+    m_acc = (m_acc << n) | (v & ((std::uint64_t(1) << n) - 1));
+    m_nbits += n;
+    while (m_nbits >= 8) {
+      m_nbits -= 8;
+      m_buf.push_back((m_acc >> m_nbits) & 0xff);
+    }
+  }
+  /* pad the last byte with zeros */
+  void flush() {
+    if (m_nbits) put(0, 8 - m_nbits);
+  }
+}; /* class BitWriter */
+
+/* Bit-level reader for data written by BitWriter */
+class BitReader {
+  const std::uint8_t *m_ptr;
+  const std::uint8_t *m_end;
+  std::uint64_t m_acc{0};
+  int m_nbits{0};
+  bool m_error{false};
+
+ public:
+  BitReader(const std::uint8_t *data, std::size_t n) noexcept
+      : m_ptr(data), m_end(data + n) {}
+
+  bool error() const noexcept { return m_error; }
+
+  std::uint64_t get(int n) noexcept {
+    if (n > 32) {
+      const std::uint64_t hi = get(n - 32);
+      return (hi << 32) | get(32);
+    }
+    while (m_nbits < n) {
+      if (m_ptr >= m_end) {
+        m_error = true;
+        return 0;
+      }
+      m_acc = (m_acc << 8) | *m_ptr++;
+      m_nbits += 8;
+    }
+    m_nbits -= n;
+    return (m_acc >> m_nbits) & ((std::uint64_t(1) << n) - 1);
+  }
+}; /* class BitReader */
+
+/** XOR codec for series of doubles (in the style of Gorilla): each value is
+ *  XORed with the previous one; identical values cost a bit, and values
+ *  sharing sign/exponent/leading mantissa bits only store the bits that
+ *  differ.
+ */
+class XorEncoder {
+  BitWriter m_bits;
+  std::uint64_t m_prev{0};
+  int m_lead{-1};
+  int m_trail{0};
+  bool m_first{true};
+
+ public:
+  explicit XorEncoder(std::vector<std::uint8_t> &buf) noexcept : m_bits(buf) {}
+
+  void put(double v) {
+    std::uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    if (m_first) {
+      m_bits.put(u, 64);
+      m_first = false;
+    } else {
+      const std::uint64_t x = u ^ m_prev;
+      if (!x) {
+        m_bits.put(0, 1);
+      } else {
+        int lead = __builtin_clzll(x);
+        const int trail = __builtin_ctzll(x);
+        if (lead > 31) lead = 31;
+        if (m_lead >= 0 && lead >= m_lead && trail >= m_trail) {
+          m_bits.put(2, 2);
+          m_bits.put(x >> m_trail, 64 - m_lead - m_trail);
+        } else {
+          const int sig = 64 - lead - trail;
+          m_bits.put(3, 2);
+          m_bits.put(lead, 5);
+          m_bits.put(sig - 1, 6);
+          m_bits.put(x >> trail, sig);
+          m_lead = lead;
+          m_trail = trail;
+        }
+      }
+    }
+    m_prev = u;
+  }
+  void flush() { m_bits.flush(); }
+}; /* class XorEncoder */
+
+class XorDecoder {
+  BitReader m_bits;
+  std::uint64_t m_prev{0};
+  int m_lead{0};
+  int m_trail{0};
+  bool m_first{true};
+
+ public:
+  XorDecoder(const std::uint8_t *data, std::size_t n) noexcept
+      : m_bits(data, n) {}
+
+  bool error() const noexcept { return m_bits.error(); }
+
+  double get() noexcept {
+    if (m_first) {
+      m_prev = m_bits.get(64);
+      m_first = false;
+    } else if (m_bits.get(1)) {
+      if (m_bits.get(1)) {
+        m_lead = m_bits.get(5);
+        const int sig = m_bits.get(6) + 1;
+        m_trail = 64 - m_lead - sig;
+        if (m_trail < 0) m_trail = 0;
+      }
+      m_prev ^= m_bits.get(64 - m_lead - m_trail) << m_trail;
+    }
+    double v;
+    std::memcpy(&v, &m_prev, sizeof(v));
+    return v;
+  }
+}; /* class XorDecoder */
+
+} /* namespace archive */
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
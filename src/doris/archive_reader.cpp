@@ -0,0 +1,335 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "archive_codec.hpp"
+#include "doris_rinex_archive.hpp"
+#include "doris_rinex_kernels.hpp"
+
+namespace {
+
+using namespace dso::doris_rnx::archive;
+using dso::doris_rnx::ns_to_epoch;
+namespace kernels = dso::doris_rnx::kernels;
+
+constexpr double VALUE_UNIT = 1e3;
+
+/* Read a run-length encoded series of n (pairs of) chars into flags */
+bool read_flag_runs(ByteReader &r, std::size_t n, char *flags) noexcept {
+  const std::uint64_t nruns = r.varint();
+  std::size_t j = 0;
+  for (std::uint64_t i = 0; i < nruns && !r.error(); i++) {
+    const std::uint64_t len = r.varint();
+    const char f1 = r.u8();
+    const char f2 = r.u8();
+    if (len > n - j) return false;
+    for (std::uint64_t l = 0; l < len; l++, j++) {
+      flags[2 * j] = f1;
+      flags[2 * j + 1] = f2;
+    }
+  }
+  return !r.error() && j == n;
+}
+
+/* Read a zone map (see write_zone_map) */
+bool read_zone_map(ByteReader &r, dso::doris_rnx::ChunkZoneMap &zm) noexcept {
+  zm.m_first_epoch = ns_to_epoch(r.svarint());
+  zm.m_last_epoch = ns_to_epoch(r.svarint());
+  zm.m_flagged_epochs = r.varint();
+  zm.m_beacons.reset();
+  for (int i = 0; i < dso::doris_rnx::ChunkZoneMap::MAX_BEACON_BITS; i += 8) {
+    const std::uint8_t byte = r.u8();
+    for (int j = 0; j < 8; j++)
+      if (byte & (1 << j)) zm.m_beacons.set(i + j);
+  }
+  const std::uint64_t num_obs = r.varint();
+  if (r.error() || num_obs > r.left() / 16) return false;
+  zm.m_min.resize(num_obs);
+  zm.m_max.resize(num_obs);
+  for (std::uint64_t k = 0; k < num_obs; k++) {
+    zm.m_min[k] = r.f64();
+    zm.m_max[k] = r.f64();
+  }
+  return !r.error();
+}
+
+/* Read n XOR-compressed doubles into values */
+bool read_xor(ByteReader &r, std::size_t n, double *values) noexcept {
+  const std::uint64_t sz = r.varint();
+  if (r.error() || sz > r.left()) return false;
+  XorDecoder xd(r.ptr(), sz);
+  for (std::size_t j = 0; j < n; j++) values[j] = xd.get();
+  return !xd.error() && r.skip(sz);
+}
+
+} /* unnamed namespace */
+
+/* A decoded chunk; all columns are contiguous arrays */
+struct dso::doris_rnx::ArchiveReader::Chunk {
+  int m_num_epochs{0};
+  /* next epoch to deliver */
+  int m_next{0};
+  std::vector<std::int64_t> m_epochs;
+  /* epoch and clock flags, interleaved */
+  std::vector<char> m_flags;
+  std::vector<double> m_clock_offsets;
+  /* beacon ids (3 chars each) */
+  std::vector<char> m_ids;
+  /* beacon (indexes) of epoch i are m_lists[m_list_start[i], ...[i+1]) */
+  std::vector<std::uint32_t> m_list_start;
+  std::vector<std::uint32_t> m_lists;
+  /* per beacon, index of the next value of its series */
+  std::vector<std::uint32_t> m_series_pos;
+  /* per beacon and observable (at [beacon * num_obs + obs]), values and
+   * flags (interleaved)
+   */
+  std::vector<std::vector<double>> m_values;
+  std::vector<std::vector<char>> m_value_flags;
+  /* scratch */
+  std::vector<std::int64_t> m_ivalues;
+  std::vector<char> m_present;
+}; /* struct Chunk */
+
+dso::doris_rnx::ArchiveReader::ArchiveReader(std::istream &is)
+    : m_is(&is), m_chunk(std::make_unique<Chunk>()) {
+  char magic[4];
+  if (!m_is->read(magic, 4) || std::memcmp(magic, "DRXA", 4)) {
+    throw std::runtime_error("[ERROR] Stream is not a DORIS archive\n");
+  }
+  char buf[6];
+  if (!m_is->read(buf, 2) || buf[0] != 1) {
+    throw std::runtime_error("[ERROR] Unsupported DORIS archive version\n");
+  }
+  const int num_obs = (unsigned char)buf[1];
+  for (int k = 0; k < num_obs; k++) {
+    if (!m_is->read(buf, 6))
+      throw std::runtime_error("[ERROR] Failed reading archive header\n");
+    /* may throw */
+    m_obs_codes.emplace_back(char_to_dobstype(buf[0]), (signed char)buf[1]);
+    std::uint32_t scale = 0;
+    for (int i = 0; i < 4; i++)
+      scale |= (std::uint32_t)(unsigned char)buf[2 + i] << (8 * i);
+    m_scale_factors.push_back(scale);
+  }
+  m_obs_columns = ObservationColumns(m_obs_codes);
+  std::uint64_t len = 0;
+  for (int shift = 0;; shift += 7) {
+    const int c = m_is->get();
+    if (c == std::char_traits<char>::eof() || shift > 63)
+      throw std::runtime_error("[ERROR] Failed reading archive header\n");
+    len |= (std::uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80)) break;
+  }
+  m_satellite_name.resize(len);
+  if (len && !m_is->read(&m_satellite_name[0], len))
+    throw std::runtime_error("[ERROR] Failed reading archive header\n");
+}
+
+dso::doris_rnx::ArchiveReader::~ArchiveReader() noexcept = default;
+
+/* Reads chunk frames until one passes the filter (skipping the payload of
+ * the others), and decodes it.
+ */
+int dso::doris_rnx::ArchiveReader::read_chunk() noexcept {
+  std::uint32_t num_epochs;
+  std::size_t size;
+
+  /* the chunk is left empty until one is fully decoded */
+  auto &c = *m_chunk;
+  c.m_num_epochs = 0;
+  c.m_next = 0;
+
+  try {
+    for (;;) {
+      std::uint8_t frame[8];
+      if (!m_is->read(reinterpret_cast<char *>(frame), 8)) {
+        return (m_is->gcount() == 0 && m_is->eof()) ? -1 : 1;
+      }
+      ByteReader fr(frame, 8);
+      num_epochs = fr.u32();
+      size = fr.u32();
+      if (size > MAX_ZONE_MAP_SIZE) return 2;
+
+      /* zone map, followed by the size of the payload */
+      m_buf.resize(size + 4);
+      if (!m_is->read(reinterpret_cast<char *>(m_buf.data()), size + 4))
+        return 1;
+      ByteReader zr(m_buf.data(), size);
+      if (!read_zone_map(zr, m_zone_map)) return 2;
+      ByteReader pr(m_buf.data() + size, 4);
+      size = pr.u32();
+      /* every epoch takes (at least) a byte of the payload */
+      if (size > MAX_CHUNK_SIZE || num_epochs > size) return 2;
+      m_zone_map.m_num_epochs = num_epochs;
+
+      if (!m_filter || m_filter(m_zone_map)) break;
+
+      /* skip the payload; seek if possible, else read through */
+      ++m_chunks_skipped;
+      if (!m_is->seekg(size, std::ios_base::cur)) {
+        m_is->clear();
+        if (!m_is->ignore(size) || m_is->gcount() != (std::streamsize)size)
+          return 1;
+      }
+    }
+    ++m_chunks_read;
+
+    m_buf.resize(size);
+    if (!m_is->read(reinterpret_cast<char *>(m_buf.data()), size)) return 1;
+
+    const int num_obs = m_scale_factors.size();
+    ByteReader r(m_buf.data(), m_buf.size());
+
+    /* epochs: grid plus exceptions */
+    c.m_epochs.resize(num_epochs);
+    const std::int64_t t0 = r.svarint();
+    const std::int64_t step = r.svarint();
+    for (std::uint32_t i = 0; i < num_epochs; i++) c.m_epochs[i] = t0 + i * step;
+    const std::uint64_t num_exceptions = r.varint();
+    std::uint64_t idx = 0;
+    std::int64_t offset = 0;
+    for (std::uint64_t e = 0; e < num_exceptions && !r.error(); e++) {
+      idx += r.varint();
+      offset += r.svarint();
+      if (idx >= num_epochs) return 2;
+      c.m_epochs[idx] += offset;
+    }
+
+    /* epoch/clock flags and clock offsets */
+    c.m_flags.resize(2 * num_epochs);
+    if (!read_flag_runs(r, num_epochs, c.m_flags.data())) return 2;
+    c.m_clock_offsets.resize(num_epochs);
+    if (!read_xor(r, num_epochs, c.m_clock_offsets.data())) return 2;
+
+    /* beacon table and lists */
+    const std::uint64_t num_beacons = r.varint();
+    if (r.error() || num_beacons > r.left() / 3) return 2;
+    c.m_ids.resize(3 * num_beacons);
+    for (auto &ch : c.m_ids) ch = r.u8();
+    c.m_list_start.resize(num_epochs + 1);
+    c.m_lists.clear();
+    std::vector<std::uint32_t> series_size(num_beacons, 0);
+    c.m_list_start[0] = 0;
+    for (std::uint32_t i = 0; i < num_epochs && !r.error(); i++) {
+      const std::uint64_t n = r.varint();
+      if (!n) {
+        if (!i) return 2;
+        const auto first = c.m_list_start[i - 1];
+        const auto last = c.m_list_start[i];
+        for (auto j = first; j < last; j++) c.m_lists.push_back(c.m_lists[j]);
+      } else {
+        for (std::uint64_t j = 1; j < n; j++) {
+          const std::uint64_t b = r.varint();
+          if (b >= num_beacons) return 2;
+          c.m_lists.push_back(b);
+        }
+      }
+      for (auto j = c.m_list_start[i]; j < c.m_lists.size(); j++)
+        ++series_size[c.m_lists[j]];
+      c.m_list_start[i + 1] = c.m_lists.size();
+    }
+
+    /* per beacon and observable series */
+    c.m_series_pos.assign(num_beacons, 0);
+    c.m_values.resize(num_beacons * num_obs);
+    c.m_value_flags.resize(num_beacons * num_obs);
+    for (std::uint64_t b = 0; b < num_beacons && !r.error(); b++) {
+      const std::size_t n = series_size[b];
+      for (int k = 0; k < num_obs; k++) {
+        auto &values = c.m_values[b * num_obs + k];
+        auto &flags = c.m_value_flags[b * num_obs + k];
+        const double scale = m_scale_factors[k];
+        values.resize(n);
+        flags.resize(2 * n);
+
+        const int mode = r.u8();
+        if (mode == 0) {
+          /* missing mask (runs, alternating present/missing) */
+          const std::uint64_t nruns = r.varint();
+          c.m_present.resize(n);
+          std::size_t j = 0, m = 0;
+          for (std::uint64_t run = 0; run < nruns && !r.error(); run++) {
+            const std::uint64_t len = r.varint();
+            if (len > n - j) return 2;
+            if (!(run & 1)) m += len;
+            std::memset(c.m_present.data() + j, !(run & 1), len);
+            j += len;
+          }
+          if (j != n) return 2;
+
+          /* delta-of-delta residuals, restored by two prefix sums */
+          c.m_ivalues.resize(m);
+          std::int64_t *iv = c.m_ivalues.data();
+          for (std::size_t l = 0; l < m; l++) iv[l] = r.svarint();
+          for (std::size_t l = 2; l < m; l++) iv[l] += iv[l - 1];
+          for (std::size_t l = 1; l < m; l++) iv[l] += iv[l - 1];
+
+          /* scale (same arithmetic as the RINEX parser) into the first m
+           * slots, then scatter in place, backwards
+           */
+          kernels::scale_values(iv, m, VALUE_UNIT, scale, values.data());
+          const double missing = OBSERVATION_VALUE_MISSING / scale;
+          for (std::size_t l = m, jj = n; jj-- > 0;)
+            values[jj] = c.m_present[jj] ? values[--l] : missing;
+        } else if (mode == 1) {
+          if (!read_xor(r, n, values.data())) return 2;
+        } else {
+          return 2;
+        }
+        if (!read_flag_runs(r, n, flags.data())) return 2;
+      }
+    }
+    if (r.error()) return 2;
+    c.m_num_epochs = num_epochs;
+  } catch (std::exception &) {
+    return 1;
+  }
+
+  return 0;
+}
+
+void dso::doris_rnx::ArchiveReader::skip_chunk() noexcept {
+  m_chunk->m_next = m_chunk->m_num_epochs;
+}
+
+int dso::doris_rnx::ArchiveReader::next(DataBlock &block) noexcept {
+  if (m_chunk->m_next >= m_chunk->m_num_epochs) {
+    int status;
+    do {
+      status = read_chunk();
+      if (status) {
+        if (status > 0)
+          fprintf(stderr,
+                  "[ERROR] Failed decoding archive chunk (traceback: %s)\n",
+                  __func__);
+        return status;
+      }
+    } while (!m_chunk->m_num_epochs);
+  }
+
+  auto &c = *m_chunk;
+  const int i = c.m_next++;
+  const int num_obs = m_scale_factors.size();
+  block.mheader.m_epoch = ns_to_epoch(c.m_epochs[i]);
+  block.mheader.m_flag = c.m_flags[2 * i];
+  block.mheader.m_clock_flag = c.m_flags[2 * i + 1];
+  block.mheader.m_clock_offset = c.m_clock_offsets[i];
+  block.mheader.m_num_stations = c.m_list_start[i + 1] - c.m_list_start[i];
+
+  block.mcolumns = m_obs_columns;
+  block.mbeacon_obs.clear();
+  block.mbeacon_obs.reserve(block.mheader.m_num_stations);
+  for (auto j = c.m_list_start[i]; j < c.m_list_start[i + 1]; j++) {
+    const std::uint32_t b = c.m_lists[j];
+    const std::uint32_t pos = c.m_series_pos[b]++;
+    block.mbeacon_obs.emplace_back(BeaconObservations{});
+    auto &bobs = block.mbeacon_obs.back();
+    std::memcpy(bobs.m_beacon_id, c.m_ids.data() + 3 * b, 3);
+    for (int k = 0; k < num_obs; k++) {
+      const auto &flags = c.m_value_flags[b * num_obs + k];
+      bobs.m_values.emplace_back(c.m_values[b * num_obs + k][pos],
+                                 flags[2 * pos], flags[2 * pos + 1]);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "archive_codec.hpp"
+#include "doris_rinex_archive.hpp"
+
+namespace {
+
+using namespace dso::doris_rnx::archive;
+using dso::doris_rnx::epoch_to_ns;
+
+/* Values of (RINEX) F14.3 fields are integers in these units */
+constexpr double VALUE_UNIT = 1e3;
+
+/* Largest integer (in VALUE_UNIT) stored as such; larger values go to XOR */
+constexpr double MAX_INTEGER_VALUE = 9007199254740992e0; /* 2^53 */
+
+bool same_bits(double a, double b) noexcept {
+  return !std::memcmp(&a, &b, sizeof(double));
+}
+
+/* Write a run-length encoded series of (pairs of) chars */
+void write_flag_runs(ByteWriter &w, const std::vector<char> &flags) {
+  std::vector<std::uint8_t> runs;
+  ByteWriter rw(runs);
+  std::size_t nruns = 0;
+  const std::size_t n = flags.size() / 2;
+  for (std::size_t i = 0; i < n;) {
+    std::size_t j = i + 1;
+    while (j < n && flags[2 * j] == flags[2 * i] &&
+           flags[2 * j + 1] == flags[2 * i + 1])
+      ++j;
+    rw.varint(j - i);
+    rw.u8(flags[2 * i]);
+    rw.u8(flags[2 * i + 1]);
+    ++nruns;
+    i = j;
+  }
+  w.varint(nruns);
+  w.bytes(runs.data(), runs.size());
+}
+
+/* Compute the zone map of a chunk and write it */
+void write_zone_map(ByteWriter &w,
+                    const std::vector<dso::doris_rnx::DataBlock> &blocks,
+                    const std::vector<int> &scale_factors) {
+  const int num_obs = scale_factors.size();
+  std::vector<double> min(num_obs, std::numeric_limits<double>::max());
+  std::vector<double> max(num_obs, std::numeric_limits<double>::lowest());
+  std::vector<double> missing(num_obs);
+  for (int k = 0; k < num_obs; k++)
+    missing[k] = dso::doris_rnx::OBSERVATION_VALUE_MISSING / scale_factors[k];
+  std::bitset<dso::doris_rnx::ChunkZoneMap::MAX_BEACON_BITS> beacons;
+  std::int64_t first = epoch_to_ns(blocks[0].mheader.m_epoch);
+  std::int64_t last = first;
+  std::uint64_t flagged = 0;
+
+  for (const auto &block : blocks) {
+    const std::int64_t t = epoch_to_ns(block.mheader.m_epoch);
+    first = std::min(first, t);
+    last = std::max(last, t);
+    flagged += (block.mheader.m_flag > 0);
+    for (const auto &bobs : block.mbeacon_obs) {
+      beacons.set(dso::doris_rnx::ChunkZoneMap::beacon_bit(bobs.id()));
+      for (int k = 0; k < num_obs; k++) {
+        const double v = bobs.m_values[k].m_value;
+        if (same_bits(v, missing[k])) continue;
+        if (v < min[k]) min[k] = v;
+        if (v > max[k]) max[k] = v;
+      }
+    }
+  }
+
+  w.svarint(first);
+  w.svarint(last);
+  w.varint(flagged);
+  for (int i = 0; i < dso::doris_rnx::ChunkZoneMap::MAX_BEACON_BITS; i += 8) {
+    std::uint8_t byte = 0;
+    for (int j = 0; j < 8; j++) byte |= beacons.test(i + j) << j;
+    w.u8(byte);
+  }
+  w.varint(num_obs);
+  for (int k = 0; k < num_obs; k++) {
+    w.f64(min[k]);
+    w.f64(max[k]);
+  }
+}
+
+/* Write a series of doubles, XOR-compressed (length-prefixed) */
+void write_xor(ByteWriter &w, const std::vector<double> &values) {
+  std::vector<std::uint8_t> bits;
+  XorEncoder xe(bits);
+  for (double v : values) xe.put(v);
+  xe.flush();
+  w.varint(bits.size());
+  w.bytes(bits.data(), bits.size());
+}
+
+} /* unnamed namespace */
+
+dso::doris_rnx::ArchiveWriter::ArchiveWriter(std::ostream &os,
+                                             const DorisRinexHeader &hdr,
+                                             int chunk_epochs)
+    : m_os(&os),
+      m_scale_factors(hdr.obs_scale_factors()),
+      m_chunk_epochs(std::max(1, chunk_epochs)) {
+  m_pending.reserve(m_chunk_epochs);
+
+  /* archive header */
+  ByteWriter w(m_buf);
+  w.bytes("DRXA", 4);
+  w.u8(1); /* version */
+  w.u8(hdr.obs_codes().size());
+  for (std::size_t k = 0; k < hdr.obs_codes().size(); k++) {
+    const auto &code = hdr.obs_codes()[k];
+    w.u8(dobstype_to_char(code.dobstype()));
+    w.u8(code.m_freq);
+    w.u32(m_scale_factors[k]);
+  }
+  const std::size_t len = strnlen(hdr.satellite_name(), 60);
+  w.varint(len);
+  w.bytes(hdr.satellite_name(), len);
+
+  if (!m_os->write(reinterpret_cast<const char *>(m_buf.data()),
+                   m_buf.size())) {
+    throw std::runtime_error("[ERROR] Failed writing archive header\n");
+  }
+}
+
+dso::doris_rnx::ArchiveWriter::~ArchiveWriter() noexcept { flush(); }
+
+int dso::doris_rnx::ArchiveWriter::append(const DataBlock &block) noexcept {
+  if (m_error) return 1;
+  for (const auto &bobs : block.mbeacon_obs) {
+    if (bobs.m_values.size() != m_scale_factors.size()) {
+      fprintf(stderr,
+              "[ERROR] Invalid number of observables for beacon %s "
+              "(traceback: %s)\n",
+              bobs.id(), __func__);
+      return 1;
+    }
+  }
+  try {
+    m_pending.push_back(block);
+  } catch (std::exception &) {
+    m_error = true;
+    return 1;
+  }
+  return ((int)m_pending.size() >= m_chunk_epochs) ? write_chunk() : 0;
+}
+
+int dso::doris_rnx::ArchiveWriter::flush() noexcept {
+  if (m_error) return 1;
+  int status = write_chunk();
+  if (!status && !m_os->flush()) status = 1;
+  return status;
+}
+
+int dso::doris_rnx::ArchiveWriter::write_chunk() noexcept {
+  if (m_pending.empty()) return 0;
+
+  try {
+    const int num_epochs = m_pending.size();
+    const int num_obs = m_scale_factors.size();
+    m_buf.clear();
+    ByteWriter w(m_buf);
+
+    /* epochs; a regular grid (first epoch and median step) plus exceptions,
+     * i.e. (index, offset from grid) for epochs off the grid; offsets are
+     * differenced
+     */
+    std::vector<std::int64_t> t(num_epochs);
+    for (int i = 0; i < num_epochs; i++)
+      t[i] = epoch_to_ns(m_pending[i].mheader.m_epoch);
+    std::int64_t step = 0;
+    if (num_epochs > 1) {
+      std::vector<std::int64_t> dt(num_epochs - 1);
+      for (int i = 1; i < num_epochs; i++) dt[i - 1] = t[i] - t[i - 1];
+      std::nth_element(dt.begin(), dt.begin() + dt.size() / 2, dt.end());
+      step = dt[dt.size() / 2];
+    }
+    w.svarint(t[0]);
+    w.svarint(step);
+    int num_exceptions = 0;
+    for (int i = 0; i < num_epochs; i++)
+      num_exceptions += (t[i] != t[0] + i * step);
+    w.varint(num_exceptions);
+    std::int64_t prev_offset = 0;
+    for (int i = 0, prev = 0; i < num_epochs; i++) {
+      const std::int64_t offset = t[i] - (t[0] + i * step);
+      if (offset) {
+        w.varint(i - prev);
+        w.svarint(offset - prev_offset);
+        prev = i;
+        prev_offset = offset;
+      }
+    }
+
+    /* epoch and clock flags */
+    std::vector<char> flags(2 * num_epochs);
+    for (int i = 0; i < num_epochs; i++) {
+      flags[2 * i] = m_pending[i].mheader.m_flag;
+      flags[2 * i + 1] = m_pending[i].mheader.m_clock_flag;
+    }
+    write_flag_runs(w, flags);
+
+    /* clock offsets */
+    std::vector<double> values(num_epochs);
+    for (int i = 0; i < num_epochs; i++)
+      values[i] = m_pending[i].mheader.m_clock_offset;
+    write_xor(w, values);
+
+    /* beacon table, and the beacon list of each epoch */
+    std::vector<std::uint32_t> keys;
+    std::vector<std::vector<const BeaconObservations *>> series;
+    std::vector<std::uint32_t> list, prev_list;
+    std::vector<std::uint8_t> lists;
+    ByteWriter lw(lists);
+    for (int i = 0; i < num_epochs; i++) {
+      list.clear();
+      for (const auto &bobs : m_pending[i].mbeacon_obs) {
+        const char *id = bobs.id();
+        const std::uint32_t key = (std::uint32_t)(unsigned char)id[0] << 16 |
+                                  (std::uint32_t)(unsigned char)id[1] << 8 |
+                                  (std::uint32_t)(unsigned char)id[2];
+        const auto it = std::find(keys.begin(), keys.end(), key);
+        const std::uint32_t idx = it - keys.begin();
+        if (it == keys.end()) {
+          keys.push_back(key);
+          series.emplace_back();
+        }
+        series[idx].push_back(&bobs);
+        list.push_back(idx);
+      }
+      if (i && list == prev_list) {
+        lw.varint(0);
+      } else {
+        lw.varint(list.size() + 1);
+        for (auto idx : list) lw.varint(idx);
+      }
+      std::swap(list, prev_list);
+    }
+    w.varint(keys.size());
+    for (auto key : keys) {
+      w.u8(key >> 16);
+      w.u8(key >> 8);
+      w.u8(key);
+    }
+    w.bytes(lists.data(), lists.size());
+
+    /* per beacon and observable, the series of values and flags */
+    std::vector<std::int64_t> ivalues;
+    std::vector<std::uint64_t> mask_runs;
+    for (const auto &s : series) {
+      const std::size_t n = s.size();
+      values.resize(n);
+      flags.resize(2 * n);
+      for (int k = 0; k < num_obs; k++) {
+        const double scale = m_scale_factors[k];
+        const double missing = OBSERVATION_VALUE_MISSING / scale;
+
+        /* integer-valued series (bar missing values) ? */
+        bool is_integer = true;
+        ivalues.clear();
+        mask_runs.clear();
+        bool present = true;
+        std::uint64_t run = 0;
+        for (std::size_t j = 0; j < n; j++) {
+          const auto &obs = s[j]->m_values[k];
+          values[j] = obs.m_value;
+          flags[2 * j] = obs.m_flag1;
+          flags[2 * j + 1] = obs.m_flag2;
+          if (!is_integer) continue;
+          const bool is_missing = same_bits(obs.m_value, missing);
+          if (is_missing == present) {
+            mask_runs.push_back(run);
+            run = 0;
+            present = !present;
+          }
+          ++run;
+          if (is_missing) continue;
+          const double x = obs.m_value * scale * VALUE_UNIT;
+          if (!(std::abs(x) < MAX_INTEGER_VALUE)) {
+            is_integer = false;
+            continue;
+          }
+          const std::int64_t iv = std::llround(x);
+          if (!same_bits((iv / VALUE_UNIT) / scale, obs.m_value))
+            is_integer = false;
+          ivalues.push_back(iv);
+        }
+        mask_runs.push_back(run);
+
+        if (is_integer) {
+          /* missing mask (runs, alternating present/missing), then
+           * delta-of-delta residuals
+           */
+          w.u8(0);
+          w.varint(mask_runs.size());
+          for (auto r : mask_runs) w.varint(r);
+          const std::size_t m = ivalues.size();
+          for (std::size_t j = 0; j < m; j++) {
+            if (j < 1) {
+              w.svarint(ivalues[0]);
+            } else if (j < 2) {
+              w.svarint(ivalues[1] - ivalues[0]);
+            } else {
+              w.svarint((ivalues[j] - ivalues[j - 1]) -
+                        (ivalues[j - 1] - ivalues[j - 2]));
+            }
+          }
+        } else {
+          w.u8(1);
+          write_xor(w, values);
+        }
+        write_flag_runs(w, flags);
+      }
+    }
+
+    /* chunk frame: number of epochs, zone map and payload */
+    std::vector<std::uint8_t> frame;
+    ByteWriter fw(frame);
+    std::vector<std::uint8_t> zone_map;
+    ByteWriter zw(zone_map);
+    write_zone_map(zw, m_pending, m_scale_factors);
+    fw.u32(num_epochs);
+    fw.u32(zone_map.size());
+    fw.bytes(zone_map.data(), zone_map.size());
+    fw.u32(m_buf.size());
+    m_os->write(reinterpret_cast<const char *>(frame.data()), frame.size());
+    m_os->write(reinterpret_cast<const char *>(m_buf.data()), m_buf.size());
+    m_pending.clear();
+    if (!*m_os) {
+      fprintf(stderr, "[ERROR] Failed writing archive chunk (traceback: %s)\n",
+              __func__);
+      m_error = true;
+      return 1;
+    }
+  } catch (std::exception &) {
+    m_error = true;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+#include "doris_rinex_batch.hpp"
+#include "io_uring_ring.hpp"
+
+namespace {
+
+/* a file being read (or read) into memory */
+struct Job {
+  std::size_t m_index;
+  int m_fd{-1};
+  std::vector<char> m_buf;
+  /* bytes read so far */
+  std::size_t m_done{0};
+  iovec m_iov;
+
+  ~Job() noexcept {
+    if (m_fd >= 0) close(m_fd);
+  }
+}; /* struct Job */
+
+/* max bytes per read request */
+constexpr std::size_t MAX_READ_BYTES = std::size_t(1) << 30;
+
+/* Open a file and allocate its buffer; null on error */
+std::unique_ptr<Job> open_job(const std::string &fn, std::size_t index) {
+  auto job = std::make_unique<Job>();
+  job->m_index = index;
+  job->m_fd = open(fn.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (job->m_fd < 0 || fstat(job->m_fd, &st) || !S_ISREG(st.st_mode)) {
+    fprintf(stderr, "[ERROR] Failed opening file %s (traceback: %s)\n",
+            fn.c_str(), __func__);
+    return nullptr;
+  }
+  job->m_buf.resize(st.st_size);
+  return job;
+}
+
+/* Bounded queue of loaded files, from the reader to the workers */
+class JobQueue {
+  std::mutex m_mtx;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::deque<std::unique_ptr<Job>> m_jobs;
+  std::size_t m_capacity;
+  bool m_closed{false};
+
+ public:
+  explicit JobQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+  void push(std::unique_ptr<Job> job) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_not_full.wait(lock, [this] { return m_jobs.size() < m_capacity; });
+    m_jobs.push_back(std::move(job));
+    m_not_empty.notify_one();
+  }
+
+  /* false when the queue is closed and empty */
+  bool pop(std::unique_ptr<Job> &job) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_not_empty.wait(lock, [this] { return !m_jobs.empty() || m_closed; });
+    if (m_jobs.empty()) return false;
+    job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    m_not_full.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_closed = true;
+    m_not_empty.notify_all();
+  }
+}; /* class JobQueue */
+
+/* Read files one after the other, with plain reads */
+void read_plain(const std::vector<std::string> &files, JobQueue &queue,
+                std::atomic<int> &failures) {
+  for (std::size_t i = 0; i < files.size(); i++) {
+    auto job = open_job(files[i], i);
+    if (!job) {
+      ++failures;
+      continue;
+    }
+    while (job->m_done < job->m_buf.size()) {
+      const ssize_t n =
+          pread(job->m_fd, job->m_buf.data() + job->m_done,
+                std::min(job->m_buf.size() - job->m_done, MAX_READ_BYTES),
+                job->m_done);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;
+      job->m_done += n;
+    }
+    if (job->m_done < job->m_buf.size()) {
+      fprintf(stderr, "[ERROR] Failed reading file %s (traceback: %s)\n",
+              files[i].c_str(), __func__);
+      ++failures;
+      continue;
+    }
+    close(job->m_fd);
+    job->m_fd = -1;
+    queue.push(std::move(job));
+  }
+}
+
+#ifdef RNX_HAVE_IO_URING
+/* Read files via io_uring, with up to depth files in flight; returns false
+ * if the ring could not be set up (nothing is read then).
+ */
+bool read_uring(const std::vector<std::string> &files, JobQueue &queue,
+                std::atomic<int> &failures, int depth) {
+  dso::doris_rnx::UringRing ring(depth);
+  if (!ring.ok()) return false;
+
+  std::vector<std::unique_ptr<Job>> slots(depth);
+  std::vector<int> free_slots;
+  for (int i = depth - 1; i >= 0; i--) free_slots.push_back(i);
+  std::size_t next = 0;
+  int in_flight = 0;
+
+  auto queue_next_read = [&](int slot) {
+    Job &job = *slots[slot];
+    job.m_iov.iov_base = job.m_buf.data() + job.m_done;
+    job.m_iov.iov_len =
+        std::min(job.m_buf.size() - job.m_done, MAX_READ_BYTES);
+    /* cannot fail; at most depth reads are queued */
+    ring.queue_read(job.m_fd, &job.m_iov, job.m_done, slot);
+  };
+  auto release = [&](int slot, bool ok) {
+    if (ok) {
+      close(slots[slot]->m_fd);
+      slots[slot]->m_fd = -1;
+      queue.push(std::move(slots[slot]));
+    } else {
+      fprintf(stderr, "[ERROR] Failed reading file %s (traceback: %s)\n",
+              files[slots[slot]->m_index].c_str(), __func__);
+      ++failures;
+      slots[slot].reset();
+    }
+    free_slots.push_back(slot);
+    --in_flight;
+  };
+
+  for (;;) {
+    /* queue reads for new files, while there is room */
+    while (!free_slots.empty() && next < files.size()) {
+      auto job = open_job(files[next], next);
+      ++next;
+      if (!job) {
+        ++failures;
+        continue;
+      }
+      if (job->m_buf.empty()) {
+        queue.push(std::move(job));
+        continue;
+      }
+      const int slot = free_slots.back();
+      free_slots.pop_back();
+      slots[slot] = std::move(job);
+      queue_next_read(slot);
+      ++in_flight;
+    }
+    if (!in_flight) break;
+
+    /* submit, wait for (at least) a completion, and reap all available */
+    if (ring.submit(1) < 0) {
+      /* should not happen; give up on in-flight files */
+      for (int slot = 0; slot < depth; slot++)
+        if (slots[slot]) release(slot, false);
+      break;
+    }
+    std::uint64_t slot;
+    int res;
+    while (ring.reap(slot, res)) {
+      Job &job = *slots[slot];
+      if (res == -EINTR || res == -EAGAIN) {
+        queue_next_read(slot);
+      } else if (res <= 0) {
+        release(slot, false);
+      } else {
+        job.m_done += res;
+        if (job.m_done < job.m_buf.size()) {
+          queue_next_read(slot);
+        } else {
+          release(slot, true);
+        }
+      }
+    }
+  }
+  return true;
+}
+#endif
+
+} /* unnamed namespace */
+
+bool dso::doris_rnx::io_uring_available() noexcept {
+#ifdef RNX_HAVE_IO_URING
+  UringRing ring(1);
+  return ring.ok();
+#else
+  return false;
+#endif
+}
+
+int dso::doris_rnx::ingest_files(const std::vector<std::string> &files,
+                                 const file_handler &handler,
+                                 const BatchOptions &opts) {
+  const int num_threads =
+      opts.m_num_threads > 0
+          ? opts.m_num_threads
+          : std::max(1, (int)std::thread::hardware_concurrency());
+  const int depth = std::max(1, opts.m_queue_depth);
+
+  std::atomic<int> failures{0};
+  JobQueue queue(depth);
+
+  /* workers: parse loaded files and call the handler */
+  std::vector<std::thread> workers;
+  for (int t = 0; t < num_threads; t++) {
+    workers.emplace_back([&] {
+      std::unique_ptr<Job> job;
+      while (queue.pop(job)) {
+        try {
+          DorisObsRinex rnx(std::make_unique<MemorySource>(job->m_buf.data(),
+                                                           job->m_buf.size()),
+                            files[job->m_index].c_str());
+          if (!rnx.header_ok())
+            throw std::runtime_error("[ERROR] Cannot read RINEX header\n");
+          handler(job->m_index, rnx);
+        } catch (std::exception &e) {
+          fprintf(stderr, "[ERROR] Failed processing file %s (what: %s)\n",
+                  files[job->m_index].c_str(), e.what());
+          ++failures;
+        } catch (...) {
+          fprintf(stderr, "[ERROR] Failed processing file %s\n",
+                  files[job->m_index].c_str());
+          ++failures;
+        }
+        job.reset();
+      }
+    });
+  }
+
+  /* read files (on this thread) */
+  bool done = false;
+#ifdef RNX_HAVE_IO_URING
+  if (opts.m_use_io_uring) done = read_uring(files, queue, failures, depth);
+#endif
+  if (!done) read_plain(files, queue, failures);
+
+  queue.close();
+  for (auto &w : workers) w.join();
+  return failures;
+}
@@ -2,13 +2,10 @@
 #include "doris_rinex_details.hpp"
 
 int dso::doris_rnx::Beacon::set_from_rinex_line(const char *line) noexcept {
-  if (line[0] != 'D') {
-    fprintf(stderr,
-            "[ERROR] Rinex 'STATION REFERENCE' fields should start with a 'D'! "
-            "(traceback: %s)\n",
-            __func__);
-    return 1;
-  }
+  /* Rinex 'STATION REFERENCE' fields should start with a 'D'; the caller
+   * reports the error (with the line)
+   */
+  if (line[0] != 'D') return 1;
 
   /* copy line as-is */
   std::memcpy(mpool, line, 52 * sizeof(char));
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "bounded_queue.hpp"
+#include "doris_rinex_shards.hpp"
+
+namespace {
+
+/* a block, shared by the shards, with the index of each of its beacons */
+struct Batch {
+  dso::doris_rnx::DataBlock m_block;
+  std::vector<int> m_beacons;
+  /* beacons interned once the block was */
+  int m_num_beacons{0};
+}; /* struct Batch */
+
+using BatchQueue =
+    dso::doris_rnx::BoundedQueue<std::shared_ptr<const Batch>>;
+
+} /* unnamed namespace */
+
+dso::doris_rnx::BeaconIndex::BeaconIndex(const DorisRinexHeader &hdr) {
+  for (const auto &b : hdr.stations()) intern(b.code());
+}
+
+int dso::doris_rnx::BeaconIndex::intern(const char *id) {
+  const auto it = m_index.emplace(key(id), size());
+  if (it.second) {
+    m_ids.resize(m_ids.size() + 4, '\0');
+    std::memcpy(m_ids.data() + m_ids.size() - 4, id, 3);
+  }
+  return it.first->second;
+}
+
+dso::doris_rnx::BeaconShards::BeaconShards(const DorisRinexHeader &hdr,
+                                           int num_shards, handler h,
+                                           std::size_t queue_capacity)
+    : m_beacons(hdr), m_num_shards(num_shards), m_handler(std::move(h)),
+      m_capacity(queue_capacity ? queue_capacity : 1) {
+  if (num_shards <= 0)
+    throw std::runtime_error("[ERROR] Number of shards must be positive\n");
+}
+
+void dso::doris_rnx::BeaconShards::run(const Pipeline::source_fn &source) {
+  std::vector<std::unique_ptr<BatchQueue>> queues;
+  for (int s = 0; s < m_num_shards; s++)
+    queues.push_back(std::make_unique<BatchQueue>(m_capacity));
+  m_records.assign(m_num_shards, 0);
+
+  /* set once all blocks are dispatched */
+  std::atomic<bool> done{false};
+  std::atomic<bool> failed{false};
+  std::mutex error_mtx;
+  std::exception_ptr error;
+  auto fail = [&](std::exception_ptr e) {
+    std::lock_guard<std::mutex> lock(error_mtx);
+    if (!error) error = e;
+    failed.store(true, std::memory_order_release);
+  };
+
+  auto worker = [&](int s) {
+    BatchQueue &queue = *queues[s];
+    std::size_t records = 0;
+    try {
+      std::shared_ptr<const Batch> batch;
+      Backoff backoff;
+      for (;;) {
+        if (!queue.try_pop(batch)) {
+          if (failed.load(std::memory_order_acquire)) break;
+          if (!done.load(std::memory_order_acquire)) {
+            backoff.wait();
+            continue;
+          }
+          /* all dispatched; what is left is in the queue */
+          if (!queue.try_pop(batch)) break;
+        }
+        backoff.reset();
+        const auto &block = batch->m_block;
+        for (std::size_t i = 0; i < block.mbeacon_obs.size(); i++) {
+          const int beacon = batch->m_beacons[i];
+          if (shard(beacon) != s) continue;
+          m_handler(s, BeaconRecord{beacon, batch->m_num_beacons,
+                                    &block.mheader, &block.mbeacon_obs[i]});
+          ++records;
+        }
+        batch.reset();
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    m_records[s] = records;
+  };
+
+  /* beacons are interned from here on, until the workers are joined */
+  m_running = true;
+  std::vector<std::thread> threads;
+  try {
+    for (int s = 0; s < m_num_shards; s++) threads.emplace_back(worker, s);
+  } catch (...) {
+    fail(std::current_exception());
+  }
+
+  /* read and dispatch blocks, on this thread */
+  try {
+    std::vector<char> touched(m_num_shards);
+    for (;;) {
+      auto batch = std::make_shared<Batch>();
+      const int status = source(batch->m_block);
+      if (status < 0) break;
+      if (status > 0)
+        throw std::runtime_error(
+            "[ERROR] Shard source failed reading a data block\n");
+
+      std::fill(touched.begin(), touched.end(), 0);
+      for (const auto &bobs : batch->m_block.mbeacon_obs) {
+        const int beacon = m_beacons.intern(bobs.id());
+        batch->m_beacons.push_back(beacon);
+        touched[shard(beacon)] = 1;
+      }
+      batch->m_num_beacons = m_beacons.size();
+
+      std::shared_ptr<const Batch> shared(std::move(batch));
+      for (int s = 0; s < m_num_shards; s++) {
+        if (!touched[s]) continue;
+        auto item = shared;
+        Backoff backoff;
+        while (!queues[s]->try_push(item) &&
+               !failed.load(std::memory_order_acquire))
+          backoff.wait();
+      }
+      if (failed.load(std::memory_order_acquire)) break;
+    }
+  } catch (...) {
+    fail(std::current_exception());
+  }
+  done.store(true, std::memory_order_release);
+
+  for (auto &t : threads) t.join();
+  m_running = false;
+  if (error) std::rethrow_exception(error);
+}
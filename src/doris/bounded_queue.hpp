@@ -0,0 +1,113 @@
+#ifndef __DSO_DORIS_RINEX_BOUNDED_QUEUE_HPP__
+#define __DSO_DORIS_RINEX_BOUNDED_QUEUE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class BoundedQueue
+ *  @brief A lock-free, bounded, multi-producer multi-consumer queue (a ring
+ *         of cells tagged with sequence numbers, after D. Vyukov).
+ *
+ *  try_push/try_pop never block; a full queue makes try_push fail, which is
+ *  how backpressure is applied to producers. The capacity is rounded up to
+ *  a power of 2.
+ */
+template <typename T> class BoundedQueue {
+  struct Cell {
+    std::atomic<std::size_t> m_seq;
+    T m_data;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  std::size_t m_mask;
+  /* producers and consumers positions, on different cache lines */
+  alignas(64) std::atomic<std::size_t> m_tail{0};
+  alignas(64) std::atomic<std::size_t> m_head{0};
+
+ public:
+  explicit BoundedQueue(std::size_t capacity) {
+    std::size_t n = 2;
+    while (n < capacity) n <<= 1;
+    m_cells.reset(new Cell[n]);
+    m_mask = n - 1;
+    for (std::size_t i = 0; i < n; i++)
+      m_cells[i].m_seq.store(i, std::memory_order_relaxed);
+  }
+
+  std::size_t capacity() const noexcept { return m_mask + 1; }
+
+  /* @brief Add an item (moved from on success); false if full */
+  bool try_push(T &item) noexcept {
+    std::size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &c = m_cells[pos & m_mask];
+      const std::size_t seq = c.m_seq.load(std::memory_order_acquire);
+      const auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+      if (!diff) {
+        if (m_tail.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          c.m_data = std::move(item);
+          c.m_seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /* @brief Take the oldest item; false if empty */
+  bool try_pop(T &item) noexcept {
+    std::size_t pos = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &c = m_cells[pos & m_mask];
+      const std::size_t seq = c.m_seq.load(std::memory_order_acquire);
+      const auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+      if (!diff) {
+        if (m_head.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          item = std::move(c.m_data);
+          c.m_seq.store(pos + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+}; /* class BoundedQueue */
+
+/* Waiting on a queue: spin first, then yield, then sleep */
+class Backoff {
+  int m_count{0};
+
+ public:
+  void wait() noexcept {
+    if (m_count < 64) {
+      ++m_count;
+    } else if (m_count < 128) {
+      ++m_count;
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+  void reset() noexcept { m_count = 0; }
+}; /* class Backoff */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,489 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include "compact_rinex.hpp"
+#include "data_block.hpp"
+#include "diagnostics.hpp"
+#include "doris_rinex.hpp"
+#include "doris_rinex_compact.hpp"
+#include "record_offsets.hpp"
+
+namespace {
+
+constexpr const int MAX_RECORD_CHARS = dso::DorisObsRinex::MAX_RECORD_CHARS;
+
+/* width of an observation field (F14.3) plus its two flags */
+constexpr const int OBS_FIELD_CHARS = 16;
+
+/* width of a (full) data line */
+constexpr const int DATA_LINE_CHARS =
+    3 + dso::doris_rnx::MAX_OBS_PER_DATA_LINE * OBS_FIELD_CHARS;
+
+const char *skipws(const char *line, const char *end) noexcept {
+  while (line < end && *line == ' ') ++line;
+  return line;
+}
+
+/* Append to out the text difference of cur to prev (both considered padded
+ * with blanks); trailing blanks are dropped.
+ */
+void text_diff(const char *prev, std::size_t np, const char *cur,
+               std::size_t nc, std::string &out) {
+  const std::size_t start = out.size();
+  const std::size_t n = std::max(np, nc);
+  for (std::size_t i = 0; i < n; i++) {
+    const char p = (i < np) ? prev[i] : ' ';
+    const char c = (i < nc) ? cur[i] : ' ';
+    out.push_back((p == c) ? ' ' : ((c == ' ') ? '&' : c));
+  }
+  while (out.size() > start && out.back() == ' ') out.pop_back();
+}
+
+/* Apply a text difference to state (see text_diff) */
+void text_patch(std::string &state, const char *diff, std::size_t n) {
+  if (state.size() < n) state.resize(n, ' ');
+  for (std::size_t i = 0; i < n; i++) {
+    if (diff[i] != ' ') state[i] = (diff[i] == '&') ? ' ' : diff[i];
+  }
+}
+
+/* Resolve the epoch flag and number of stations off a record line */
+int record_flag_and_count(const char *line, std::size_t sz, int &flag,
+                          int &num_stations) noexcept {
+  char tbuf[4] = {'\0'};
+  if (sz < 37) return 1;
+  std::memcpy(tbuf, line + 31, 3);
+  auto cres = std::from_chars(skipws(tbuf, tbuf + 3), tbuf + 3, flag);
+  if (cres.ec != std::errc{}) return 1;
+  std::memcpy(tbuf, line + 34, 3);
+  cres = std::from_chars(skipws(tbuf, tbuf + 3), tbuf + 3, num_stations);
+  if (cres.ec != std::errc{}) return 1;
+  return 0;
+}
+
+/* Resolve an F14.3 field as an integer in 1e-3 units. A blank field is
+ * missing (present is set to false). Returns non-zero on error.
+ */
+int field_to_int(const char *field, std::int64_t &value,
+                 bool &present) noexcept {
+  const char *end = field + 14;
+  const char *s = skipws(field, end);
+  present = (s != end);
+  if (!present) return 0;
+
+  bool negative = (*s == '-');
+  if (negative || *s == '+') ++s;
+  std::int64_t v = 0;
+  int digits = 0, decimals = -1;
+  for (; s < end && *s != ' '; ++s) {
+    if (*s == '.' && decimals < 0) {
+      decimals = 0;
+    } else if (*s >= '0' && *s <= '9') {
+      v = v * 10 + (*s - '0');
+      ++digits;
+      if (decimals >= 0) ++decimals;
+    } else {
+      return 1;
+    }
+  }
+  /* only trailing blanks allowed */
+  if (skipws(s, end) != end || !digits || decimals > 3) return 1;
+  for (int i = (decimals < 0) ? 0 : decimals; i < 3; i++) v *= 10;
+  value = negative ? -v : v;
+  return 0;
+}
+
+/* Write an integer in 1e-3 units as an F14.3 field */
+void int_to_field(std::int64_t value, char *field) noexcept {
+  char buf[32];
+  const std::uint64_t a =
+      (value < 0) ? -(std::uint64_t)value : (std::uint64_t)value;
+  int n = std::snprintf(buf, sizeof(buf), "%s%llu.%03llu",
+                        (value < 0) ? "-" : "", (unsigned long long)(a / 1000),
+                        (unsigned long long)(a % 1000));
+  if (n > 14) n = 14;
+  std::memset(field, ' ', 14 - n);
+  std::memcpy(field + 14 - n, buf, n);
+}
+
+/* Number of observables off a SYS / # / OBS TYPES line */
+int num_obs_types(const char *line) noexcept {
+  int num = 0;
+  auto cres = std::from_chars(skipws(line + 1, line + 60), line + 60, num);
+  return (cres.ec != std::errc{} || num < 1 || num >= 13) ? -1 : num;
+}
+
+/* Number of data lines holding the observables of a beacon */
+int lines_per_beacon(int num_obs) noexcept {
+  return (num_obs + dso::doris_rnx::MAX_OBS_PER_DATA_LINE - 1) /
+         dso::doris_rnx::MAX_OBS_PER_DATA_LINE;
+}
+
+} /* unnamed namespace */
+
+int dso::doris_rnx::CompactDecoder::read_epoch(std::istream &is) noexcept {
+  if (!std::getline(is, m_line)) {
+    if (is.eof()) return -1;
+    diagnose<DiagLevel::error>(diag::COMPACT_READ_LINE, __func__, nullptr, is,
+                               0);
+    return 1;
+  }
+
+  /* restore the record line */
+  if (m_line[0] == '>') {
+    m_record_line = m_line;
+  } else if (m_line[0] == '&' && !m_record_line.empty()) {
+    text_patch(m_record_line, m_line.data(), m_line.size());
+    m_record_line[0] = '>';
+  } else {
+    diagnose<DiagLevel::error>(diag::COMPACT_EXPECTED_RECORD, __func__,
+                               m_line.c_str(), is, m_line.size() + 1);
+    return 1;
+  }
+
+  int flag, num_stations;
+  if (record_flag_and_count(m_record_line.data(), m_record_line.size(), flag,
+                            num_stations)) {
+    diagnose<DiagLevel::error>(diag::COMPACT_RECORD_LINE, __func__,
+                               m_record_line.c_str(), is, m_line.size() + 1);
+    return 1;
+  }
+  m_header.m_flag = flag;
+  m_header.m_num_stations = num_stations;
+
+  /* special event; the following lines are stored verbatim */
+  if (flag > 1) {
+    m_event_lines.resize(num_stations);
+    for (int i = 0; i < num_stations; i++) {
+      if (!std::getline(is, m_event_lines[i])) {
+        diagnose<DiagLevel::error>(diag::DATA_BLOCK_TRUNCATED, __func__,
+                                   m_record_line.c_str());
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  /* resolve the record line as the RINEX parser does */
+  char line[MAX_RECORD_CHARS] = {'\0'};
+  std::memcpy(line, m_record_line.data(),
+              std::min<std::size_t>(m_record_line.size(), MAX_RECORD_CHARS - 1));
+  if (resolve_block_epoch(line, m_header)) {
+    diagnose<DiagLevel::error>(diag::DATA_BLOCK_HEADER, __func__, line, is,
+                               m_line.size() + 1);
+    return 1;
+  }
+
+  ++m_epoch_count;
+  if ((int)m_records.size() < num_stations) m_records.resize(num_stations);
+
+  for (int beacon = 0; beacon < num_stations; beacon++) {
+    if (!std::getline(is, m_line) || m_line.size() < 3 || m_line[0] != 'D') {
+      diagnose<DiagLevel::error>(diag::COMPACT_EXPECTED_BEACON, __func__,
+                                 m_line.c_str(), is, m_line.size() + 1);
+      return 1;
+    }
+
+    auto &rec = m_records[beacon];
+    std::memcpy(rec.m_id, m_line.data(), 3);
+    rec.m_values.resize(m_num_obs);
+    rec.m_present.resize(m_num_obs);
+
+    /* beacons not observed in the previous epoch start anew */
+    auto &state = m_beacons[compact_beacon_key(rec.m_id)];
+    if (state.m_last_epoch != m_epoch_count - 1) state.reset(m_num_obs);
+    state.m_last_epoch = m_epoch_count;
+
+    const char *p = m_line.data() + 3;
+    const char *end = m_line.data() + m_line.size();
+    for (int k = 0; k < m_num_obs; k++) {
+      /* tokens are separated by a single blank; missing trailing tokens are
+       * empty
+       */
+      if (p < end) ++p;
+      const char *tok = p;
+      while (p < end && *p != ' ') ++p;
+
+      auto &arc = state.m_arcs[k];
+      std::int64_t v;
+      if (tok == p) {
+        arc.clear();
+        rec.m_present[k] = 0;
+        continue;
+      }
+      if (p - tok > 2 && tok[1] == '&') {
+        auto cres = std::from_chars(tok + 2, p, v);
+        if (cres.ec != std::errc{} || cres.ptr != p || tok[0] < '0' ||
+            tok[0] > '0' + COMPACT_MAX_DIFF_ORDER) {
+          diagnose<DiagLevel::error>(diag::COMPACT_ARC_TOKEN, __func__,
+                                     m_line.c_str(), is, m_line.size() + 1);
+          return 2;
+        }
+        arc.start(v, tok[0] - '0');
+      } else {
+        auto cres = std::from_chars(tok, p, v);
+        if (cres.ec != std::errc{} || cres.ptr != p || !arc.active()) {
+          diagnose<DiagLevel::error>(diag::COMPACT_DIFF_TOKEN, __func__,
+                                     m_line.c_str(), is, m_line.size() + 1);
+          return 2;
+        }
+        v = arc.decode(v);
+      }
+      rec.m_values[k] = v;
+      rec.m_present[k] = 1;
+    }
+
+    /* what remains (after a blank) is the text difference of the flags */
+    if (p < end) {
+      ++p;
+      const std::size_t n =
+          std::min<std::size_t>(end - p, state.m_flags.size());
+      text_patch(state.m_flags, p, n);
+    }
+    rec.m_flags = state.m_flags;
+  }
+
+  return 0;
+}
+
+int dso::doris_rnx::CompactDecoder::read_data_block(
+    std::istream &is, const dso::DorisRinexHeader &hdr,
+    dso::doris_rnx::DataBlock &block) noexcept {
+  /* special events (their special records are read off by read_epoch): as
+   * for RINEX, return the event as a block without observations if it has
+   * an epoch, else move on to the next block
+   */
+  int status;
+  while (!(status = read_epoch(is)) && m_header.m_flag > 1) {
+    Datetime<nanoseconds> epoch;
+    if (epoch_of_record_line(m_record_line.c_str(), epoch)) continue;
+    char line[MAX_RECORD_CHARS] = {'\0'};
+    std::memcpy(line, m_record_line.data(),
+                std::min<std::size_t>(m_record_line.size(),
+                                      MAX_RECORD_CHARS - 1));
+    if (resolve_block_epoch(line, block.mheader)) {
+      diagnose<DiagLevel::error>(diag::DATA_BLOCK_HEADER, __func__, line);
+      return 1;
+    }
+    block.mcolumns = hdr.obs_columns();
+    block.mbeacon_obs.clear();
+    return 0;
+  }
+  if (status) return status;
+
+  const auto &obs_scale_factors = hdr.obs_scale_factors();
+  block.mheader = m_header;
+  block.mcolumns = hdr.obs_columns();
+  block.mbeacon_obs.clear();
+  block.mbeacon_obs.reserve(m_header.m_num_stations);
+
+  for (int beacon = 0; beacon < m_header.m_num_stations; beacon++) {
+    const auto &rec = m_records[beacon];
+    block.mbeacon_obs.emplace_back(dso::doris_rnx::BeaconObservations{});
+    auto it = block.mbeacon_obs.end() - 1;
+    std::memcpy(it->m_beacon_id, rec.m_id, 3);
+    for (int k = 0; k < m_num_obs; k++) {
+      /* same arithmetic as the RINEX parser, to get identical values */
+      double val = rec.m_present[k] ? rec.m_values[k] / COMPACT_VALUE_UNIT
+                                    : OBSERVATION_VALUE_MISSING;
+      val /= obs_scale_factors[k];
+      it->m_values.emplace_back(val, rec.m_flags[2 * k],
+                                rec.m_flags[2 * k + 1]);
+    }
+  }
+
+  return 0;
+}
+
+int dso::doris_rnx::rinex_to_compact(std::istream &rnx,
+                                     std::ostream &crx) noexcept {
+  char line[MAX_RECORD_CHARS];
+
+  /* header; prepend the CRINEX lines and copy as is */
+  if (!rnx.getline(line, MAX_RECORD_CHARS) ||
+      std::strncmp(line + 60, "RINEX VERSION / TYPE", 20))
+    return 10;
+  char date[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y%m%d %H%M%S UTC", std::gmtime(&now));
+  char crx_line[MAX_RECORD_CHARS];
+  std::snprintf(crx_line, sizeof(crx_line), "%-20s%-40s%-20s", "1.0",
+                "COMPACT DORIS RINEX FORMAT", "CRINEX VERS   / TYPE");
+  crx << crx_line << '\n';
+  std::snprintf(crx_line, sizeof(crx_line), "%-20s%-40s%-20s", "rnx", date,
+                "CRINEX PROG / DATE");
+  crx << crx_line << '\n' << line << '\n';
+
+  int num_obs = -1;
+  bool eoh = false;
+  while (!eoh && rnx.getline(line, MAX_RECORD_CHARS)) {
+    crx << line << '\n';
+    if (!std::strncmp(line + 60, "SYS / # / OBS TYPES", 19)) {
+      num_obs = num_obs_types(line);
+    } else if (!std::strncmp(line + 60, "END OF HEADER", 13)) {
+      eoh = true;
+    }
+  }
+  if (!eoh || num_obs < 0) return 20;
+  const int lpb = lines_per_beacon(num_obs);
+
+  std::unordered_map<std::uint32_t, CompactBeaconState> beacons;
+  std::string prev_record;
+  std::string out;
+  std::string flags(2 * num_obs, ' ');
+  std::vector<std::string> data_lines(lpb);
+  long epoch_count = 0;
+  char tok[32];
+
+  while (rnx.getline(line, MAX_RECORD_CHARS)) {
+    const std::size_t sz = std::strlen(line);
+    int flag, num_stations;
+    if (*line != '>' || record_flag_and_count(line, sz, flag, num_stations)) {
+      diagnose<DiagLevel::error>(diag::COMPACT_EXPECTED_RECORD, __func__,
+                                 line, rnx, rnx.gcount());
+      return 30;
+    }
+
+    /* special event; copy record and following lines as is */
+    if (flag > 1) {
+      crx << line << '\n';
+      for (int i = 0; i < num_stations; i++) {
+        if (!rnx.getline(line, MAX_RECORD_CHARS)) return 31;
+        crx << line << '\n';
+      }
+      prev_record.clear();
+      continue;
+    }
+
+    /* the record line, in full or as a difference */
+    if (prev_record.empty()) {
+      crx << line << '\n';
+    } else {
+      out.assign(1, '&');
+      text_diff(prev_record.data() + 1, prev_record.size() - 1, line + 1,
+                sz - 1, out);
+      crx << out << '\n';
+    }
+    prev_record.assign(line, sz);
+    ++epoch_count;
+
+    for (int beacon = 0; beacon < num_stations; beacon++) {
+      for (int l = 0; l < lpb; l++) {
+        if (!rnx.getline(line, MAX_RECORD_CHARS)) return 32;
+        data_lines[l].assign(line);
+        data_lines[l].resize(DATA_LINE_CHARS, ' ');
+      }
+      const char *id = data_lines[0].data();
+      if (*id != 'D') return 33;
+
+      auto &state = beacons[compact_beacon_key(id)];
+      if (state.m_last_epoch != epoch_count - 1) state.reset(num_obs);
+      state.m_last_epoch = epoch_count;
+
+      out.assign(id, 3);
+      for (int k = 0; k < num_obs; k++) {
+        const char *field =
+            data_lines[k / MAX_OBS_PER_DATA_LINE].data() + 3 +
+            (k % MAX_OBS_PER_DATA_LINE) * OBS_FIELD_CHARS;
+        flags[2 * k] = field[14];
+        flags[2 * k + 1] = field[15];
+
+        std::int64_t v = 0;
+        bool present;
+        if (field_to_int(field, v, present)) {
+          diagnose<DiagLevel::error>(diag::COMPACT_VALUE, __func__,
+                                     data_lines[k / MAX_OBS_PER_DATA_LINE]
+                                         .c_str());
+          return 34;
+        }
+        out.push_back(' ');
+        auto &arc = state.m_arcs[k];
+        if (!present) {
+          arc.clear();
+          continue;
+        }
+        if (arc.active()) {
+          out.append(tok, std::to_chars(tok, tok + sizeof(tok),
+                                        arc.encode(v)).ptr);
+        } else {
+          arc.start(v, COMPACT_MAX_DIFF_ORDER);
+          out.push_back('0' + COMPACT_MAX_DIFF_ORDER);
+          out.push_back('&');
+          out.append(tok, std::to_chars(tok, tok + sizeof(tok), v).ptr);
+        }
+      }
+
+      /* flags, as text difference */
+      out.push_back(' ');
+      text_diff(state.m_flags.data(), state.m_flags.size(), flags.data(),
+                flags.size(), out);
+      state.m_flags = flags;
+      while (out.back() == ' ') out.pop_back();
+      crx << out << '\n';
+    }
+  }
+
+  return crx.good() ? 0 : 1;
+}
+
+int dso::doris_rnx::compact_to_rinex(std::istream &crx,
+                                     std::ostream &rnx) noexcept {
+  char line[MAX_RECORD_CHARS];
+
+  /* header; drop the CRINEX lines and copy the rest as is */
+  if (!crx.getline(line, MAX_RECORD_CHARS) ||
+      std::strncmp(line + 60, "CRINEX VERS   / TYPE", 20))
+    return 10;
+  if (!crx.getline(line, MAX_RECORD_CHARS) ||
+      std::strncmp(line + 60, "CRINEX PROG / DATE", 18))
+    return 11;
+
+  int num_obs = -1;
+  bool eoh = false;
+  while (!eoh && crx.getline(line, MAX_RECORD_CHARS)) {
+    rnx << line << '\n';
+    if (!std::strncmp(line + 60, "SYS / # / OBS TYPES", 19)) {
+      num_obs = num_obs_types(line);
+    } else if (!std::strncmp(line + 60, "END OF HEADER", 13)) {
+      eoh = true;
+    }
+  }
+  if (!eoh || num_obs < 0) return 20;
+  const int lpb = lines_per_beacon(num_obs);
+
+  CompactDecoder decoder(num_obs);
+  int status;
+  while (!(status = decoder.read_epoch(crx))) {
+    std::string &record = decoder.m_record_line;
+    while (record.size() > 1 && record.back() == ' ') record.pop_back();
+    rnx << record << '\n';
+
+    if (decoder.m_header.m_flag > 1) {
+      for (const auto &l : decoder.m_event_lines) rnx << l << '\n';
+      continue;
+    }
+
+    for (int beacon = 0; beacon < decoder.m_header.m_num_stations; beacon++) {
+      const auto &rec = decoder.m_records[beacon];
+      for (int l = 0; l < lpb; l++) {
+        std::memset(line, ' ', DATA_LINE_CHARS);
+        if (!l) std::memcpy(line, rec.m_id, 3);
+        const int first = l * MAX_OBS_PER_DATA_LINE;
+        const int last = std::min(first + MAX_OBS_PER_DATA_LINE, num_obs);
+        for (int k = first; k < last; k++) {
+          char *field = line + 3 + (k - first) * OBS_FIELD_CHARS;
+          if (rec.m_present[k]) int_to_field(rec.m_values[k], field);
+          field[14] = rec.m_flags[2 * k];
+          field[15] = rec.m_flags[2 * k + 1];
+        }
+        rnx.write(line, 3 + (last - first) * OBS_FIELD_CHARS);
+        rnx << '\n';
+      }
+    }
+  }
+
+  return (status < 0 && rnx.good()) ? 0 : status;
+}
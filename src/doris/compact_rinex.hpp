@@ -0,0 +1,154 @@
+#ifndef __DSO_DORIS_RINEX_COMPACT_DECODER_HPP__
+#define __DSO_DORIS_RINEX_COMPACT_DECODER_HPP__
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Max order of differences written in compact RINEX */
+static constexpr int COMPACT_MAX_DIFF_ORDER = 3;
+
+/* Observation values are differenced in units of 1e-3 (i.e. F14.3) */
+static constexpr double COMPACT_VALUE_UNIT = 1e3;
+
+/** Differencing state of one observable (of one beacon), shared by the
+ *  encoder and the decoder. Values are integers (i.e. in 1e-3 units).
+ */
+struct CompactArc {
+  /* the last value and its differences, of order 1 to m_order */
+  std::int64_t m_diff[COMPACT_MAX_DIFF_ORDER + 1];
+  /* current order of differences; -1 if no arc is active */
+  int m_order{-1};
+  /* max order of differences for this arc */
+  int m_max_order{COMPACT_MAX_DIFF_ORDER};
+
+  bool active() const noexcept { return m_order >= 0; }
+  void clear() noexcept { m_order = -1; }
+
+  /* @brief Start a new arc of max order n, with value v */
+  void start(std::int64_t v, int n) noexcept {
+    m_diff[0] = v;
+    m_order = 0;
+    m_max_order = n;
+  }
+
+  /* @brief Add value v to the (active) arc; returns the difference to write */
+  std::int64_t encode(std::int64_t v) noexcept {
+    const int k = (m_order < m_max_order) ? m_order + 1 : m_max_order;
+    std::int64_t cur = v;
+    for (int j = 0; j < k; j++) {
+      const std::int64_t next = cur - m_diff[j];
+      m_diff[j] = cur;
+      cur = next;
+    }
+    m_diff[k] = cur;
+    m_order = k;
+    return cur;
+  }
+
+  /* @brief Add difference d to the (active) arc; returns the value */
+  std::int64_t decode(std::int64_t d) noexcept {
+    const int k = (m_order < m_max_order) ? m_order + 1 : m_max_order;
+    m_diff[k] = d;
+    for (int j = k - 1; j >= 0; j--) m_diff[j] += m_diff[j + 1];
+    m_order = k;
+    return m_diff[0];
+  }
+}; /* struct CompactArc */
+
+/* Differencing state of a beacon */
+struct CompactBeaconState {
+  /* index of the last epoch the beacon was seen in */
+  long m_last_epoch{-2};
+  /* one arc per observable */
+  std::vector<CompactArc> m_arcs;
+  /* the (2 per observable) flags of the last epoch */
+  std::string m_flags;
+
+  void reset(int num_obs) {
+    m_arcs.assign(num_obs, CompactArc{});
+    m_flags.assign(2 * num_obs, ' ');
+  }
+}; /* struct CompactBeaconState */
+
+/* Beacons are keyed by their 3-char id */
+inline std::uint32_t compact_beacon_key(const char *id) noexcept {
+  return (std::uint32_t)(unsigned char)id[0] << 16 |
+         (std::uint32_t)(unsigned char)id[1] << 8 |
+         (std::uint32_t)(unsigned char)id[2];
+}
+
+/* A beacon record, as decoded off a compact RINEX data block */
+struct CompactBeaconRecord {
+  char m_id[4] = {'\0'};
+  /* values in 1e-3 units; valid only if m_present is set */
+  std::vector<std::int64_t> m_values;
+  std::vector<char> m_present;
+  /* flags (2 per observable) */
+  std::string m_flags;
+}; /* struct CompactBeaconRecord */
+
+/** @class CompactDecoder
+ *  @brief Incremental decoder of compact RINEX data blocks; each call to
+ *         read_epoch() decodes the next data block (and only that).
+ *
+ *  The decoder is stateful, i.e. blocks must be read in order, starting from
+ *  the first block after the header (call reset() when rewinding).
+ */
+class CompactDecoder {
+  int m_num_obs;
+  /* per-beacon differencing state */
+  std::unordered_map<std::uint32_t, CompactBeaconState> m_beacons;
+  /* number of (non-event) epochs decoded */
+  long m_epoch_count{0};
+  /* buffer for the current line */
+  std::string m_line;
+
+ public:
+  /* the (restored) record line of the last block */
+  std::string m_record_line;
+  /* the resolved record line of the last block */
+  RinexDataRecordHeader m_header;
+  /* the beacon records of the last block (only first m_header.m_num_stations
+   * are valid), unless it is a special event
+   */
+  std::vector<CompactBeaconRecord> m_records;
+  /* the lines following a special event record (flag > 1) */
+  std::vector<std::string> m_event_lines;
+
+  explicit CompactDecoder(int num_obs) : m_num_obs(num_obs) {}
+
+  /* @brief Forget all state; next block read must be the first one */
+  void reset() noexcept {
+    m_beacons.clear();
+    m_epoch_count = 0;
+    m_record_line.clear();
+  }
+
+  /** @brief Decode the next data block off the stream.
+   *  @return < 0 at EOF, 0 on success, > 0 on error
+   */
+  int read_epoch(std::istream &is) noexcept;
+
+  /** @brief Decode the next data block off the stream, and store it in
+   *         block, exactly as read_data_block() would for the equivalent
+   *         RINEX file.
+   *  @return < 0 at EOF, 0 on success, > 0 on error
+   */
+  int read_data_block(std::istream &is, const DorisRinexHeader &hdr,
+                      DataBlock &block) noexcept;
+}; /* class CompactDecoder */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __DSO_DORIS_RINEX_DATA_BLOCK_HPP__
+#define __DSO_DORIS_RINEX_DATA_BLOCK_HPP__
+
+#include <istream>
+
+#include "doris_rinex_details.hpp"
+#include "doris_rinex_header.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @brief Resolve a record line (i.e. starting with '>') and store the
+ *         epoch, epoch flag, number of stations and clock offset in hdr.
+ *  @return Anything other than 0 denotes an error.
+ */
+int resolve_block_epoch(const char *line, RinexDataRecordHeader &hdr) noexcept;
+
+/** @brief If line is the record line of a special event (i.e. epoch flag
+ *         > 1), get the number of special records (e.g. header lines) that
+ *         follow it, instead of observations.
+ *  @return The number of special records, or -1 if line is not the record
+ *          line of a special event.
+ */
+int special_event_lines(const char *line) noexcept;
+
+/** @brief Read the next data block off a stream and store it in block.
+ *
+ *  The stream should be placed at the start of a data block (i.e. next line
+ *  to be read is a record line, starting with '>'). The stream is only read,
+ *  and the header is only used to resolve the observables; hence, different
+ *  streams can be read concurrently using the same header.
+ *
+ *  Special event records (epoch flag > 1) are followed by special records
+ *  (e.g. header lines) instead of observations; if the event has an epoch,
+ *  it is returned as a block without observations, else it is skipped.
+ *
+ *  @param[in]  is    The input stream
+ *  @param[in]  hdr   The header of the RINEX file the stream is reading
+ *  @param[out] block The data block read
+ *  @return An int denoting:
+ *    < 0 : EOF encountered; block is invalid
+ *    = 0 : All ok, data collected and stored in block
+ *    > 0 : Error, failed to collect next block; block is invalid
+ */
+int read_data_block(std::istream &is, const DorisRinexHeader &hdr,
+                    DataBlock &block) noexcept;
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
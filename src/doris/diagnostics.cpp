@@ -0,0 +1,138 @@
+#include <atomic>
+#include <cstdio>
+
+#include "diagnostics.hpp"
+
+namespace {
+
+/* the installed sink and its data; set together, before reading */
+std::atomic<dso::doris_rnx::diagnostics_sink> sink{
+    &dso::doris_rnx::stderr_sink};
+std::atomic<void *> sink_data{nullptr};
+
+/* header field (label) by error code, i.e. code/10 */
+const char *header_field(int code) noexcept {
+  static const char *const labels[] = {
+      nullptr,                /*  0 */
+      "RINEX VERSION / TYPE", /* 10 */
+      "PGM / RUN BY / DATE",  /* 20 */
+      "SATELLITE NAME",       /* 30 */
+      "COSPAR NUMBER",        /* 40 */
+      "MARKER TYPE",          /* 50 */
+      nullptr,                /* 60 */
+      "REC # / TYPE / VERS",  /* 70 */
+      "ANT # / TYPE",         /* 80 */
+      "APPROX POSITION XYZ",  /* 90 */
+      "CENTER OF MASS: XYZ",  /* 100 */
+      "SYS / # / OBS TYPES",  /* 110 */
+      "TIME OF FIRST OBS",    /* 120 */
+      "SYS / DCBS APPLIED",   /* 130 */
+      "SYS / SCALE FACTOR",   /* 140 */
+      "L2 / L1 DATE OFFSET",  /* 150 */
+      "# OF STATIONS",        /* 160 */
+      "STATION REFERENCE",    /* 170 */
+      "# TIME REF STATIONS",  /* 180 */
+      "TIME REF STATION",     /* 190 */
+      "TIME REF STAT DATE",   /* 200 */
+      "RCV CLOCK OFFS APPL",  /* 210 */
+  };
+  const int i = code / 10;
+  return (i < (int)(sizeof(labels) / sizeof(labels[0]))) ? labels[i]
+                                                         : nullptr;
+}
+
+const char *level_tag(dso::doris_rnx::DiagLevel level) noexcept {
+  switch (level) {
+    case dso::doris_rnx::DiagLevel::debug:
+      return "[DEBUG]";
+    case dso::doris_rnx::DiagLevel::info:
+      return "[INFO ]";
+    case dso::doris_rnx::DiagLevel::warning:
+      return "[WRNNG]";
+    default:
+      return "[ERROR]";
+  }
+}
+
+} /* unnamed namespace */
+
+void dso::doris_rnx::set_diagnostics_sink(diagnostics_sink s,
+                                          void *data) noexcept {
+  sink_data = data;
+  sink = s;
+}
+
+void dso::doris_rnx::report(const Diagnostic &d) noexcept {
+  if (const auto s = sink.load()) s(d, sink_data.load());
+}
+
+const char *dso::doris_rnx::diagnostic_message(int code) noexcept {
+  namespace diag = dso::doris_rnx::diag;
+  switch (code) {
+    case diag::HEADER_LINE_IGNORED:
+      return "Ignoring header line";
+    case diag::HEADER_READ_FAILED:
+      return "Failed reading RINEX header";
+    case diag::HEADER_TIME_REF_STATION_UNKNOWN:
+      return "Failed matching 'TIME REF STATION' to list of beacons";
+    case diag::DATA_READ_LINE:
+    case diag::COMPACT_READ_LINE:
+      return "Failed reading line from stream";
+    case diag::DATA_RECORD_EPOCH:
+      return "Failed resolving date for observation block";
+    case diag::DATA_RECORD_FLAG:
+      return "Failed resolving epoch flag";
+    case diag::DATA_RECORD_NUM_STATIONS:
+      return "Failed resolving #stations";
+    case diag::DATA_RECORD_CLOCK_OFFSET:
+      return "Failed resolving clock offset";
+    case diag::DATA_RECORD_CLOCK_FLAG:
+      return "Failed resolving clock flag";
+    case diag::DATA_BLOCK_HEADER:
+      return "Failed reading data block header";
+    case diag::DATA_BLOCK_TRUNCATED:
+      return "Data block truncated";
+    case diag::DATA_EXPECTED_BEACON:
+    case diag::COMPACT_EXPECTED_BEACON:
+      return "Expected line to start with new beacon, found something else "
+             "instead";
+    case diag::DATA_OBSERVATION_VALUE:
+      return "Failed resolving observation value";
+    case diag::DATA_INVALID_BLOCK:
+      return "Invalid data block";
+    case diag::DATA_SOURCE_FAILED:
+      return "Input source failed (e.g. corrupt compressed data)";
+    case diag::COMPACT_EXPECTED_RECORD:
+      return "Expected record line, found something else instead";
+    case diag::COMPACT_RECORD_LINE:
+      return "Failed resolving record line";
+    case diag::COMPACT_ARC_TOKEN:
+      return "Invalid arc token";
+    case diag::COMPACT_DIFF_TOKEN:
+      return "Invalid difference token";
+    case diag::COMPACT_SPECIAL_EVENT:
+      return "Special event record in data";
+    case diag::COMPACT_VALUE:
+      return "Cannot difference value";
+    default:
+      break;
+  }
+  if (code >= 10 && code < 300) {
+    if (const char *label = header_field(code))
+      return label;
+  }
+  return "Unknown error";
+}
+
+void dso::doris_rnx::stderr_sink(const Diagnostic &d, void *) noexcept {
+  const char *msg = diagnostic_message(d.m_code);
+  const bool is_field = (d.m_code >= 10 && d.m_code < 300 &&
+                         d.m_code != diag::HEADER_TIME_REF_STATION_UNKNOWN);
+  fprintf(stderr, "%s %s%s, code=%d", level_tag(d.m_level),
+          is_field ? "Error while reading RINEX header field " : "", msg,
+          d.m_code);
+  if (d.m_line >= 0) fprintf(stderr, ", line=%ld", d.m_line);
+  if (d.m_offset >= 0) fprintf(stderr, ", offset=%lld", (long long)d.m_offset);
+  if (d.m_text) fprintf(stderr, " [%s]", d.m_text);
+  fprintf(stderr, " (traceback: %s)\n", d.m_func ? d.m_func : "");
+}
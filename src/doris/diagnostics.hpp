@@ -0,0 +1,55 @@
+#ifndef __DSO_DORIS_RINEX_DIAGNOSTICS_INTERNAL_HPP__
+#define __DSO_DORIS_RINEX_DIAGNOSTICS_INTERNAL_HPP__
+
+#include <cstdint>
+#include <istream>
+
+#include "doris_rinex_diagnostics.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* @brief Hand a diagnostic to the installed sink */
+void report(const Diagnostic &d) noexcept;
+
+/** @brief Report a diagnostic of level L. Levels below DIAG_MIN_LEVEL are
+ *         discarded at compile time (the call compiles to nothing).
+ *
+ *  @param[in] code   Numeric code (see namespace diag)
+ *  @param[in] func   Reporting function (i.e. __func__)
+ *  @param[in] text   The offending line or field, or null
+ *  @param[in] line   Line number in the file, or -1 if unknown
+ *  @param[in] offset Offset of the line in the file, or -1 if unknown
+ */
+template <DiagLevel L>
+inline void diagnose(int code, const char *func, const char *text = nullptr,
+                     long line = -1, std::int64_t offset = -1) noexcept {
+  if constexpr (static_cast<int>(L) >= DIAG_MIN_LEVEL)
+    report(Diagnostic{L, code, func, line, offset, text});
+}
+
+/** @brief As above, for a line just read off is (consumed characters,
+ *         including the newline); the offset of the line is resolved off the
+ *         current position of the stream, only if the level is enabled.
+ */
+template <DiagLevel L>
+inline void diagnose(int code, const char *func, const char *text,
+                     std::istream &is, std::streamsize consumed,
+                     long line = -1) noexcept {
+  if constexpr (static_cast<int>(L) >= DIAG_MIN_LEVEL) {
+    /* the stream may be in a failed state; ask its buffer */
+    std::int64_t offset = -1;
+    if (is.rdbuf()) {
+      const std::streamoff pos =
+          is.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+      if (pos >= consumed) offset = pos - consumed;
+    }
+    report(Diagnostic{L, code, func, line, offset, text});
+  }
+}
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,217 @@
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "doris_rinex_watch.hpp"
+
+namespace {
+
+/* events marking a file as complete */
+constexpr std::uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+/* Bounded queue of incoming files, from the watcher to the workers */
+class PathQueue {
+  std::mutex m_mtx;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::deque<std::string> m_paths;
+  std::size_t m_capacity;
+  bool m_closed{false};
+
+ public:
+  explicit PathQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+  /* wait until there is room; gives up (returning false) if stopped is set
+   * meanwhile, since then nobody may be waking us up
+   */
+  bool push(std::string path, const std::atomic<bool> &stopped) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (m_paths.size() >= m_capacity) {
+      if (stopped) return false;
+      m_not_full.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    m_paths.push_back(std::move(path));
+    m_not_empty.notify_one();
+    return true;
+  }
+
+  /* false when the queue is closed and empty */
+  bool pop(std::string &path) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_not_empty.wait(lock, [this] { return !m_paths.empty() || m_closed; });
+    if (m_paths.empty()) return false;
+    path = std::move(m_paths.front());
+    m_paths.pop_front();
+    m_not_full.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_closed = true;
+    m_not_empty.notify_all();
+  }
+}; /* class PathQueue */
+
+/* Strip a trailing .Z or .gz (compressed files) off name */
+std::size_t uncompressed_length(const char *name) noexcept {
+  const std::size_t len = std::strlen(name);
+  if (len > 2 && !std::strcmp(name + len - 2, ".Z")) return len - 2;
+  if (len > 3 && !std::strcmp(name + len - 3, ".gz")) return len - 3;
+  return len;
+}
+
+} /* unnamed namespace */
+
+dso::doris_rnx::DirectoryWatcher::DirectoryWatcher(
+    const std::vector<std::string> &dirs, watch_handler handler,
+    const WatchOptions &opts)
+    : m_dirs(dirs), m_handler(std::move(handler)), m_opts(opts) {
+  /* the destructor does not run if we throw; close descriptors here */
+  auto fail = [this](const std::string &msg) {
+    if (m_inotify >= 0) ::close(m_inotify);
+    if (m_wake >= 0) ::close(m_wake);
+    throw std::runtime_error(msg);
+  };
+
+  m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  m_wake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_inotify < 0 || m_wake < 0)
+    fail("[ERROR] Failed initializing inotify to watch directories\n");
+  for (std::size_t i = 0; i < m_dirs.size(); i++) {
+    const int wd = ::inotify_add_watch(m_inotify, m_dirs[i].c_str(),
+                                       WATCH_EVENTS | IN_ONLYDIR);
+    if (wd < 0) fail("[ERROR] Failed watching directory " + m_dirs[i] + "\n");
+    m_watches[wd] = i;
+  }
+
+  /* list files already there; any file written from now on is caught by
+   * the watches
+   */
+  if (m_opts.m_scan_existing) {
+    for (const auto &dir : m_dirs) {
+      DIR *d = ::opendir(dir.c_str());
+      if (!d) continue;
+      while (const dirent *e = ::readdir(d)) {
+        if (e->d_type != DT_REG && e->d_type != DT_UNKNOWN) continue;
+        if (matches(e->d_name)) m_existing.push_back(dir + "/" + e->d_name);
+      }
+      ::closedir(d);
+    }
+  }
+}
+
+dso::doris_rnx::DirectoryWatcher::~DirectoryWatcher() noexcept {
+  ::close(m_inotify);
+  ::close(m_wake);
+}
+
+bool dso::doris_rnx::DirectoryWatcher::matches(
+    const char *name) const noexcept {
+  const std::size_t len = uncompressed_length(name);
+  return std::any_of(m_opts.m_suffixes.cbegin(), m_opts.m_suffixes.cend(),
+                     [=](const std::string &s) {
+                       return len >= s.size() &&
+                              !std::strncmp(name + len - s.size(), s.c_str(),
+                                            s.size());
+                     });
+}
+
+int dso::doris_rnx::DirectoryWatcher::run() {
+  const int num_threads =
+      m_opts.m_num_threads > 0
+          ? m_opts.m_num_threads
+          : std::max(1, (int)std::thread::hardware_concurrency());
+  const long failed_before = m_failed;
+  PathQueue queue(std::max(1, m_opts.m_max_pending));
+
+  /* workers: parse incoming files and call the handler */
+  std::vector<std::thread> workers;
+  for (int t = 0; t < num_threads; t++) {
+    workers.emplace_back([&] {
+      std::string path;
+      while (queue.pop(path)) {
+        try {
+          DorisObsRinex rnx(path.c_str());
+          if (!rnx.header_ok())
+            throw std::runtime_error("[ERROR] Cannot read RINEX header\n");
+          m_handler(path, rnx);
+        } catch (std::exception &e) {
+          fprintf(stderr, "[ERROR] Failed processing file %s (what: %s)\n",
+                  path.c_str(), e.what());
+          ++m_failed;
+        } catch (...) {
+          fprintf(stderr, "[ERROR] Failed processing file %s\n", path.c_str());
+          ++m_failed;
+        }
+        ++m_processed;
+      }
+    });
+  }
+
+  /* files already there at construction */
+  for (auto &path : m_existing) queue.push(std::move(path), m_stopped);
+  m_existing.clear();
+
+  /* watch (on this thread) */
+  struct pollfd fds[2];
+  fds[0].fd = m_wake;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_inotify;
+  fds[1].events = POLLIN;
+  alignas(struct inotify_event) char buf[16 * 1024];
+  while (!m_stopped) {
+    fds[0].revents = fds[1].revents = 0;
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "[ERROR] Failed polling inotify (traceback: %s)\n",
+              __func__);
+      break;
+    }
+    if (fds[0].revents) break;
+
+    ssize_t n;
+    while ((n = ::read(m_inotify, buf, sizeof(buf))) > 0) {
+      for (char *p = buf; p < buf + n;) {
+        const auto *ev = reinterpret_cast<const struct inotify_event *>(p);
+        p += sizeof(struct inotify_event) + ev->len;
+        if (ev->mask & IN_Q_OVERFLOW) {
+          fprintf(stderr,
+                  "[WRNNG] Inotify queue overflow; some files may have been "
+                  "missed (traceback: %s)\n",
+                  __func__);
+          continue;
+        }
+        if (!ev->len || (ev->mask & IN_ISDIR) || !(ev->mask & WATCH_EVENTS))
+          continue;
+        const auto it = m_watches.find(ev->wd);
+        if (it == m_watches.end() || !matches(ev->name)) continue;
+        queue.push(m_dirs[it->second] + "/" + ev->name, m_stopped);
+      }
+    }
+  }
+
+  /* process whatever is queued, then stop the workers */
+  queue.close();
+  for (auto &w : workers) w.join();
+  return m_failed - failed_before;
+}
+
+void dso::doris_rnx::DirectoryWatcher::stop() noexcept {
+  m_stopped = true;
+  const std::uint64_t one = 1;
+  [[maybe_unused]] const auto w = ::write(m_wake, &one, sizeof(one));
+}
@@ -1,34 +1,111 @@
 #include "doris_rinex.hpp"
 #include <stdexcept>
+#include "doris_rinex_decompress.hpp"
+#include "compact_rinex.hpp"
+#include "diagnostics.hpp"
 
 /** The constructor will try to:
- *  1. open the input file
+ *  1. open the input file (if it is compressed, i.e. .Z or .gz, it will be
+ *     decompressed while reading)
  *  2. parse the header
- *  If any of the above fails, then an std::runtime_error will be thrown.
+ *  If any of the above fails, the error is reported (see
+ *  doris_rinex_diagnostics.hpp) and header_ok() is false.
  */
-dso::DorisObsRinex::DorisObsRinex(const char *fn)
-    : m_filename(fn), m_stream(fn, std::ios_base::in) {
-  /* pre-allocate vectors */
-  m_obs_codes.reserve(10);
-  m_obs_scale_factors.reserve(10);
-  m_stations.reserve(65);
-  m_ref_stations.reserve(7);
+dso::DorisObsRinex::DorisObsRinex(const char *fn) : m_filename(fn) {
+  auto source = std::make_unique<doris_rnx::FileSource>(fn);
+  const bool is_open = source->is_open();
+  /* compressed files are decompressed while streaming */
+  doris_rnx::Compression type;
+  m_source = doris_rnx::decompressing_source(std::move(source), &type);
+  m_from_file = (type == doris_rnx::Compression::none);
+  m_stream.rdbuf(m_source.get());
+  load_header(is_open);
+}
+
+dso::DorisObsRinex::DorisObsRinex(std::unique_ptr<std::streambuf> source,
+                                  const char *name)
+    : m_filename(name),
+      m_source(doris_rnx::decompressing_source(std::move(source))) {
+  m_stream.rdbuf(m_source.get());
+  load_header(m_source != nullptr);
+}
 
+void dso::DorisObsRinex::load_header(bool is_open) noexcept {
   /* read the header .. */
+  auto header = std::make_shared<DorisRinexHeader>();
+  m_header = header;
   try {
-    int status = read_header();
+    int status = is_open ? header->read(m_stream) : -1;
     if (status) {
-      fprintf(
-          stderr,
-          "[ERROR] Failed reading RINEX header for %s (error=%d) (traceback: "
-          "%s)\n",
-          fn, status, __func__);
-      throw std::runtime_error("[ERROR] Cannot read RINEX header");
+      /* the header error code (if any) was reported while reading */
+      doris_rnx::diagnose<doris_rnx::DiagLevel::error>(
+          doris_rnx::diag::HEADER_READ_FAILED, __func__, m_filename.c_str());
+      return;
     }
+    if (header->is_compact())
+      m_compact = std::make_unique<doris_rnx::CompactDecoder>(
+          header->obs_codes().size());
+    m_header_ok = true;
   } catch (std::exception &) {
-    fprintf(stderr, "[ERROR] Failed creating DorisObsRinex instance\n");
+    doris_rnx::diagnose<doris_rnx::DiagLevel::error>(
+        doris_rnx::diag::HEADER_READ_FAILED, __func__, m_filename.c_str());
   }
 }
 
 dso::DorisObsRinex::~DorisObsRinex() noexcept = default;
 
+void dso::DorisObsRinex::goto_data_block() noexcept {
+  m_stream.clear();
+  m_stream.seekg(m_header->end_of_header());
+  if (m_compact) m_compact->reset();
+}
+
+/* The stream is re-attached to the (moved) source; the source itself does not
+ * move in memory, so its position and buffer are preserved.
+ */
+dso::DorisObsRinex::DorisObsRinex(DorisObsRinex &&a) noexcept
+    : m_filename(std::move(a.m_filename)),
+      m_from_file(a.m_from_file),
+      m_source(std::move(a.m_source)),
+      m_stream(m_source.get()),
+      m_header(std::move(a.m_header)),
+      m_map(std::move(a.m_map)),
+      m_compact(std::move(a.m_compact)),
+      m_header_ok(a.m_header_ok),
+      m_lenient(a.m_lenient),
+      m_error_sink(std::move(a.m_error_sink)) {
+  m_stream.clear(a.m_stream.rdstate());
+  a.m_stream.rdbuf(nullptr);
+}
+
+dso::DorisObsRinex &dso::DorisObsRinex::operator=(DorisObsRinex &&a) noexcept {
+  if (this != &a) {
+    m_filename = std::move(a.m_filename);
+    m_from_file = a.m_from_file;
+    m_source = std::move(a.m_source);
+    m_stream.rdbuf(m_source.get());
+    m_stream.clear(a.m_stream.rdstate());
+    a.m_stream.rdbuf(nullptr);
+    m_header = std::move(a.m_header);
+    m_map = std::move(a.m_map);
+    m_compact = std::move(a.m_compact);
+    m_header_ok = a.m_header_ok;
+    m_lenient = a.m_lenient;
+    m_error_sink = std::move(a.m_error_sink);
+  }
+  return *this;
+}
+
+/** The file is mapped (once) on first call; all cursors share the mapping and
+ *  the header of this instance.
+ */
+dso::DorisRinexCursor dso::DorisObsRinex::cursor() {
+  if (!m_from_file || m_compact) {
+    throw std::runtime_error(
+        "[ERROR] Cursors can only be created for RINEX files; source is " +
+        m_filename + "\n");
+  }
+  if (!m_map)
+    m_map = std::make_shared<const doris_rnx::MappedFile>(m_filename.c_str());
+  return DorisRinexCursor(m_header, m_map);
+}
@@ -0,0 +1,72 @@
+#include <stdexcept>
+
+#include "doris_rinex.hpp"
+#include "record_offsets.hpp"
+
+void dso::DorisObsRinex::bidirectional_iterator::read_at(pos_type pos) {
+  /* compact files can only be decoded in order */
+  if (m_rnx->m_compact)
+    throw std::runtime_error(
+        "[ERROR] Bidirectional iteration not supported for compact RINEX " +
+        m_rnx->m_filename + "\n");
+
+  auto &stream = m_rnx->m_stream;
+  stream.clear();
+  stream.seekg(pos);
+
+  /* try to get the block */
+  int status = m_rnx->get_next_data_block(m_current);
+  if (!status) {
+    m_pos = pos;
+    /* note that this is invalid if the block was the last one and the file
+     * does not end with a newline character
+     */
+    m_next = stream.tellg();
+    return;
+  }
+
+  /* eof/end ? */
+  if (status < 0) {
+    m_pos = doris_rnx::INVALID_POS;
+    return;
+  }
+
+  throw std::runtime_error(
+      "[ERROR] Failed getting data block from RINEX file " + m_rnx->m_filename +
+      "\n");
+}
+
+dso::DorisObsRinex::bidirectional_iterator &
+dso::DorisObsRinex::bidirectional_iterator::operator++() {
+  /* already at end */
+  if (m_pos == doris_rnx::INVALID_POS) return *this;
+
+  if (m_next == doris_rnx::INVALID_POS) {
+    m_pos = doris_rnx::INVALID_POS;
+  } else {
+    read_at(m_next);
+  }
+  return *this;
+}
+
+/** Locate the line starting with '>' preceding the current block (or the
+ *  last one in the file, if we are at end), and read the block from there.
+ */
+dso::DorisObsRinex::bidirectional_iterator &
+dso::DorisObsRinex::bidirectional_iterator::operator--() {
+  auto &stream = m_rnx->m_stream;
+  const pos_type before = (m_pos == doris_rnx::INVALID_POS)
+                              ? doris_rnx::stream_size(stream)
+                              : m_pos;
+
+  Datetime<nanoseconds> epoch;
+  const pos_type prev = doris_rnx::previous_epoch_record(
+      stream, before, m_rnx->m_header->end_of_header(), epoch);
+
+  if (prev == doris_rnx::INVALID_POS) {
+    m_pos = doris_rnx::INVALID_POS;
+  } else {
+    read_at(prev);
+  }
+  return *this;
+}
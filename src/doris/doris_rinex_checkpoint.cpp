@@ -0,0 +1,146 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "archive_codec.hpp"
+#include "doris_rinex.hpp"
+
+namespace {
+
+/* Serialized checkpoints start with this (4 bytes), followed by a version */
+constexpr const char CHECKPOINT_MAGIC[] = "RNXC";
+constexpr std::uint8_t CHECKPOINT_VERSION = 1;
+
+/* flag bits */
+constexpr std::uint8_t HAS_EPOCH = 1;
+constexpr std::uint8_t AT_END = 2;
+
+/* write v at buf, little-endian */
+void put_u64(char *buf, std::uint64_t v) noexcept {
+  for (int i = 0; i < 8; i++) buf[i] = (char)((v >> (8 * i)) & 0xff);
+}
+
+} /* unnamed namespace */
+
+/*  Layout (little-endian):
+ *    [0, 4)   magic ("RNXC")
+ *    [4]      version
+ *    [5]      flags (HAS_EPOCH | AT_END)
+ *    [6, 8)   reserved (zero)
+ *    [8, 16)  header fingerprint
+ *    [16, 24) offset of next data block
+ *    [24, 32) epoch of last block read, as nanoseconds since MJD 0
+ */
+void dso::doris_rnx::Checkpoint::serialize(char *buf) const noexcept {
+  std::memcpy(buf, CHECKPOINT_MAGIC, 4);
+  buf[4] = (char)CHECKPOINT_VERSION;
+  buf[5] = (char)((m_has_epoch ? HAS_EPOCH : 0) | (m_at_end ? AT_END : 0));
+  buf[6] = buf[7] = '\0';
+  put_u64(buf + 8, m_fingerprint);
+  put_u64(buf + 16, (std::uint64_t)m_offset);
+  put_u64(buf + 24,
+          m_has_epoch ? (std::uint64_t)epoch_to_ns(m_last_epoch) : 0);
+}
+
+int dso::doris_rnx::Checkpoint::deserialize(const char *buf) noexcept {
+  if (std::memcmp(buf, CHECKPOINT_MAGIC, 4)) return 1;
+  archive::ByteReader r(reinterpret_cast<const std::uint8_t *>(buf) + 4,
+                        SERIALIZED_SIZE - 4);
+  if (r.u8() != CHECKPOINT_VERSION) return 2;
+  const std::uint8_t flags = r.u8();
+  r.skip(2);
+  m_fingerprint = r.u64();
+  m_offset = (std::int64_t)r.u64();
+  const std::int64_t ns = (std::int64_t)r.u64();
+  m_has_epoch = flags & HAS_EPOCH;
+  m_at_end = flags & AT_END;
+  if (m_has_epoch) m_last_epoch = ns_to_epoch(ns);
+  return r.error();
+}
+
+dso::doris_rnx::Checkpoint dso::DorisObsRinex::checkpoint(
+    const iterator &it) & {
+  /* compact files would also need the state of the decoder */
+  if (m_compact) {
+    throw std::runtime_error(
+        "[ERROR] Cannot checkpoint a compact RINEX file; source is " +
+        m_filename + "\n");
+  }
+
+  doris_rnx::Checkpoint cp;
+  cp.m_fingerprint = m_header->fingerprint();
+  if (it == end()) {
+    cp.m_at_end = true;
+    return cp;
+  }
+  cp.m_has_epoch = true;
+  cp.m_last_epoch = it->mheader.m_epoch;
+
+  /* if we hit EOF (no newline at end of file), tellg is invalid; that was
+   * the last block
+   */
+  const pos_type pos = m_stream.tellg();
+  if (pos == pos_type(std::streamoff(-1))) {
+    if (!m_stream.eof()) {
+      throw std::runtime_error(
+          "[ERROR] Cannot get the reading position to checkpoint; source is " +
+          m_filename + "\n");
+    }
+    cp.m_at_end = true;
+    return cp;
+  }
+  cp.m_offset = std::streamoff(pos);
+  return cp;
+}
+
+/** The stream is placed at the stored offset; if the source cannot seek
+ *  (e.g. compressed files), the bytes up to the offset are skipped (but not
+ *  parsed). The block there must start with a record line and must not be
+ *  older than the last epoch of the checkpoint.
+ */
+dso::DorisObsRinex::iterator dso::DorisObsRinex::resume(
+    const doris_rnx::Checkpoint &cp) & {
+  if (cp.m_fingerprint != m_header->fingerprint()) {
+    throw std::runtime_error(
+        "[ERROR] Checkpoint does not match the header of " + m_filename +
+        "\n");
+  }
+  if (m_compact) {
+    throw std::runtime_error(
+        "[ERROR] Cannot resume a compact RINEX file; source is " + m_filename +
+        "\n");
+  }
+  if (cp.m_at_end) return end();
+
+  const pos_type target = pos_type(std::streamoff(cp.m_offset));
+  m_stream.clear();
+  m_stream.seekg(target);
+  if (m_stream.fail()) {
+    m_stream.clear();
+    const pos_type current = m_stream.tellg();
+    if (current == pos_type(std::streamoff(-1)) || current > target ||
+        !m_stream.ignore(target - current)) {
+      throw std::runtime_error(
+          "[ERROR] Cannot reposition to checkpoint offset in " + m_filename +
+          "\n");
+    }
+  }
+
+  const auto c = m_stream.peek();
+  if (c == std::istream::traits_type::eof()) {
+    m_stream.clear();
+    return end();
+  }
+  if (c != '>') {
+    throw std::runtime_error(
+        "[ERROR] No data block at checkpoint offset in " + m_filename + "\n");
+  }
+
+  iterator it{*this, false};
+  if (it != end() && cp.m_has_epoch &&
+      it->mheader.m_epoch < cp.m_last_epoch) {
+    throw std::runtime_error(
+        "[ERROR] Data block at checkpoint offset precedes the checkpoint in " +
+        m_filename + "\n");
+  }
+  return it;
+}
@@ -0,0 +1,94 @@
+#include "doris_rinex_cursor.hpp"
+
+#include "data_block.hpp"
+#include "doris_rinex_source.hpp"
+#include "record_offsets.hpp"
+
+/* An input stream over a (shared) mapped file; only used by one cursor */
+struct dso::DorisRinexCursor::Stream {
+  doris_rnx::MemorySource m_buf;
+  std::istream m_stream;
+
+  explicit Stream(const doris_rnx::MappedFile &map)
+      : m_buf(map.data(), map.size()), m_stream(&m_buf) {}
+}; /* struct Stream */
+
+dso::DorisRinexCursor::DorisRinexCursor(
+    std::shared_ptr<const DorisRinexHeader> hdr,
+    std::shared_ptr<const doris_rnx::MappedFile> map)
+    : m_header(std::move(hdr)),
+      m_map(std::move(map)),
+      m_stream(new Stream(*m_map)),
+      m_pos(m_header->end_of_header()) {}
+
+dso::DorisRinexCursor::~DorisRinexCursor() noexcept = default;
+
+dso::DorisRinexCursor::DorisRinexCursor(const DorisRinexCursor &other)
+    : m_header(other.m_header),
+      m_map(other.m_map),
+      m_stream(new Stream(*m_map)),
+      m_pos(other.m_pos) {}
+
+dso::DorisRinexCursor &dso::DorisRinexCursor::operator=(
+    const DorisRinexCursor &other) {
+  if (this != &other) {
+    m_header = other.m_header;
+    m_map = other.m_map;
+    m_stream.reset(new Stream(*m_map));
+    m_pos = other.m_pos;
+  }
+  return *this;
+}
+
+dso::DorisRinexCursor::DorisRinexCursor(DorisRinexCursor &&other) noexcept =
+    default;
+
+dso::DorisRinexCursor &dso::DorisRinexCursor::operator=(
+    DorisRinexCursor &&other) noexcept = default;
+
+void dso::DorisRinexCursor::rewind() noexcept {
+  m_pos = m_header->end_of_header();
+}
+
+void dso::DorisRinexCursor::seek_end() noexcept {
+  m_pos = pos_type(std::streamoff(m_map->size()));
+}
+
+int dso::DorisRinexCursor::seek(const Datetime<nanoseconds> &t) noexcept {
+  const pos_type pos = doris_rnx::bisect_epoch_record(
+      m_stream->m_stream, m_header->end_of_header(), t);
+  if (pos == doris_rnx::INVALID_POS) {
+    seek_end();
+    return -1;
+  }
+  m_pos = pos;
+  return 0;
+}
+
+int dso::DorisRinexCursor::next(doris_rnx::DataBlock &block) noexcept {
+  std::istream &is = m_stream->m_stream;
+  is.clear();
+  is.seekg(m_pos);
+
+  const int status = doris_rnx::read_data_block(is, *m_header, block);
+  if (!status) {
+    /* if we hit EOF (no newline at end of file), tellg is invalid */
+    const pos_type pos = is.tellg();
+    m_pos = (pos == doris_rnx::INVALID_POS)
+                ? pos_type(std::streamoff(m_map->size()))
+                : pos;
+  }
+  return status;
+}
+
+int dso::DorisRinexCursor::prev(doris_rnx::DataBlock &block) noexcept {
+  std::istream &is = m_stream->m_stream;
+  Datetime<nanoseconds> epoch;
+  const pos_type pos = doris_rnx::previous_epoch_record(
+      is, m_pos, m_header->end_of_header(), epoch);
+  if (pos == doris_rnx::INVALID_POS) return -1;
+
+  const int status = doris_rnx::read_data_block(is, *m_header, block);
+  if (!status) m_pos = pos;
+  return status;
+}
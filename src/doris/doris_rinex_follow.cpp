@@ -0,0 +1,281 @@
+#include "doris_rinex_follow.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "data_block.hpp"
+#include "diagnostics.hpp"
+#include "doris_rinex.hpp"
+#include "record_offsets.hpp"
+
+/* The stream and file descriptors of a follower */
+struct dso::DorisRinexFollower::Impl {
+  std::ifstream m_stream;
+  /* the file, only used to stat its size */
+  int m_fd{-1};
+  /* inotify instance watching the file (or -1, when polling) */
+  int m_inotify{-1};
+  /* eventfd used by stop() to wake up a waiting call */
+  int m_wake{-1};
+  /* epoll instance over the two above, i.e. the fd users can wait on */
+  int m_epoll{-1};
+  /* size of the file, last time we checked */
+  off_t m_size{0};
+  /* interval between checks of the file size (milliseconds) */
+  int m_poll_interval_ms;
+  std::atomic<bool> m_stopped{false};
+
+  Impl(const char *fn, int poll_interval_ms)
+      : m_stream(fn), m_poll_interval_ms(poll_interval_ms) {}
+
+  ~Impl() noexcept {
+    if (m_fd >= 0) ::close(m_fd);
+    if (m_inotify >= 0) ::close(m_inotify);
+    if (m_wake >= 0) ::close(m_wake);
+    if (m_epoll >= 0) ::close(m_epoll);
+  }
+
+  /* current size of the file, or -1 on error */
+  off_t file_size() const noexcept {
+    struct stat st;
+    return ::fstat(m_fd, &st) ? off_t(-1) : st.st_size;
+  }
+
+  /* discard any pending inotify events */
+  void drain_inotify() noexcept {
+    alignas(struct inotify_event) char buf[4096];
+    while (::read(m_inotify, buf, sizeof(buf)) > 0) {
+    }
+  }
+}; /* struct Impl */
+
+dso::DorisRinexFollower::DorisRinexFollower(
+    const char *fn, const doris_rnx::FollowOptions &opts)
+    : m_header(nullptr),
+      m_impl(new Impl(fn, opts.m_poll_interval_ms > 0 ? opts.m_poll_interval_ms
+                                                      : 1)) {
+  m_impl->m_fd = ::open(fn, O_RDONLY | O_CLOEXEC);
+  if (!m_impl->m_stream.is_open() || m_impl->m_fd < 0) {
+    throw std::runtime_error("[ERROR] Failed opening file " + std::string(fn) +
+                             " to follow\n");
+  }
+  m_impl->m_wake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_impl->m_wake < 0) {
+    throw std::runtime_error("[ERROR] Failed creating eventfd to follow file " +
+                             std::string(fn) + "\n");
+  }
+
+  /* watch the file before reading anything off it, so that no append can
+   * go unnoticed; if inotify is not available, fall back to polling
+   */
+  if (opts.m_use_inotify) {
+    m_impl->m_inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_impl->m_inotify >= 0 &&
+        ::inotify_add_watch(m_impl->m_inotify, fn, IN_MODIFY) < 0) {
+      ::close(m_impl->m_inotify);
+      m_impl->m_inotify = -1;
+    }
+  }
+  m_impl->m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+  bool waitable = m_impl->m_epoll >= 0;
+  for (int fd : {m_impl->m_wake, m_impl->m_inotify}) {
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (waitable && fd >= 0)
+      waitable = !::epoll_ctl(m_impl->m_epoll, EPOLL_CTL_ADD, fd, &ev);
+  }
+  if (!waitable) {
+    throw std::runtime_error("[ERROR] Failed creating epoll to follow file " +
+                             std::string(fn) + "\n");
+  }
+  m_impl->m_size = m_impl->file_size();
+
+  auto hdr = std::make_shared<DorisRinexHeader>();
+  if (hdr->read(m_impl->m_stream)) {
+    throw std::runtime_error("[ERROR] Failed reading header of file " +
+                             std::string(fn) + "\n");
+  }
+  if (hdr->is_compact()) {
+    throw std::runtime_error("[ERROR] Cannot follow compact RINEX file " +
+                             std::string(fn) + "\n");
+  }
+  m_pos = hdr->end_of_header();
+  m_header = std::move(hdr);
+}
+
+dso::DorisRinexFollower::~DorisRinexFollower() noexcept = default;
+
+bool dso::DorisRinexFollower::uses_inotify() const noexcept {
+  return m_impl->m_inotify >= 0;
+}
+
+int dso::DorisRinexFollower::wait_fd() const noexcept {
+  return m_impl->m_epoll;
+}
+
+int dso::DorisRinexFollower::wait_interval_ms() const noexcept {
+  return uses_inotify() ? -1 : m_impl->m_poll_interval_ms;
+}
+
+int dso::DorisRinexFollower::block_complete() noexcept {
+  constexpr const int MAX_RECORD_CHARS = DorisObsRinex::MAX_RECORD_CHARS;
+  std::istream &is = m_impl->m_stream;
+  char line[MAX_RECORD_CHARS];
+  int status = 0;
+
+  /* a previous read may have hit EOF; more data may be there by now */
+  is.clear();
+  is.seekg(m_pos);
+
+  for (bool skipped = true; skipped && !status;) {
+    skipped = false;
+    /* the record line must be there, newline-terminated */
+    if (!is.getline(line, MAX_RECORD_CHARS) || is.eof()) {
+      status = is.eof() ? -1 : 1;
+      break;
+    }
+
+    /* special events are followed by special records, not observations */
+    const int event_lines = doris_rnx::special_event_lines(line);
+    int lines = event_lines;
+    if (event_lines < 0) {
+      doris_rnx::RinexDataRecordHeader rec;
+      if (doris_rnx::resolve_block_epoch(line, rec)) {
+        status = 1;
+        break;
+      }
+      lines = rec.m_num_stations * m_header->lines_per_beacon();
+    }
+
+    /* skip the following lines; the last one must be newline-terminated */
+    for (int i = 0; i < lines; i++) {
+      is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      if (is.eof()) {
+        status = -1;
+        break;
+      }
+    }
+
+    /* complete special events without an epoch are never returned (see
+     * read_data_block); move past them
+     */
+    Datetime<nanoseconds> epoch;
+    if (!status && event_lines >= 0 &&
+        doris_rnx::epoch_of_record_line(line, epoch)) {
+      m_pos = is.tellg();
+      skipped = true;
+    }
+  }
+
+  if (status > 0) {
+    doris_rnx::diagnose<doris_rnx::DiagLevel::error>(
+        doris_rnx::diag::DATA_INVALID_BLOCK, __func__, nullptr, -1,
+        std::streamoff(m_pos));
+  }
+  is.clear();
+  is.seekg(m_pos);
+  return status;
+}
+
+bool dso::DorisRinexFollower::wait_for_data(int timeout_ms) noexcept {
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms);
+
+  struct pollfd fds[2];
+  fds[0].fd = m_impl->m_wake;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_impl->m_inotify;
+  fds[1].events = POLLIN;
+  const nfds_t nfds = uses_inotify() ? 2 : 1;
+
+  for (;;) {
+    if (m_impl->m_stopped.load(std::memory_order_acquire)) return false;
+
+    /* how long to sleep for; when polling, at most one poll interval */
+    int wait_ms = -1;
+    if (timeout_ms >= 0) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            deadline - clock::now())
+                            .count();
+      if (left <= 0) return false;
+      wait_ms = static_cast<int>(left);
+    }
+    if (!uses_inotify() &&
+        (wait_ms < 0 || wait_ms > m_impl->m_poll_interval_ms)) {
+      wait_ms = m_impl->m_poll_interval_ms;
+    }
+
+    fds[0].revents = fds[1].revents = 0;
+    if (::poll(fds, nfds, wait_ms) < 0 && errno != EINTR) return false;
+    if (fds[0].revents) return false;
+    if (nfds > 1 && fds[1].revents) m_impl->drain_inotify();
+
+    /* sample the size before anything is read, so that data appended from
+     * now on is noticed by the next wait
+     */
+    const off_t size = m_impl->file_size();
+    if (size < 0) return false;
+    if (size != m_impl->m_size) {
+      m_impl->m_size = size;
+      return true;
+    }
+  }
+}
+
+int dso::DorisRinexFollower::next(doris_rnx::DataBlock &block,
+                                  int timeout_ms) noexcept {
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms);
+
+  /* notifications pending are about data checked right below; clear them,
+   * so that wait_fd() only signals what is appended from now on
+   */
+  if (uses_inotify()) m_impl->drain_inotify();
+
+  int status;
+  while ((status = block_complete()) < 0) {
+    if (m_impl->m_stopped.load(std::memory_order_acquire)) return -1;
+    int left = -1;
+    if (timeout_ms >= 0) {
+      left = static_cast<int>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                clock::now())
+              .count());
+      if (left <= 0) return -1;
+    }
+    if (!wait_for_data(left)) return -1;
+  }
+  if (status) return status;
+
+  /* the block is complete; the stream is at its start */
+  std::istream &is = m_impl->m_stream;
+  status = doris_rnx::read_data_block(is, *m_header, block);
+  if (!status) m_pos = is.tellg();
+  return status;
+}
+
+void dso::DorisRinexFollower::stop() noexcept {
+  m_impl->m_stopped.store(true, std::memory_order_release);
+  const std::uint64_t one = 1;
+  [[maybe_unused]] const auto w = ::write(m_impl->m_wake, &one, sizeof(one));
+}
+
+bool dso::DorisRinexFollower::stopped() const noexcept {
+  return m_impl->m_stopped.load(std::memory_order_acquire);
+}
@@ -0,0 +1,21 @@
+#include "doris_rinex.hpp"
+#include "record_offsets.hpp"
+
+/** The data section of the file (i.e. from END OF HEADER to EOF) is bisected
+ *  on byte offsets; at each step, we resynchronise to the next line starting
+ *  with '>', decode its epoch and narrow the range. Hence, no index is needed
+ *  and the search takes logarithmic time.
+ */
+dso::DorisObsRinex::iterator dso::DorisObsRinex::seek(
+    const dso::Datetime<dso::nanoseconds> &t) & {
+  /* compact files can only be decoded in order */
+  if (m_compact) {
+    auto it = begin();
+    while (it != end() && it->mheader.m_epoch < t) ++it;
+    return it;
+  }
+  if (doris_rnx::bisect_epoch_record(m_stream, m_header->end_of_header(), t) ==
+      doris_rnx::INVALID_POS)
+    return end();
+  return iterator{*this, false};
+}
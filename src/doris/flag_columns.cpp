@@ -0,0 +1,48 @@
+#include <cstring>
+#include <unordered_map>
+
+#include "doris_rinex_flags.hpp"
+
+void dso::doris_rnx::FlagColumns::set_beacons(const char *ids,
+                                              std::size_t num_rows) {
+  std::unordered_map<std::string, int> index;
+  m_beacon.resize(num_rows);
+  for (std::size_t i = 0; i < num_rows; i++) {
+    const std::string id(ids + 4 * i, ::strnlen(ids + 4 * i, 3));
+    const auto it = index.emplace(id, (int)m_beacon_ids.size());
+    if (it.second) m_beacon_ids.push_back(id);
+    m_beacon[i] = it.first->second;
+  }
+}
+
+char dso::doris_rnx::FlagColumns::flag(std::size_t row, int obs,
+                                       int which) const noexcept {
+  const int code = (packed(obs, which)[row / 2] >> (4 * (row & 1))) & 0xf;
+  if (code == kernels::FLAG_BLANK) return ' ';
+  return (code <= 10) ? char('0' + code - 1) : '?';
+}
+
+dso::doris_rnx::RowMask
+dso::doris_rnx::FlagColumns::mask(int obs, int which, std::uint8_t lo,
+                                  std::uint8_t hi) const {
+  RowMask m((m_num_rows + 63) / 64);
+  kernels::flag_mask(packed(obs, which), m_num_rows, lo, hi, m.data());
+  return m;
+}
+
+std::size_t dso::doris_rnx::FlagColumns::count(const RowMask &m) noexcept {
+  std::size_t n = 0;
+  for (const auto w : m) n += __builtin_popcountll(w);
+  return n;
+}
+
+std::vector<std::size_t>
+dso::doris_rnx::FlagColumns::count_by_beacon(const RowMask &m) const {
+  std::vector<std::size_t> counts(m_beacon_ids.size(), 0);
+  /* visit the set bits only */
+  for (std::size_t w = 0; w < m.size(); w++) {
+    for (std::uint64_t bits = m[w]; bits; bits &= bits - 1)
+      ++counts[m_beacon[64 * w + __builtin_ctzll(bits)]];
+  }
+  return counts;
+}
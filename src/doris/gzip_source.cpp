@@ -0,0 +1,420 @@
+#include <array>
+
+#include "doris_rinex_decompress.hpp"
+
+namespace {
+
+/* size of the sliding window */
+constexpr std::uint32_t WINDOW_SIZE = 32768;
+
+/* base lengths and extra bits for length codes 257..285 */
+constexpr std::uint16_t LEN_BASE[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::uint8_t LEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                        1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                        4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+/* base offsets and extra bits for distance codes 0..29 */
+constexpr std::uint16_t DIST_BASE[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                         4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                         9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/* order of code length code lengths */
+constexpr std::uint8_t CLEN_ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                         11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+/* gzip header flags */
+constexpr int FHCRC = 2;
+constexpr int FEXTRA = 4;
+constexpr int FNAME = 8;
+constexpr int FCOMMENT = 16;
+
+/* CRC-32 (IEEE 802.3) lookup table */
+const std::array<std::uint32_t, 256> CRC_TABLE = [] {
+  std::array<std::uint32_t, 256> t{};
+  for (std::uint32_t n = 0; n < 256; n++) {
+    std::uint32_t c = n;
+    for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    t[n] = c;
+  }
+  return t;
+}();
+
+/* reverse the lower len bits of code */
+inline int reverse_bits(int code, int len) noexcept {
+  int r = 0;
+  while (len--) {
+    r = (r << 1) | (code & 1);
+    code >>= 1;
+  }
+  return r;
+}
+
+} /* unnamed namespace */
+
+/** Build a canonical Huffman code, given the code length of each symbol.
+ *  @return 0 if the code is complete, > 0 if incomplete and < 0 if
+ *          over-subscribed (i.e. invalid).
+ */
+int dso::doris_rnx::GzipSource::Huffman::build(const std::uint8_t *lengths,
+                                               int n) noexcept {
+  for (int len = 0; len < 16; len++) m_count[len] = 0;
+  for (int sym = 0; sym < n; sym++) ++m_count[lengths[sym]];
+  for (auto &f : m_fast) f = 0;
+  if (m_count[0] == n) return 0;
+
+  /* check for over-subscribed or incomplete set of lengths */
+  int left = 1;
+  for (int len = 1; len < 16; len++) {
+    left <<= 1;
+    left -= m_count[len];
+    if (left < 0) return left;
+  }
+
+  /* offsets in symbol table for each length, and sorted symbols */
+  std::int16_t offs[16];
+  offs[1] = 0;
+  for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + m_count[len];
+  for (int sym = 0; sym < n; sym++)
+    if (lengths[sym]) m_symbol[offs[lengths[sym]]++] = sym;
+
+  /* lookup table for short codes (indexed by the bit-reversed code) */
+  int code = 0, index = 0;
+  for (int len = 1; len <= FAST_BITS; len++) {
+    for (int k = 0; k < m_count[len]; k++) {
+      const int sym = m_symbol[index++];
+      for (int fill = reverse_bits(code, len); fill < (1 << FAST_BITS);
+           fill += (1 << len))
+        m_fast[fill] = (len << 9) | sym;
+      ++code;
+    }
+    code <<= 1;
+  }
+
+  return left;
+}
+
+dso::doris_rnx::GzipSource::GzipSource(std::unique_ptr<std::streambuf> in,
+                                       bool magic_consumed,
+                                       std::size_t buffer_size)
+    : InputSource(buffer_size),
+      m_in(std::move(in)),
+      m_magic_consumed(magic_consumed),
+      m_window(WINDOW_SIZE) {
+  if (!m_in) {
+    m_error = true;
+    m_state = State::done;
+  }
+}
+
+int dso::doris_rnx::GzipSource::read_byte() noexcept {
+  const auto c = m_in->sbumpc();
+  return (c == std::streambuf::traits_type::eof()) ? -1 : c;
+}
+
+/* Make sure at least nbits are in the bit buffer; false if input ends first */
+bool dso::doris_rnx::GzipSource::need(int nbits) noexcept {
+  while (m_bitcnt < nbits) {
+    const int c = read_byte();
+    if (c < 0) {
+      m_input_eof = true;
+      return false;
+    }
+    m_bitbuf |= static_cast<std::uint64_t>(c) << m_bitcnt;
+    m_bitcnt += 8;
+  }
+  return true;
+}
+
+/* Get nbits (<= 16) off the input; on premature EOF, sets m_error */
+int dso::doris_rnx::GzipSource::bits(int nbits) noexcept {
+  if (!nbits) return 0;
+  if (!need(nbits)) {
+    m_error = true;
+    return 0;
+  }
+  const int val = m_bitbuf & ((1u << nbits) - 1);
+  m_bitbuf >>= nbits;
+  m_bitcnt -= nbits;
+  return val;
+}
+
+/* Decode a symbol using code h; -1 on error */
+int dso::doris_rnx::GzipSource::decode(const Huffman &h) noexcept {
+  /* fast path, via the lookup table */
+  need(Huffman::FAST_BITS);
+  const int e = h.m_fast[m_bitbuf & ((1u << Huffman::FAST_BITS) - 1)];
+  if (e && (e >> 9) <= m_bitcnt) {
+    m_bitbuf >>= (e >> 9);
+    m_bitcnt -= (e >> 9);
+    return e & 0x1ff;
+  }
+
+  /* slow path, bit by bit (codes are stored MSB first) */
+  int code = 0, first = 0, index = 0;
+  for (int len = 1; len < 16; len++) {
+    if (!need(1)) return -1;
+    code |= m_bitbuf & 1;
+    m_bitbuf >>= 1;
+    --m_bitcnt;
+    const int count = h.m_count[len];
+    if (code - count < first) return h.m_symbol[index + (code - first)];
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+/* @see RFC 1952, section 2.3 */
+bool dso::doris_rnx::GzipSource::read_member_header() noexcept {
+  if (!m_magic_consumed) {
+    if (bits(8) != 0x1f || bits(8) != 0x8b) return false;
+  }
+  m_magic_consumed = false;
+
+  /* compression method must be deflate */
+  if (bits(8) != 8) return false;
+  const int flags = bits(8);
+  /* skip MTIME, XFL and OS */
+  for (int i = 0; i < 6; i++) bits(8);
+  if (flags & FEXTRA) {
+    int xlen = bits(16);
+    while (xlen-- && !m_error) bits(8);
+  }
+  if (flags & FNAME)
+    while (bits(8) && !m_error);
+  if (flags & FCOMMENT)
+    while (bits(8) && !m_error);
+  if (flags & FHCRC) bits(16);
+
+  m_crc = 0xffffffffu;
+  m_size = 0;
+  m_final_block = false;
+  return !m_error;
+}
+
+/* @see RFC 1951, section 3.2.3 */
+bool dso::doris_rnx::GzipSource::read_block_header() noexcept {
+  if (m_final_block) {
+    m_state = State::member_trailer;
+    return true;
+  }
+
+  m_final_block = bits(1);
+  const int type = bits(2);
+  if (m_error) return false;
+
+  if (type == 0) {
+    /* stored block; skip to byte boundary, get LEN and NLEN */
+    bits(m_bitcnt % 8);
+    const int len = bits(16);
+    const int nlen = bits(16);
+    if (m_error || (len != (~nlen & 0xffff))) return false;
+    m_stored_left = len;
+    m_state = State::stored;
+  } else if (type == 1) {
+    /* fixed codes */
+    std::uint8_t lengths[288];
+    int sym = 0;
+    for (; sym < 144; sym++) lengths[sym] = 8;
+    for (; sym < 256; sym++) lengths[sym] = 9;
+    for (; sym < 280; sym++) lengths[sym] = 7;
+    for (; sym < 288; sym++) lengths[sym] = 8;
+    m_lencode.build(lengths, 288);
+    for (sym = 0; sym < 30; sym++) lengths[sym] = 5;
+    m_distcode.build(lengths, 30);
+    m_state = State::huffman;
+  } else if (type == 2) {
+    if (!read_dynamic_tables()) return false;
+    m_state = State::huffman;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/* @see RFC 1951, section 3.2.7 */
+bool dso::doris_rnx::GzipSource::read_dynamic_tables() noexcept {
+  std::uint8_t lengths[286 + 30];
+
+  const int nlen = bits(5) + 257;
+  const int ndist = bits(5) + 1;
+  const int ncode = bits(4) + 4;
+  if (m_error || nlen > 286 || ndist > 30) return false;
+
+  /* code length code (must be complete) */
+  for (int i = 0; i < 19; i++)
+    lengths[CLEN_ORDER[i]] = (i < ncode) ? bits(3) : 0;
+  Huffman lencode;
+  if (m_error || lencode.build(lengths, 19)) return false;
+
+  /* literal/length and distance code lengths */
+  int index = 0;
+  while (index < nlen + ndist) {
+    int sym = decode(lencode);
+    if (sym < 0) return false;
+    if (sym < 16) {
+      lengths[index++] = sym;
+    } else {
+      std::uint8_t len = 0;
+      int repeat;
+      if (sym == 16) {
+        if (!index) return false;
+        len = lengths[index - 1];
+        repeat = 3 + bits(2);
+      } else if (sym == 17) {
+        repeat = 3 + bits(3);
+      } else {
+        repeat = 11 + bits(7);
+      }
+      if (m_error || index + repeat > nlen + ndist) return false;
+      while (repeat--) lengths[index++] = len;
+    }
+  }
+
+  /* there must be a code for end-of-block */
+  if (!lengths[256]) return false;
+
+  /* incomplete codes are only allowed if there is a single code */
+  int err = m_lencode.build(lengths, nlen);
+  if (err < 0 || (err > 0 && nlen - m_lencode.m_count[0] != 1)) return false;
+  err = m_distcode.build(lengths + nlen, ndist);
+  if (err < 0 || (err > 0 && ndist - m_distcode.m_count[0] != 1))
+    return false;
+
+  return true;
+}
+
+/* @see RFC 1952, section 2.3.1; verify CRC-32 and size, check for another
+ * member.
+ */
+bool dso::doris_rnx::GzipSource::read_member_trailer() noexcept {
+  bits(m_bitcnt % 8);
+  std::uint32_t crc = bits(16);
+  crc |= static_cast<std::uint32_t>(bits(16)) << 16;
+  std::uint32_t isize = bits(16);
+  isize |= static_cast<std::uint32_t>(bits(16)) << 16;
+  if (m_error || crc != (m_crc ^ 0xffffffffu) ||
+      isize != static_cast<std::uint32_t>(m_size))
+    return false;
+
+  /* another member follows ? (anything else than a gzip header is ignored) */
+  if (need(16) && (m_bitbuf & 0xffff) == 0x8b1f) {
+    m_state = State::member_header;
+  } else {
+    m_state = State::done;
+  }
+  return true;
+}
+
+std::size_t dso::doris_rnx::GzipSource::read_chunk(char *buf, std::size_t n) {
+  std::size_t out = 0;
+
+  auto emit = [&](std::uint8_t c) noexcept {
+    buf[out++] = c;
+    m_window[m_wpos++ & (WINDOW_SIZE - 1)] = c;
+    m_crc = CRC_TABLE[(m_crc ^ c) & 0xff] ^ (m_crc >> 8);
+    ++m_size;
+  };
+
+  while (out < n && !m_error) {
+    /* pending match */
+    if (m_copy_len) {
+      while (m_copy_len && out < n) {
+        emit(m_window[(m_wpos - m_copy_dist) & (WINDOW_SIZE - 1)]);
+        --m_copy_len;
+      }
+      continue;
+    }
+
+    switch (m_state) {
+      case State::member_header:
+        if (!read_member_header()) m_error = true;
+        m_state = State::block_header;
+        break;
+      case State::block_header:
+        if (!read_block_header()) m_error = true;
+        break;
+      case State::stored:
+        if (!m_stored_left) {
+          m_state = State::block_header;
+        } else {
+          const int c = bits(8);
+          if (!m_error) {
+            emit(c);
+            --m_stored_left;
+          }
+        }
+        break;
+      case State::huffman: {
+        int sym = decode(m_lencode);
+        if (sym < 0) {
+          m_error = true;
+        } else if (sym < 256) {
+          emit(sym);
+        } else if (sym == 256) {
+          m_state = State::block_header;
+        } else {
+          sym -= 257;
+          if (sym >= 29) {
+            m_error = true;
+            break;
+          }
+          const int len = LEN_BASE[sym] + bits(LEN_EXTRA[sym]);
+          const int dsym = decode(m_distcode);
+          if (dsym < 0 || dsym >= 30) {
+            m_error = true;
+            break;
+          }
+          const int dist = DIST_BASE[dsym] + bits(DIST_EXTRA[dsym]);
+          if (m_error || static_cast<std::uint64_t>(dist) > m_size) {
+            m_error = true;
+            break;
+          }
+          m_copy_len = len;
+          m_copy_dist = dist;
+        }
+      } break;
+      case State::member_trailer:
+        if (!read_member_trailer()) m_error = true;
+        break;
+      case State::done:
+        return out;
+    }
+  }
+
+  return out;
+}
+
+std::unique_ptr<std::streambuf> dso::doris_rnx::decompressing_source(
+    std::unique_ptr<std::streambuf> source, Compression *type) {
+  using traits = std::streambuf::traits_type;
+  Compression c = Compression::none;
+
+  /* RINEX files never start with 0x1f; nothing consumed otherwise */
+  if (source && source->sgetc() == 0x1f) {
+    source->sbumpc();
+    const auto m = source->sbumpc();
+    if (m == 0x9d) {
+      c = Compression::lzw;
+      source = std::make_unique<LzwSource>(std::move(source), true);
+    } else if (m == 0x8b) {
+      c = Compression::gzip;
+      source = std::make_unique<GzipSource>(std::move(source), true);
+    } else {
+      /* not a known format; try to put the bytes back */
+      if (m != traits::eof()) source->sungetc();
+      source->sungetc();
+    }
+  }
+
+  if (type) *type = c;
+  return source;
+}
@@ -0,0 +1,103 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "doris_rinex_source.hpp"
+
+dso::doris_rnx::InputSource::InputSource(std::size_t buffer_size)
+    : m_buffer(buffer_size ? buffer_size : 1) {
+  char *b = m_buffer.data();
+  setg(b, b, b);
+}
+
+dso::doris_rnx::InputSource::int_type
+dso::doris_rnx::InputSource::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+  /* the buffer is exhausted; next chunk starts right after it */
+  m_buffer_offset += egptr() - eback();
+  char *b = m_buffer.data();
+  const std::size_t n = read_chunk(b, m_buffer.size());
+  setg(b, b, b + n);
+  if (!n) return traits_type::eof();
+  return traits_type::to_int_type(*gptr());
+}
+
+/** Querying the current position always works; seeking within the current
+ *  buffer always works; anything else is delegated to reposition().
+ */
+dso::doris_rnx::InputSource::pos_type dso::doris_rnx::InputSource::seekoff(
+    off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+
+  const std::streamoff current = m_buffer_offset + (gptr() - eback());
+  std::streamoff target = off;
+  if (dir == std::ios_base::cur) {
+    target += current;
+  } else if (dir == std::ios_base::end) {
+    const std::streamoff size = source_size();
+    if (size < 0) return pos_type(off_type(-1));
+    target += size;
+  }
+  if (target < 0) return pos_type(off_type(-1));
+
+  /* within current buffer ? */
+  if (target >= m_buffer_offset &&
+      target <= m_buffer_offset + (egptr() - eback())) {
+    setg(eback(), eback() + (target - m_buffer_offset), egptr());
+    return pos_type(target);
+  }
+
+  if (!reposition(target)) return pos_type(off_type(-1));
+  m_buffer_offset = target;
+  char *b = m_buffer.data();
+  setg(b, b, b);
+  return pos_type(target);
+}
+
+dso::doris_rnx::FdSource::FdSource(int fd, bool owns_fd,
+                                   std::size_t buffer_size)
+    : InputSource(buffer_size), m_fd(fd), m_owns_fd(owns_fd) {}
+
+dso::doris_rnx::FdSource::~FdSource() noexcept {
+  if (m_owns_fd && m_fd >= 0) ::close(m_fd);
+}
+
+std::size_t dso::doris_rnx::FdSource::read_chunk(char *buf, std::size_t n) {
+  if (m_fd < 0) return 0;
+  ssize_t r;
+  do {
+    r = ::read(m_fd, buf, n);
+  } while (r < 0 && errno == EINTR);
+  return (r > 0) ? r : 0;
+}
+
+bool dso::doris_rnx::FdSource::reposition(std::streamoff off) {
+  if (m_fd < 0) return false;
+  return ::lseek(m_fd, off, SEEK_SET) == off;
+}
+
+std::streamoff dso::doris_rnx::FdSource::source_size() {
+  struct stat st;
+  if (m_fd < 0 || ::fstat(m_fd, &st) || !S_ISREG(st.st_mode)) return -1;
+  return st.st_size;
+}
+
+dso::doris_rnx::FileSource::FileSource(const char *fn, std::size_t buffer_size)
+    : FdSource(::open(fn, O_RDONLY), true, buffer_size) {}
+
+dso::doris_rnx::MemorySource::pos_type dso::doris_rnx::MemorySource::seekoff(
+    off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+  if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+  const off_type size = egptr() - eback();
+  off_type target = off;
+  if (dir == std::ios_base::cur)
+    target += gptr() - eback();
+  else if (dir == std::ios_base::end)
+    target += size;
+  if (target < 0 || target > size) return pos_type(off_type(-1));
+  setg(eback(), eback() + target, egptr());
+  return pos_type(target);
+}
@@ -0,0 +1,146 @@
+#ifdef RNX_HAVE_IO_URING
+
+#include "io_uring_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params *p) noexcept {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags) noexcept {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      nullptr, 0);
+}
+
+/* ring indexes are shared with the kernel */
+unsigned load_acquire(const unsigned *p) noexcept {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+void store_release(unsigned *p, unsigned v) noexcept {
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T *at(void *base, unsigned offset) noexcept {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+} /* unnamed namespace */
+
+dso::doris_rnx::UringRing::UringRing(unsigned entries) noexcept {
+  io_uring_params p;
+  std::memset(&p, 0, sizeof(p));
+  const int fd = io_uring_setup(entries, &p);
+  if (fd < 0) return;
+
+  m_sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+
+  m_sq_ptr = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (m_sq_ptr == MAP_FAILED) {
+    m_sq_ptr = nullptr;
+    close(fd);
+    return;
+  }
+  if (single_mmap) {
+    m_cq_ptr = m_sq_ptr;
+  } else {
+    m_cq_ptr = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (m_cq_ptr == MAP_FAILED) {
+      m_cq_ptr = nullptr;
+      munmap(m_sq_ptr, m_sq_size);
+      m_sq_ptr = nullptr;
+      close(fd);
+      return;
+    }
+  }
+  m_sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (m_cq_ptr != m_sq_ptr) munmap(m_cq_ptr, m_cq_size);
+    munmap(m_sq_ptr, m_sq_size);
+    m_sq_ptr = m_cq_ptr = nullptr;
+    close(fd);
+    return;
+  }
+
+  m_sqes = static_cast<io_uring_sqe *>(sqes);
+  m_sq_head = at<unsigned>(m_sq_ptr, p.sq_off.head);
+  m_sq_tail = at<unsigned>(m_sq_ptr, p.sq_off.tail);
+  m_sq_mask = *at<unsigned>(m_sq_ptr, p.sq_off.ring_mask);
+  m_sq_entries = *at<unsigned>(m_sq_ptr, p.sq_off.ring_entries);
+  m_sq_array = at<unsigned>(m_sq_ptr, p.sq_off.array);
+  m_cq_head = at<unsigned>(m_cq_ptr, p.cq_off.head);
+  m_cq_tail = at<unsigned>(m_cq_ptr, p.cq_off.tail);
+  m_cq_mask = *at<unsigned>(m_cq_ptr, p.cq_off.ring_mask);
+  m_cqes = at<io_uring_cqe>(m_cq_ptr, p.cq_off.cqes);
+  m_fd = fd;
+}
+
+dso::doris_rnx::UringRing::~UringRing() noexcept {
+  if (m_fd < 0) return;
+  munmap(m_sqes, m_sqes_size);
+  if (m_cq_ptr != m_sq_ptr) munmap(m_cq_ptr, m_cq_size);
+  munmap(m_sq_ptr, m_sq_size);
+  close(m_fd);
+}
+
+bool dso::doris_rnx::UringRing::queue_read(int fd, const iovec *iov,
+                                           std::uint64_t off,
+                                           std::uint64_t user_data) noexcept {
+  const unsigned head = load_acquire(m_sq_head);
+  const unsigned tail = *m_sq_tail;
+  if (tail - head >= m_sq_entries) return false;
+
+  const unsigned idx = tail & m_sq_mask;
+  io_uring_sqe *sqe = m_sqes + idx;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(iov);
+  sqe->len = 1;
+  sqe->off = off;
+  sqe->user_data = user_data;
+  m_sq_array[idx] = idx;
+  store_release(m_sq_tail, tail + 1);
+  ++m_to_submit;
+  return true;
+}
+
+int dso::doris_rnx::UringRing::submit(unsigned min_complete) noexcept {
+  for (;;) {
+    const int ret = io_uring_enter(m_fd, m_to_submit, min_complete,
+                                   min_complete ? IORING_ENTER_GETEVENTS : 0);
+    if (ret >= 0) {
+      m_to_submit -= ret;
+      return 0;
+    }
+    if (errno != EINTR) return -errno;
+  }
+}
+
+bool dso::doris_rnx::UringRing::reap(std::uint64_t &user_data,
+                                     int &res) noexcept {
+  const unsigned head = *m_cq_head;
+  if (head == load_acquire(m_cq_tail)) return false;
+  const io_uring_cqe *cqe = m_cqes + (head & m_cq_mask);
+  user_data = cqe->user_data;
+  res = cqe->res;
+  store_release(m_cq_head, head + 1);
+  return true;
+}
+
+#endif /* RNX_HAVE_IO_URING */
@@ -0,0 +1,82 @@
+#ifndef __DSO_DORIS_RINEX_IO_URING_RING_HPP__
+#define __DSO_DORIS_RINEX_IO_URING_RING_HPP__
+
+#ifdef RNX_HAVE_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+namespace dso {
+
+namespace doris_rnx {
+
+/** @class UringRing
+ *  @brief A minimal io_uring instance (set up via raw system calls, no
+ *         liburing needed), used to submit batches of reads.
+ *
+ *  Not thread-safe; one thread submits and reaps.
+ */
+class UringRing {
+  int m_fd{-1};
+  /* submission queue */
+  unsigned *m_sq_head{nullptr};
+  unsigned *m_sq_tail{nullptr};
+  unsigned m_sq_mask{0};
+  unsigned m_sq_entries{0};
+  unsigned *m_sq_array{nullptr};
+  io_uring_sqe *m_sqes{nullptr};
+  /* completion queue */
+  unsigned *m_cq_head{nullptr};
+  unsigned *m_cq_tail{nullptr};
+  unsigned m_cq_mask{0};
+  io_uring_cqe *m_cqes{nullptr};
+  /* mappings */
+  void *m_sq_ptr{nullptr};
+  void *m_cq_ptr{nullptr};
+  std::size_t m_sq_size{0};
+  std::size_t m_cq_size{0};
+  std::size_t m_sqes_size{0};
+  /* entries queued, but not yet submitted */
+  unsigned m_to_submit{0};
+
+ public:
+  /* @brief Set up a ring; check ok(), setup fails if io_uring is not
+   * supported (or not allowed) by the kernel
+   */
+  explicit UringRing(unsigned entries) noexcept;
+  ~UringRing() noexcept;
+
+  UringRing(const UringRing &) = delete;
+  UringRing &operator=(const UringRing &) = delete;
+
+  bool ok() const noexcept { return m_fd >= 0; }
+
+  /** @brief Queue a read (of iov, at offset off of fd); iov must be valid
+   *  until the read completes.
+   *  @return false if the submission queue is full
+   */
+  bool queue_read(int fd, const iovec *iov, std::uint64_t off,
+                  std::uint64_t user_data) noexcept;
+
+  /** @brief Submit queued reads and wait for (at least) min_complete
+   *  completions.
+   *  @return 0 on success, else -errno
+   */
+  int submit(unsigned min_complete) noexcept;
+
+  /** @brief Reap a completion, if any (does not block).
+   *  @param[out] user_data The user data of the completed read
+   *  @param[out] res Result of the read (bytes read, or -errno)
+   *  @return false if no completion is available
+   */
+  bool reap(std::uint64_t &user_data, int &res) noexcept;
+}; /* class UringRing */
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif /* RNX_HAVE_IO_URING */
+
+#endif
@@ -0,0 +1,170 @@
+#include "doris_rinex_decompress.hpp"
+
+namespace {
+
+/* first code (in block mode) is CLEAR */
+constexpr std::uint32_t LZW_CLEAR = 256;
+/* initial number of bits per code */
+constexpr int LZW_INIT_BITS = 9;
+
+} /* unnamed namespace */
+
+dso::doris_rnx::LzwSource::LzwSource(std::unique_ptr<std::streambuf> in,
+                                     bool magic_consumed,
+                                     std::size_t buffer_size)
+    : InputSource(buffer_size), m_in(std::move(in)) {
+  if (!m_in) {
+    m_done = m_error = true;
+    return;
+  }
+  /* magic bytes */
+  if (!magic_consumed && (read_byte() != 0x1f || read_byte() != 0x9d)) {
+    m_done = m_error = true;
+    return;
+  }
+  if (!read_header()) {
+    m_done = m_error = true;
+    return;
+  }
+  m_prefix.resize(1 << m_maxbits);
+  m_suffix.resize(1 << m_maxbits);
+  for (int i = 0; i < 256; i++) m_suffix[i] = i;
+  m_stack.reserve(1 << m_maxbits);
+}
+
+int dso::doris_rnx::LzwSource::read_byte() noexcept {
+  const auto c = m_in->sbumpc();
+  return (c == std::streambuf::traits_type::eof()) ? -1 : c;
+}
+
+/* The byte after the magic holds the max number of bits (lower 5 bits) and
+ * the block mode flag (bit 7).
+ */
+bool dso::doris_rnx::LzwSource::read_header() noexcept {
+  const int flags = read_byte();
+  if (flags < 0) return false;
+  m_maxbits = flags & 0x1f;
+  m_block_mode = flags & 0x80;
+  if (m_maxbits < LZW_INIT_BITS || m_maxbits > 16) return false;
+  m_nbits = LZW_INIT_BITS;
+  m_maxcode = (1u << m_nbits) - 1;
+  m_free = m_block_mode ? LZW_CLEAR + 1 : 256;
+  return true;
+}
+
+/* Codes are written in groups of 8 (i.e. m_nbits bytes); when the code width
+ * changes (or after a CLEAR), the rest of the current group is padding.
+ */
+void dso::doris_rnx::LzwSource::skip_group() noexcept {
+  if (m_codes_in_group % 8) {
+    int skip = (8 - m_codes_in_group % 8) * m_nbits;
+    while (skip > 0) {
+      if (!m_bitcnt) {
+        const int c = read_byte();
+        if (c < 0) break;
+        m_bitbuf = c;
+        m_bitcnt = 8;
+      }
+      const int n = (skip < m_bitcnt) ? skip : m_bitcnt;
+      m_bitbuf >>= n;
+      m_bitcnt -= n;
+      skip -= n;
+    }
+  }
+  m_codes_in_group = 0;
+}
+
+/* @return next code, or -1 at EOF */
+int dso::doris_rnx::LzwSource::next_code() noexcept {
+  /* time to increase the code width ? */
+  if (m_free > m_maxcode && m_nbits < m_maxbits) {
+    skip_group();
+    ++m_nbits;
+    m_maxcode = (m_nbits == m_maxbits) ? (1u << m_maxbits) : (1u << m_nbits) - 1;
+  }
+
+  while (m_bitcnt < m_nbits) {
+    const int c = read_byte();
+    if (c < 0) return -1;
+    m_bitbuf |= static_cast<std::uint32_t>(c) << m_bitcnt;
+    m_bitcnt += 8;
+  }
+  const int code = m_bitbuf & ((1u << m_nbits) - 1);
+  m_bitbuf >>= m_nbits;
+  m_bitcnt -= m_nbits;
+  ++m_codes_in_group;
+  return code;
+}
+
+std::size_t dso::doris_rnx::LzwSource::read_chunk(char *buf, std::size_t n) {
+  std::size_t out = 0;
+
+  while (out < n) {
+    /* deliver any pending (decoded) chars first */
+    if (!m_stack.empty()) {
+      while (out < n && !m_stack.empty()) {
+        buf[out++] = m_stack.back();
+        m_stack.pop_back();
+      }
+      continue;
+    }
+    if (m_done) break;
+
+    int code = next_code();
+    if (code < 0) {
+      m_done = true;
+      break;
+    }
+
+    /* first code (at start or after CLEAR) is a literal */
+    if (m_oldcode < 0) {
+      if (code > 255) {
+        m_done = m_error = true;
+        break;
+      }
+      m_oldcode = code;
+      m_finchar = code;
+      m_stack.push_back(m_finchar);
+      continue;
+    }
+
+    /* CLEAR; reset the dictionary */
+    if (code == (int)LZW_CLEAR && m_block_mode) {
+      skip_group();
+      m_nbits = LZW_INIT_BITS;
+      m_maxcode = (1u << m_nbits) - 1;
+      m_free = LZW_CLEAR + 1;
+      m_oldcode = -1;
+      continue;
+    }
+
+    const int incode = code;
+    /* special case: code not yet in the dictionary (KwKwK) */
+    if (code >= (int)m_free) {
+      if (code > (int)m_free) {
+        m_done = m_error = true;
+        break;
+      }
+      m_stack.push_back(m_finchar);
+      code = m_oldcode;
+    }
+
+    /* walk the dictionary; chars are pushed in reverse order */
+    while (code >= 256) {
+      m_stack.push_back(m_suffix[code]);
+      code = m_prefix[code];
+    }
+    m_finchar = m_suffix[code];
+    m_stack.push_back(m_finchar);
+
+    /* new dictionary entry */
+    if (m_free < (1u << m_maxbits)) {
+      m_prefix[m_free] = m_oldcode;
+      m_suffix[m_free] = m_finchar;
+      ++m_free;
+    }
+    m_oldcode = incode;
+  }
+
+  return out;
+}
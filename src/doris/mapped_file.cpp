@@ -0,0 +1,45 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "doris_rinex_cursor.hpp"
+
+dso::doris_rnx::MappedFile::MappedFile(const char *fn) {
+  const int fd = ::open(fn, O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("[ERROR] Failed opening file " + std::string(fn) +
+                             " for mapping\n");
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st)) {
+    ::close(fd);
+    throw std::runtime_error("[ERROR] Failed to stat file " + std::string(fn) +
+                             "\n");
+  }
+
+  /* an empty file cannot be mapped; nothing to do */
+  m_size = st.st_size;
+  if (m_size) {
+    void *p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("[ERROR] Failed mapping file " +
+                               std::string(fn) + "\n");
+    }
+    /* we are (mostly) reading sequentially */
+    ::madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(p);
+  }
+
+  /* the mapping stays valid after closing the file */
+  ::close(fd);
+}
+
+dso::doris_rnx::MappedFile::~MappedFile() noexcept {
+  if (m_data) ::munmap(const_cast<char *>(m_data), m_size);
+}
@@ -0,0 +1,253 @@
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "doris_rinex_pipeline.hpp"
+
+namespace {
+
+using dso::doris_rnx::Backoff;
+using dso::doris_rnx::BoundedQueue;
+using dso::doris_rnx::DataBlock;
+using dso::doris_rnx::StageStats;
+
+/* a block on its way through the stages */
+struct Item {
+  /* index of the block, in the order of the source */
+  std::size_t m_seq{0};
+  /* false once dropped by a stage; dropped blocks are still passed on (but
+   * not processed), so that later stages can restore the order
+   */
+  bool m_keep{true};
+  DataBlock m_block;
+}; /* struct Item */
+
+/* the queue before a stage, and how many threads feed it */
+struct Link {
+  BoundedQueue<Item> m_queue;
+  std::atomic<int> m_producers;
+  /* for a stage processing blocks in order: the next block it expects, and
+   * how far ahead of it blocks can be (the queue and its producers); 0 if
+   * the stage takes blocks in any order
+   */
+  std::atomic<std::size_t> m_next_seq{0};
+  std::size_t m_window;
+  Link(std::size_t capacity, int producers, bool ordered)
+      : m_queue(capacity), m_producers(producers),
+        m_window(ordered ? m_queue.capacity() + producers : 0) {}
+}; /* struct Link */
+
+/* state shared by all threads of a run */
+struct RunState {
+  std::vector<std::unique_ptr<Link>> m_links;
+  /* blocks done with, back to the source */
+  BoundedQueue<DataBlock> m_recycled;
+  std::atomic<bool> m_failed{false};
+  std::mutex m_error_mtx;
+  std::exception_ptr m_error;
+  std::mutex m_stats_mtx;
+
+  explicit RunState(std::size_t capacity) : m_recycled(capacity) {}
+
+  void fail(std::exception_ptr e) {
+    std::lock_guard<std::mutex> lock(m_error_mtx);
+    if (!m_error) m_error = e;
+    m_failed.store(true, std::memory_order_release);
+  }
+  bool failed() const noexcept {
+    return m_failed.load(std::memory_order_acquire);
+  }
+
+  /* true if block seq is within the window of every ordered stage, i.e.
+   * can be read off the source
+   */
+  bool in_window(std::size_t seq) const noexcept {
+    for (const auto &l : m_links)
+      if (l->m_window &&
+          seq >= l->m_next_seq.load(std::memory_order_acquire) + l->m_window)
+        return false;
+    return true;
+  }
+
+  /* pass an item on (to link, or back to the source if null), waiting
+   * while the queue is full; false if the run failed meanwhile
+   */
+  bool push(Link *link, Item &item, StageStats &stats) {
+    if (!link) {
+      m_recycled.try_push(item.m_block);
+      return true;
+    }
+    if (link->m_queue.try_push(item)) return true;
+    ++stats.m_full_waits;
+    Backoff backoff;
+    while (!link->m_queue.try_push(item)) {
+      if (failed()) return false;
+      backoff.wait();
+    }
+    return true;
+  }
+
+  /* take an item, waiting while the queue is empty; false once all its
+   * producers are done and it is empty (or the run failed)
+   */
+  bool pop(Link &link, Item &item) {
+    Backoff backoff;
+    while (!link.m_queue.try_pop(item)) {
+      if (failed()) return false;
+      if (!link.m_producers.load(std::memory_order_acquire))
+        return link.m_queue.try_pop(item);
+      backoff.wait();
+    }
+    return true;
+  }
+}; /* struct RunState */
+
+} /* unnamed namespace */
+
+dso::doris_rnx::Pipeline::Pipeline(source_fn source,
+                                   std::size_t queue_capacity)
+    : m_source(std::move(source)),
+      m_capacity(queue_capacity ? queue_capacity : 1) {}
+
+dso::doris_rnx::Pipeline &
+dso::doris_rnx::Pipeline::transform(transform_fn fn, int threads) {
+  if (threads <= 0)
+    throw std::runtime_error(
+        "[ERROR] Pipeline stages need at least one thread\n");
+  m_stages.push_back(Stage{std::move(fn), threads});
+  return *this;
+}
+
+dso::doris_rnx::Pipeline &dso::doris_rnx::Pipeline::sink(sink_fn fn,
+                                                         int threads) {
+  return transform(
+      [fn = std::move(fn)](DataBlock &block) {
+        fn(block);
+        return true;
+      },
+      threads);
+}
+
+void dso::doris_rnx::Pipeline::run() {
+  const std::size_t num_stages = m_stages.size();
+  RunState st(m_capacity);
+  for (std::size_t s = 0; s < num_stages; s++)
+    st.m_links.push_back(std::make_unique<Link>(
+        m_capacity, s ? m_stages[s - 1].m_threads : 1,
+        m_stages[s].m_threads == 1));
+  m_stats.assign(num_stages + 1, StageStats{});
+
+  auto link = [&](std::size_t s) {
+    return s < num_stages ? st.m_links[s].get() : nullptr;
+  };
+  auto add_stats = [&](std::size_t i, const StageStats &s) {
+    std::lock_guard<std::mutex> lock(st.m_stats_mtx);
+    m_stats[i].m_blocks_in += s.m_blocks_in;
+    m_stats[i].m_blocks_out += s.m_blocks_out;
+    m_stats[i].m_full_waits += s.m_full_waits;
+  };
+  /* a thread is done feeding the queue of stage s */
+  auto done = [&](std::size_t s) {
+    if (Link *l = link(s))
+      l->m_producers.fetch_sub(1, std::memory_order_release);
+  };
+
+  auto source = [&]() {
+    StageStats stats;
+    try {
+      for (std::size_t seq = 0; !st.failed(); seq++) {
+        /* an ordered stage waiting for an earlier block holds back reading,
+         * so the blocks it keeps aside are bounded
+         */
+        if (!st.in_window(seq)) {
+          ++stats.m_full_waits;
+          Backoff backoff;
+          while (!st.in_window(seq) && !st.failed()) backoff.wait();
+          if (st.failed()) break;
+        }
+        Item item;
+        item.m_seq = seq;
+        st.m_recycled.try_pop(item.m_block);
+        const int status = m_source(item.m_block);
+        if (status < 0) break;
+        if (status > 0)
+          throw std::runtime_error(
+              "[ERROR] Pipeline source failed reading a data block\n");
+        ++stats.m_blocks_in;
+        ++stats.m_blocks_out;
+        if (!st.push(link(0), item, stats)) break;
+      }
+    } catch (...) {
+      st.fail(std::current_exception());
+    }
+    add_stats(0, stats);
+    done(0);
+  };
+
+  auto worker = [&](std::size_t s) {
+    const auto &fn = m_stages[s].m_fn;
+    Link &in = *st.m_links[s];
+    Link *out = link(s + 1);
+    StageStats stats;
+    /* single-threaded stages process blocks in order; blocks that arrive
+     * early wait here, in a ring indexed by block (the source never gets
+     * more than the window ahead of next_seq)
+     */
+    const std::size_t window = in.m_window;
+    std::vector<Item> early(window);
+    std::vector<char> waiting(window, 0);
+    std::size_t next_seq = 0;
+
+    auto process = [&](Item &item) {
+      if (item.m_keep) {
+        ++stats.m_blocks_in;
+        item.m_keep = fn(item.m_block);
+        if (item.m_keep) ++stats.m_blocks_out;
+      }
+      return st.push(out, item, stats);
+    };
+
+    try {
+      Item item;
+      while (st.pop(in, item)) {
+        if (!window) {
+          if (!process(item)) break;
+          continue;
+        }
+        if (item.m_seq != next_seq) {
+          const std::size_t i = item.m_seq % window;
+          early[i] = std::move(item);
+          waiting[i] = 1;
+          continue;
+        }
+        bool ok = process(item);
+        for (;;) {
+          in.m_next_seq.store(++next_seq, std::memory_order_release);
+          const std::size_t i = next_seq % window;
+          if (!ok || !waiting[i]) break;
+          waiting[i] = 0;
+          ok = process(early[i]);
+        }
+        if (!ok) break;
+      }
+    } catch (...) {
+      st.fail(std::current_exception());
+    }
+    add_stats(s + 1, stats);
+    done(s + 1);
+  };
+
+  std::vector<std::thread> threads;
+  threads.emplace_back(source);
+  for (std::size_t s = 0; s < num_stages; s++)
+    for (int t = 0; t < m_stages[s].m_threads; t++)
+      threads.emplace_back(worker, s);
+  for (auto &t : threads) t.join();
+
+  if (st.m_error) std::rethrow_exception(st.m_error);
+}
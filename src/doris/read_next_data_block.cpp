@@ -1,13 +1,23 @@
 #include <charconv>
 #include <cstring>
 #include <exception>
+#include <limits>
 #include <stdexcept>
 
+#include "compact_rinex.hpp"
+#include "data_block.hpp"
 #include "datetime/datetime_read.hpp"
+#include "diagnostics.hpp"
 #include "doris_rinex.hpp"
+#include "doris_rinex_policy.hpp"
+#include "record_offsets.hpp"
 
 namespace {
 
+using dso::doris_rnx::DiagLevel;
+using dso::doris_rnx::diagnose;
+namespace diag = dso::doris_rnx::diag;
+
 const char *skipws(const char *line) noexcept {
   while (*line && *line == ' ') ++line;
   return line;
@@ -44,8 +54,10 @@ const char *skipws(const char *line) noexcept {
  *    |  - 0 otherwise          |           | Max length of line = 59 chars
  *    +-------------------------+-----------+------------------------------
  */
-int resolve_block_epoch(const char *line,
-                        dso::doris_rnx::RinexDataRecordHeader &hdr) noexcept {
+} /* unnamed namespace */
+
+int dso::doris_rnx::resolve_block_epoch(
+    const char *line, dso::doris_rnx::RinexDataRecordHeader &hdr) noexcept {
   /* line must start with '>' character */
   if (*line != '>') return 1;
 
@@ -59,12 +71,7 @@ int resolve_block_epoch(const char *line,
         dso::from_char<dso::YMDFormat::YYYYMMDD, dso::HMSFormat::HHMMSSF,
                        dso::nanoseconds>(line + 2);
   } catch (std::exception &e) {
-    fprintf(
-        stderr,
-        "[ERROR] Failed resolvind date for observation block (traceback: %s)\n",
-        __func__);
-    fprintf(stderr, "[ERROR] Erronuous line was: %s (traceback: %s)\n", line,
-            __func__);
+    diagnose<DiagLevel::error>(diag::DATA_RECORD_EPOCH, __func__, line);
     return 2;
   }
 
@@ -81,10 +88,7 @@ int resolve_block_epoch(const char *line,
   auto cres = std::from_chars(skipws(tbuf), tbuf + 4, val);
   if (cres.ec != std::errc{}) {
     status += 1;
-    fprintf(stderr,
-            "[ERROR] Failed resolving epoch flag from line: \'%s\' (traceback: "
-            "%s)\n",
-            line, __func__);
+    diagnose<DiagLevel::error>(diag::DATA_RECORD_FLAG, __func__, line);
   }
   hdr.m_flag = val;
 
@@ -93,10 +97,7 @@ int resolve_block_epoch(const char *line,
   cres = std::from_chars(skipws(tbuf), tbuf + 4, val);
   if (cres.ec != std::errc{}) {
     status += 1;
-    fprintf(stderr,
-            "[ERROR] Failed resolving #stations from line: \'%s\' (traceback: "
-            "%s)\n",
-            line, __func__);
+    diagnose<DiagLevel::error>(diag::DATA_RECORD_NUM_STATIONS, __func__, line);
   }
   hdr.m_num_stations = val;
 
@@ -112,10 +113,8 @@ int resolve_block_epoch(const char *line,
     cres = std::from_chars(skipws(line + 43), line + sz, hdr.m_clock_offset);
     if (cres.ec != std::errc{}) {
       status += 1;
-      fprintf(stderr,
-              "[ERROR] Failed resolving clock offset from line: \'%s\' "
-              "(traceback: %s)\n",
-              line, __func__);
+      diagnose<DiagLevel::error>(diag::DATA_RECORD_CLOCK_OFFSET, __func__,
+                                 line);
     }
   } else {
     hdr.m_clock_offset = dso::doris_rnx::RECEIVER_CLOCK_OFFSET_MISSING;
@@ -125,132 +124,146 @@ int resolve_block_epoch(const char *line,
   cres = std::from_chars(skipws(line + 56), line + sz, val);
   if (cres.ec != std::errc{}) {
     status += 1;
-    fprintf(stderr,
-            "[ERROR] Failed resolving clock flag from line: \'%s\' (traceback: "
-            "%s)\n",
-            line, __func__);
+    diagnose<DiagLevel::error>(diag::DATA_RECORD_CLOCK_FLAG, __func__, line);
   }
   hdr.m_clock_flag = val;
 
   return status;
 }
 
-} /* unnamed namespace */
+int dso::doris_rnx::special_event_lines(const char *line) noexcept {
+  if (*line != '>' || std::strlen(line) < 37) return -1;
 
-int dso::DorisObsRinex::get_next_data_block(
-    dso::doris_rnx::DataBlock &block) noexcept {
+  /* see resolve_block_epoch for the fields */
+  char tbuf[4] = {'\0'};
+  int flag, num;
+  std::memcpy(tbuf, line + 31, 3);
+  auto cres = std::from_chars(skipws(tbuf), tbuf + 3, flag);
+  if (cres.ec != std::errc{} || flag < 2) return -1;
+  std::memcpy(tbuf, line + 34, 3);
+  cres = std::from_chars(skipws(tbuf), tbuf + 3, num);
+  if (cres.ec != std::errc{} || num < 0) return -1;
+  return num;
+}
+
+int dso::doris_rnx::read_record_line(
+    std::istream &is, dso::doris_rnx::RinexDataRecordHeader &hdr) noexcept {
+  constexpr const int MAX_RECORD_CHARS = dso::DorisObsRinex::MAX_RECORD_CHARS;
   char line[MAX_RECORD_CHARS];
 
-  /* first get and parse the block header (should be next line to be read) */
-  if (!m_stream.getline(line, MAX_RECORD_CHARS)) {
-    if (m_stream.eof()) {
+  /* get and parse the block header (should be next line to be read) */
+  if (!is.getline(line, MAX_RECORD_CHARS)) {
+    if (is.eof()) {
       /* EOF encountered */
       return -1;
     }
-    fprintf(stderr,
-            "[ERROR] Failed reading line from stream! (traceback: %s)\n",
-            __func__);
+    diagnose<DiagLevel::error>(diag::DATA_READ_LINE, __func__, nullptr, is,
+                               is.gcount());
     return 1;
   }
 
-  if (resolve_block_epoch(line, block.mheader)) {
-    fprintf(stderr,
-            "[ERROR] Failed reading data block header! (traceback: %s)\n",
-            __func__);
-    return 1;
+  /* special events: skip the special records that follow; return the
+   * event if it has an epoch, else move on to the next record line. A file
+   * ending before all special records are there is truncated.
+   */
+  for (int n; (n = dso::doris_rnx::special_event_lines(line)) >= 0;) {
+    for (int i = 0; i < n; i++) {
+      is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      if (is.eof() && !is.gcount()) {
+        diagnose<DiagLevel::error>(diag::DATA_BLOCK_TRUNCATED, __func__, line);
+        return 1;
+      }
+    }
+    dso::Datetime<dso::nanoseconds> epoch;
+    if (!dso::doris_rnx::epoch_of_record_line(line, epoch))
+      return dso::doris_rnx::resolve_block_epoch(line, hdr) ? 1 : 0;
+    if (!is.getline(line, MAX_RECORD_CHARS)) return is.eof() ? -1 : 1;
   }
 
-  /* clear observations of block */
-  block.mbeacon_obs.clear();
-
-  /* reserve space */
-  block.mbeacon_obs.reserve(block.mheader.m_num_stations);
-
-  /* buffers */
-  char buf[16] = {'\0'};
-  char *end;
-  double val;
-
-  /* for every beacon in the block */
-  for (int beacon = 0; beacon < block.mheader.m_num_stations; beacon++) {
-    /* create emtpy beacon observation array */
-    block.mbeacon_obs.emplace_back(dso::doris_rnx::BeaconObservations{});
-
-    /* and get an iterator to it (so that we set its values in-place) */
-    auto it = block.mbeacon_obs.end() - 1;
+  if (dso::doris_rnx::resolve_block_epoch(line, hdr)) {
+    diagnose<DiagLevel::error>(diag::DATA_BLOCK_HEADER, __func__, line, is,
+                               is.gcount());
+    return 1;
+  }
 
-    int curobs = 0;  /* current observation count for beacon */
-    int curline = 0; /* current data line of beacon */
+  return 0;
+}
 
-    /* for every observation code described in the RINEX header ... */
-    while (curobs < (int)m_obs_codes.size()) {
-      /* should we change/get the next line ? */
-      if (!(curobs % dso::doris_rnx::MAX_OBS_PER_DATA_LINE)) {
-        m_stream.getline(line, MAX_RECORD_CHARS);
-        /* if this is the first data line for the beacon, get its code */
-        if (!curline) {
-          if ((*line) != 'D') {
-            fprintf(stderr,
-                    "[ERROR] Expected line to start with new beacon, found "
-                    "something else instead! (traceback: %s)\n",
-                    __func__);
-            fprintf(stderr, "[ERROR] Erronuous line was: %s (traceback: %s)\n",
-                    line, __func__);
-            return 1;
-          }
-          std::memcpy(it->m_beacon_id, line, 3);
-        }
-        ++curline;
-      }
+void dso::doris_rnx::report_data_error(int code, const char *line,
+                                       std::istream &is,
+                                       std::streamsize consumed) noexcept {
+  diagnose<DiagLevel::error>(code, "read_data_block", line, is, consumed);
+}
 
-      /* parse observations, one at a time */
-      std::memcpy(
-          buf, line + 3 + (curobs % dso::doris_rnx::MAX_OBS_PER_DATA_LINE) * 16,
-          14);
+int dso::doris_rnx::read_data_block(std::istream &is,
+                                    const dso::DorisRinexHeader &hdr,
+                                    dso::doris_rnx::DataBlock &block) noexcept {
+  return dso::doris_rnx::read_block<dso::doris_rnx::Checked>(is, hdr, block);
+}
 
-      /* check if value is ommited (an ommited value is either left blank, or
-       * is recorded as 0.0)
-       */
-      bool buf_is_empty = true;
-      end = buf;
-      while (*end) {
-        if (!isspace(*end++)) {
-          buf_is_empty = false;
-          break;
-        }
+int dso::DorisObsRinex::get_next_data_block(
+    dso::doris_rnx::DataBlock &block) noexcept {
+  int status;
+  if (m_compact) {
+    status = m_compact->read_data_block(m_stream, *m_header, block);
+  } else if (!m_lenient) {
+    status = doris_rnx::read_data_block(m_stream, *m_header, block);
+  } else {
+    /* lenient: on error, skip to the next record line and try again */
+    for (;;) {
+      const pos_type start = m_stream.tellg();
+      status = doris_rnx::read_data_block(m_stream, *m_header, block);
+      if (status <= 0) break;
+      if (resynchronise(start, status)) {
+        status = -1;
+        break;
       }
+    }
+  }
+  return (status < 0) ? end_of_data() : status;
+}
 
-      char flagm1 =
-          line[3 + (curobs % dso::doris_rnx::MAX_OBS_PER_DATA_LINE) * 16 + 14];
-      char flagm2 =
-          line[3 + (curobs % dso::doris_rnx::MAX_OBS_PER_DATA_LINE) * 16 + 15];
+int dso::DorisObsRinex::end_of_data() noexcept {
+  const auto source = dynamic_cast<const doris_rnx::InputSource *>(
+      m_source.get());
+  if (!source || !source->error()) return -1;
+  doris_rnx::diagnose<doris_rnx::DiagLevel::error>(
+      doris_rnx::diag::DATA_SOURCE_FAILED, __func__, m_filename.c_str());
+  return 1;
+}
 
-      if (buf_is_empty) {
-        val = dso::doris_rnx::OBSERVATION_VALUE_MISSING;
-      } else {
-        auto tres = std::from_chars(skipws(buf), buf + 16, val);
-        if (!(tres.ec == std::errc{})) {
-          fprintf(stderr,
-                  "[ERROR] Failed resolving line [%s]/[%s] (traceback: %s)\n",
-                  line, buf, __func__);
-          return 2;
-        }
-      }
+int dso::DorisObsRinex::resynchronise(pos_type start,
+                                      int error) noexcept {
+  constexpr auto MAX_SKIP = std::numeric_limits<std::streamsize>::max();
 
-      /* push value to the current BeaconObservations instance (in-place)
-       * WAIT! check if we have a scale factor for the observable (note that
-       * the m_obs_scale_factors are in one-to-one correspondance with the
-       * m_obs_codes vector. Hence, we can find the scale factor simply by the
-       * index of the observable. If no scale factor for the observable exists,
-       * then the m_obs_scale_factors should have an '1' in the corresponding
-       * index.
-       */
-      val /= m_obs_scale_factors[curobs];
-      it->m_values.emplace_back(val, flagm1, flagm2);
-      ++curobs;
+  /* go back to the bad block and skip its record line; if we cannot seek
+   * back, go on from (and report) where the error was found
+   */
+  m_stream.clear();
+  if (start != doris_rnx::INVALID_POS && m_stream.seekg(start)) {
+    m_stream.ignore(MAX_SKIP, '\n');
+  } else {
+    m_stream.clear();
+    start = m_stream.tellg();
+    m_stream.clear();
+  }
 
-    } /* for every observation code described in the RINEX header */
-  } /* for every beacon in the block */
+  /* skip to the next line starting with '>' */
+  int c;
+  while ((c = m_stream.peek()) != std::istream::traits_type::eof() &&
+         c != '>')
+    m_stream.ignore(MAX_SKIP, '\n');
 
-  return 0;
-} /* end function */
+  const bool at_eof = (c == std::istream::traits_type::eof());
+  m_stream.clear();
+  const pos_type end = m_stream.tellg();
+  if (m_error_sink) {
+    try {
+      m_error_sink(doris_rnx::SkippedRange{
+          std::streamoff(start), std::streamoff(end), error});
+    } catch (...) {
+      /* a throwing sink must not break reading */
+    }
+  }
+  return at_eof ? -1 : 0;
+}
@@ -1,8 +1,10 @@
-#include "doris_rinex.hpp"
+#include "doris_rinex_header.hpp"
 #include <cstring>
 #include <algorithm>
 #include <charconv>
+#include <cstdint>
 #include "datetime/datetime_read.hpp"
+#include "diagnostics.hpp"
 
 namespace {
 
@@ -22,6 +24,19 @@ int count_length_reverse(const char *str, int from) noexcept {
   return ++from;
 }
 
+/* FNV-1a offset basis and prime (64-bit) */
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+/* Hash a (null-terminated) header line, plus its newline, into h */
+inline std::uint64_t fnv1a(std::uint64_t h, const char *line) noexcept {
+  while (*line) {
+    h ^= static_cast<unsigned char>(*line++);
+    h *= FNV_PRIME;
+  }
+  return (h ^ '\n') * FNV_PRIME;
+}
+
 inline const char *skipws(const char *line) noexcept {
   const char *c = line;
   while (*c && *c == ' ')
@@ -31,18 +46,26 @@ inline const char *skipws(const char *line) noexcept {
 
 } /* unnamed namespace */
 
+dso::DorisRinexHeader::DorisRinexHeader() noexcept {
+  /* pre-allocate vectors */
+  m_obs_codes.reserve(10);
+  m_obs_scale_factors.reserve(10);
+  m_stations.reserve(65);
+  m_ref_stations.reserve(7);
+}
+
 /* 
- * The instance's stream must be open and in good state. If it is not placed
- * at the top of the file, it will be rewinded to the top.
+ * The stream must be open and in good state. If it is not placed at the top
+ * of the file, it will be rewinded to the top.
  */
-int dso::DorisObsRinex::read_header() noexcept {
+int dso::DorisRinexHeader::read(std::istream &is) noexcept {
 
   /* check stream, go to top-of-file if needed */
-  if (!m_stream.is_open() || !m_stream.good())
+  if (!is.good())
     return -1;
 
-  if (m_stream.tellg())
-    m_stream.seekg(0);
+  if (is.tellg())
+    is.seekg(0);
 
   char line[MAX_HEADER_CHARS];
   const char *start = line;
@@ -51,8 +74,25 @@ int dso::DorisObsRinex::read_header() noexcept {
   int obs_types_num = 0;
   int tmp_sz;
 
-  /* first line; RINEX VERSION / TYPE (get version) */
-  m_stream.getline(line, MAX_HEADER_CHARS);
+  /* first line; RINEX VERSION / TYPE (get version). Compact RINEX files
+   * start with two extra lines, CRINEX VERS / TYPE and CRINEX PROG / DATE,
+   * followed by the original header.
+   */
+  m_fingerprint = FNV_OFFSET_BASIS;
+  is.getline(line, MAX_HEADER_CHARS);
+  m_fingerprint = fnv1a(m_fingerprint, line);
+  m_compact = !std::strncmp(line + 60, "CRINEX VERS   / TYPE", 20);
+  /* line number (of the last line read), for diagnostics */
+  long lineno = 2;
+  if (m_compact) {
+    lineno += 2;
+    is.getline(line, MAX_HEADER_CHARS);
+    m_fingerprint = fnv1a(m_fingerprint, line);
+    if (std::strncmp(line + 60, "CRINEX PROG / DATE", 18))
+      return 12;
+    is.getline(line, MAX_HEADER_CHARS);
+    m_fingerprint = fnv1a(m_fingerprint, line);
+  }
   if (std::strncmp(line + 60, "RINEX VERSION / TYPE", 20))
     return 10;
 
@@ -61,13 +101,16 @@ int dso::DorisObsRinex::read_header() noexcept {
     return 11;
 
   /* second line; PGM / RUN BY / DATE (only validate, store nothing) */
-  m_stream.getline(line, MAX_HEADER_CHARS);
+  is.getline(line, MAX_HEADER_CHARS);
+  m_fingerprint = fnv1a(m_fingerprint, line);
   if (std::strncmp(line + 60, "PGM / RUN BY / DATE", 19))
     return 20;
 
   /* read on untill EOH */
   int error = 0;
-  while (m_stream.getline(line, MAX_HEADER_CHARS) && !error) {
+  while (is.getline(line, MAX_HEADER_CHARS) && !error) {
+    ++lineno;
+    m_fingerprint = fnv1a(m_fingerprint, line);
     if (!std::strncmp(line + 60, "SATELLITE NAME", 14)) {
       /* SATELLITE NAME; get m_satellite_name (err. code 30) */
       tmp_sz = count_length_reverse(line, 59);
@@ -319,7 +362,6 @@ int dso::DorisObsRinex::read_header() noexcept {
                                  });
           it == m_stations.cend()) {
         error = 193;
-        fprintf(stderr, "[ERROR] Failed matching 'TIME REF STATION' %s to list of beacons! (traceback: %s)\n", refsta.code(), __func__);
       }
       m_ref_stations.emplace_back(refsta);
 
@@ -347,24 +389,23 @@ int dso::DorisObsRinex::read_header() noexcept {
 
     } else if (!std::strncmp(line + 60, "END OF HEADER", 13)) {
       /* END OF HEADER; all done! break */
-      m_end_of_head = m_stream.tellg();
+      m_end_of_head = is.tellg();
       break;
 
     } else {
-      printf("[DEBUG] Ignoring header line [%s] (traceback: %s)\n", line,
-             __func__);
+      dso::doris_rnx::diagnose<dso::doris_rnx::DiagLevel::debug>(
+          dso::doris_rnx::diag::HEADER_LINE_IGNORED, __func__, line, is,
+          is.gcount(), lineno);
     }
 
     if (error) {
-      fprintf(
-          stderr,
-          "[ERROR] Error while reading RINEX header, code=%d (traceback: %s)\n",
-          error, __func__);
+      dso::doris_rnx::diagnose<dso::doris_rnx::DiagLevel::error>(
+          error, __func__, line, is, is.gcount(), lineno);
     }
   }
 
   /* check stream state */
-  if ((!m_stream.good()) || (!m_end_of_head))
+  if ((!is.good()) || (!m_end_of_head))
     return -2;
 
   /* check for errors */
@@ -380,5 +421,7 @@ int dso::DorisObsRinex::read_header() noexcept {
       (m_ref_stations.size() >= m_stations.size()))
     return -4;
 
+  m_obs_columns = doris_rnx::ObservationColumns(m_obs_codes);
+
   return 0;
 }
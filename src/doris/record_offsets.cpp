@@ -0,0 +1,145 @@
+#include "record_offsets.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+#include "datetime/datetime_read.hpp"
+
+namespace {
+
+/* Enough for any data or (special event) header line */
+constexpr int MAX_LINE_CHARS = 128;
+
+/** Read the next line off the stream into buf. If the line is longer than
+ *  sz-1 chars, it is truncated (and the rest of it is discarded).
+ *  @return false if EOF (or any other error) is encountered, true otherwise
+ */
+bool read_line(std::istream &is, char *buf, int sz) noexcept {
+  if (is.getline(buf, sz)) return true;
+  if (is.eof() || is.bad()) return false;
+  /* line too long; keep what we got and discard the rest */
+  is.clear();
+  is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  return true;
+}
+
+} /* unnamed namespace */
+
+int dso::doris_rnx::epoch_of_record_line(
+    const char *line, dso::Datetime<dso::nanoseconds> &epoch) noexcept {
+  if (*line != '>') return 1;
+  try {
+    epoch = dso::from_char<dso::YMDFormat::YYYYMMDD, dso::HMSFormat::HHMMSSF,
+                           dso::nanoseconds>(line + 2);
+  } catch (std::exception &) {
+    return 2;
+  }
+  return 0;
+}
+
+dso::doris_rnx::pos_type dso::doris_rnx::next_epoch_record(
+    std::istream &is, pos_type at, pos_type lower,
+    dso::Datetime<dso::nanoseconds> &epoch) noexcept {
+  char line[MAX_LINE_CHARS];
+  is.clear();
+
+  if (at <= lower) {
+    is.seekg(lower);
+  } else {
+    /* if at does not mark the start of a line, skip to the next one */
+    is.seekg(std::streamoff(at) - 1);
+    if (is.get() != '\n')
+      is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+
+  while (is) {
+    const pos_type pos = is.tellg();
+    if (!read_line(is, line, MAX_LINE_CHARS)) break;
+    if (!epoch_of_record_line(line, epoch)) {
+      is.seekg(pos);
+      return pos;
+    }
+  }
+
+  is.clear();
+  return INVALID_POS;
+}
+
+dso::doris_rnx::pos_type dso::doris_rnx::previous_epoch_record(
+    std::istream &is, pos_type before, pos_type lower,
+    dso::Datetime<dso::nanoseconds> &epoch) noexcept {
+  char buf[BACKWARD_SCAN_CHUNK_BYTES + 1];
+  char line[MAX_LINE_CHARS];
+  const std::streamoff low = lower;
+  std::streamoff end = before;
+  is.clear();
+
+  /* search for record lines starting in the range [start, end) */
+  while (end > low) {
+    const std::streamoff start =
+        std::max(low, end - BACKWARD_SCAN_CHUNK_BYTES);
+    /* also read the char before start (if any), to detect line starts */
+    const std::streamoff from = (start > low) ? start - 1 : start;
+    is.seekg(from);
+    if (!is.read(buf, end - from)) break;
+    for (std::streamoff p = end - 1; p >= start; --p) {
+      const char *c = buf + (p - from);
+      if (*c == '>' && (p == low || *(c - 1) == '\n')) {
+        is.seekg(p);
+        if (read_line(is, line, MAX_LINE_CHARS) &&
+            !epoch_of_record_line(line, epoch)) {
+          is.seekg(p);
+          return p;
+        }
+        is.clear();
+      }
+    }
+    end = start;
+  }
+
+  is.clear();
+  return INVALID_POS;
+}
+
+dso::doris_rnx::pos_type dso::doris_rnx::stream_size(
+    std::istream &is) noexcept {
+  is.clear();
+  is.seekg(0, std::ios_base::end);
+  const pos_type size = is.tellg();
+  is.clear();
+  return size;
+}
+
+/** Invariant: all records before lo have an epoch earlier than t. The upper
+ *  limit hi only serves to narrow the range; once it is small enough, we
+ *  scan forward from lo, record after record.
+ */
+dso::doris_rnx::pos_type dso::doris_rnx::bisect_epoch_record(
+    std::istream &is, pos_type lower,
+    const dso::Datetime<dso::nanoseconds> &t) noexcept {
+  dso::Datetime<dso::nanoseconds> epoch;
+
+  std::streamoff lo = lower;
+  std::streamoff hi = stream_size(is);
+  if (hi < 0) return INVALID_POS;
+
+  while (hi - lo > BISECTION_LINEAR_SCAN_BYTES) {
+    const std::streamoff mid = lo + (hi - lo) / 2;
+    const pos_type pos = next_epoch_record(is, mid, lower, epoch);
+    if ((pos == INVALID_POS) || (std::streamoff(pos) >= hi) || !(epoch < t)) {
+      hi = mid;
+    } else {
+      lo = pos;
+    }
+  }
+
+  /* linear scan from lo */
+  pos_type pos = lo;
+  while ((pos = next_epoch_record(is, pos, lower, epoch)) != INVALID_POS) {
+    if (!(epoch < t)) return pos;
+    pos = std::streamoff(pos) + 1;
+  }
+
+  return INVALID_POS;
+}
@@ -0,0 +1,100 @@
+#ifndef __DSO_DORIS_RINEX_RECORD_OFFSETS_HPP__
+#define __DSO_DORIS_RINEX_RECORD_OFFSETS_HPP__
+
+#include <istream>
+
+#include "doris_rinex_details.hpp"
+
+namespace dso {
+
+namespace doris_rnx {
+
+/* Let's not write this more than once. */
+typedef std::istream::pos_type pos_type;
+
+/* Marks an invalid/not-found stream position */
+static const pos_type INVALID_POS = pos_type(std::streamoff(-1));
+
+/** When the byte range left to bisect is smaller than this, stop bisecting
+ *  and scan forward linearly (a few data blocks).
+ */
+static constexpr std::streamoff BISECTION_LINEAR_SCAN_BYTES = 4096;
+
+/* Size of chunks read when scanning the stream backwards */
+static constexpr std::streamoff BACKWARD_SCAN_CHUNK_BYTES = 4096;
+
+/** @brief Resolve the epoch of a data record header line (i.e. a line
+ *         starting with '>').
+ *
+ *  @param[in]  line  A (null-terminated) data record header line
+ *  @param[out] epoch The epoch resolved from the line
+ *  @return Anything other than 0 denotes an error (e.g. line does not start
+ *          with '>' or the epoch field is blank/invalid, as can happen for
+ *          special event records).
+ */
+int epoch_of_record_line(const char *line,
+                         Datetime<nanoseconds> &epoch) noexcept;
+
+/** @brief Find the first data record header line (i.e. line starting with
+ *         '>') starting at or after the byte offset at.
+ *
+ *  The offset at can be anywhere in the data section of a file; if it does
+ *  not mark the start of a line, the stream is resynchronised to the start
+ *  of the next line.
+ *
+ *  @param[in] is     The (seekable) input stream
+ *  @param[in] at     Start searching from this byte offset
+ *  @param[in] lower  Offset of the first data line (i.e. END OF HEADER);
+ *                    offsets before this are never considered
+ *  @param[out] epoch Epoch of the record found (if any)
+ *  @return The offset of the record line found, or INVALID_POS if none was
+ *          found. In the first case, the stream is placed at the returned
+ *          offset (i.e. next line to be read is the record line).
+ */
+pos_type next_epoch_record(std::istream &is, pos_type at, pos_type lower,
+                           Datetime<nanoseconds> &epoch) noexcept;
+
+/** @brief Find the last data record header line (i.e. line starting with
+ *         '>') that starts before the byte offset before.
+ *
+ *  The stream is read backwards, in chunks, starting from before; lines
+ *  starting with '>' that do not hold a valid epoch (e.g. special event
+ *  records) are skipped.
+ *
+ *  @param[in] is     The (seekable) input stream
+ *  @param[in] before Search for records starting before this byte offset;
+ *                    this is usually the offset of the current record, or
+ *                    the size of the stream (to get the last record)
+ *  @param[in] lower  Offset of the first data line (i.e. END OF HEADER);
+ *                    offsets before this are never considered
+ *  @param[out] epoch Epoch of the record found (if any)
+ *  @return The offset of the record line found, or INVALID_POS if none was
+ *          found. In the first case, the stream is placed at the returned
+ *          offset (i.e. next line to be read is the record line).
+ */
+pos_type previous_epoch_record(std::istream &is, pos_type before,
+                               pos_type lower,
+                               Datetime<nanoseconds> &epoch) noexcept;
+
+/** @brief Size of the stream in bytes, or INVALID_POS on error. The stream
+ *         is left at EOF.
+ */
+pos_type stream_size(std::istream &is) noexcept;
+
+/** @brief Find the first data record with an epoch equal to or later than
+ *         t, using bisection on byte offsets (no index needed).
+ *
+ *  @param[in] is    The (seekable) input stream
+ *  @param[in] lower Offset of the first data line (i.e. END OF HEADER)
+ *  @param[in] t     The epoch to search for
+ *  @return The offset of the record line found, or INVALID_POS if no such
+ *          record exists. In the first case, the stream is placed at the
+ *          returned offset.
+ */
+pos_type bisect_epoch_record(std::istream &is, pos_type lower,
+                             const Datetime<nanoseconds> &t) noexcept;
+
+} /* namespace doris_rnx */
+} /* namespace dso */
+
+#endif
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+#include "doris_rinex_kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RNX_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using dso::doris_rnx::kernels::FIELD_BLANK;
+using dso::doris_rnx::kernels::FIELD_CHARS;
+using dso::doris_rnx::kernels::FIELD_IRREGULAR;
+using dso::doris_rnx::kernels::FIELD_VALUE;
+using dso::doris_rnx::kernels::FLAG_OTHER;
+using dso::doris_rnx::kernels::Isa;
+
+/* the 14 characters of the value of a field */
+constexpr unsigned VALUE_BITS = 0x3fff;
+/* position of the decimal point (F14.3) */
+constexpr int DOT_AT = 10;
+
+/** Classify a field off its character masks (bit i for char i): blanks,
+ *  digits and minus signs. A value is [blanks][-]digits.ddd, with the
+ *  decimal point at DOT_AT.
+ */
+inline std::uint8_t classify(unsigned blank, unsigned digit, unsigned minus,
+                             bool dot) noexcept {
+  if ((blank & VALUE_BITS) == VALUE_BITS) return FIELD_BLANK;
+  if (!dot || (digit & 0x3800) != 0x3800) return FIELD_IRREGULAR;
+  /* integer digits, a run ending right before the decimal point */
+  const unsigned idigits = digit & 0x3ff;
+  if (!idigits) return FIELD_IRREGULAR;
+  const int first = __builtin_ctz(idigits);
+  if (idigits != (0x3ffu & ~((1u << first) - 1))) return FIELD_IRREGULAR;
+  /* blanks before, possibly followed by a minus sign */
+  const unsigned lead = (1u << first) - 1;
+  if ((blank & lead) == lead) return FIELD_VALUE;
+  if ((minus >> (first - 1)) & 1) {
+    const unsigned blanks = lead >> 1;
+    if ((blank & blanks) == blanks) return FIELD_VALUE;
+  }
+  return FIELD_IRREGULAR;
+}
+
+/* Sign the magnitude x of a FIELD_VALUE field; a negative zero has no
+ * (integer) mantissa, so such a field is left to the parser
+ */
+inline void sign_mantissa(std::int64_t x, bool negative,
+                          std::int64_t &mantissa,
+                          std::uint8_t &status) noexcept {
+  mantissa = negative ? -x : x;
+  if (negative && !x) status = FIELD_IRREGULAR;
+}
+
+/* ------------------------------------------------------------------------
+ * Portable variants
+ * ------------------------------------------------------------------------ */
+
+void decode_one_generic(const char *f, std::int64_t &mantissa,
+                        std::uint8_t &status) noexcept {
+  unsigned blank = 0, digit = 0, minus = 0;
+  for (int i = 0; i < 14; i++) {
+    blank |= (unsigned)(f[i] == ' ') << i;
+    digit |= (unsigned)(f[i] >= '0' && f[i] <= '9') << i;
+    minus |= (unsigned)(f[i] == '-') << i;
+  }
+  status = classify(blank, digit, minus, f[DOT_AT] == '.');
+  if (status != FIELD_VALUE) return;
+  std::int64_t x = 0;
+  for (int i = 0; i < 14; i++)
+    if ((digit >> i) & 1) x = x * 10 + (f[i] - '0');
+  sign_mantissa(x, minus & VALUE_BITS, mantissa, status);
+}
+
+void decode_fields_generic(const char *fields, int n, std::int64_t *mantissa,
+                           std::uint8_t *status) noexcept {
+  for (int k = 0; k < n; k++)
+    decode_one_generic(fields + k * FIELD_CHARS, mantissa[k], status[k]);
+}
+
+void scale_values_generic(const std::int64_t *mantissa, std::size_t n,
+                          double unit, double scale, double *out) noexcept {
+  for (std::size_t i = 0; i < n; i++) out[i] = (mantissa[i] / unit) / scale;
+}
+
+void pack_flags_generic(const char *flags, std::size_t n,
+                        std::uint8_t *packed) noexcept {
+  using dso::doris_rnx::kernels::flag_code;
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    packed[i / 2] = flag_code(flags[i]) | (flag_code(flags[i + 1]) << 4);
+  if (i < n) packed[i / 2] = flag_code(flags[i]);
+}
+
+void flag_mask_generic(const std::uint8_t *packed, std::size_t n,
+                       std::uint8_t lo, std::uint8_t hi,
+                       std::uint64_t *mask) noexcept {
+  for (std::size_t w = 0; w < (n + 63) / 64; w++) {
+    std::uint64_t bits = 0;
+    const std::size_t end = std::min(n - 64 * w, (std::size_t)64);
+    for (std::size_t j = 0; j < end; j++) {
+      const std::size_t i = 64 * w + j;
+      const unsigned code = (packed[i / 2] >> (4 * (i & 1))) & 0xf;
+      bits |= (std::uint64_t)(code >= lo && code <= hi) << j;
+    }
+    mask[w] = bits;
+  }
+}
+
+#ifdef RNX_X86_KERNELS
+/* ------------------------------------------------------------------------
+ * x86 variants. Per 128-bit lane (i.e. per field), digits are moved so that
+ * the mantissa is a 16-digit integer (decimal point dropped), which is
+ * then resolved by pairwise multiply-adds: 1 -> 2 -> 4 -> 8 digits.
+ * ------------------------------------------------------------------------ */
+
+/* lanes 3..12 (integer digits) and 13..15 (decimals) */
+#define RNX_INT_LANES 0, 0, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0
+#define RNX_DEC_LANES 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, -1, -1
+
+__attribute__((target("sse2"))) inline void
+decode_one_sse2(const char *f, std::int64_t &mantissa,
+                std::uint8_t &status) noexcept {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(f));
+  const __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+  const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  const unsigned blank =
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+  const unsigned digit = _mm_movemask_epi8(is_digit);
+  const unsigned minus =
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+  status = classify(blank, digit, minus, f[DOT_AT] == '.');
+  if (status != FIELD_VALUE) return;
+
+  const __m128i z = _mm_and_si128(d, is_digit);
+  const __m128i w = _mm_or_si128(
+      _mm_and_si128(_mm_slli_si128(z, 3), _mm_setr_epi8(RNX_INT_LANES)),
+      _mm_and_si128(_mm_slli_si128(z, 2), _mm_setr_epi8(RNX_DEC_LANES)));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i w10 = _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1);
+  const __m128i p = _mm_packs_epi32(
+      _mm_madd_epi16(_mm_unpacklo_epi8(w, zero), w10),
+      _mm_madd_epi16(_mm_unpackhi_epi8(w, zero), w10));
+  const __m128i q =
+      _mm_madd_epi16(p, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+  const __m128i r = _mm_madd_epi16(
+      _mm_packs_epi32(q, q),
+      _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+  const std::int64_t x =
+      (std::int64_t)_mm_cvtsi128_si32(r) * 100000000 +
+      _mm_cvtsi128_si32(_mm_srli_si128(r, 4));
+  sign_mantissa(x, minus & VALUE_BITS, mantissa, status);
+}
+
+__attribute__((target("sse2"))) void
+decode_fields_sse2(const char *fields, int n, std::int64_t *mantissa,
+                   std::uint8_t *status) noexcept {
+  for (int k = 0; k < n; k++)
+    decode_one_sse2(fields + k * FIELD_CHARS, mantissa[k], status[k]);
+}
+
+__attribute__((target("sse2"))) void
+scale_values_sse2(const std::int64_t *mantissa, std::size_t n, double unit,
+                  double scale, double *out) noexcept {
+  const __m128d u = _mm_set1_pd(unit);
+  const __m128d s = _mm_set1_pd(scale);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128d x = _mm_setr_pd((double)mantissa[i], (double)mantissa[i + 1]);
+    _mm_storeu_pd(out + i, _mm_div_pd(_mm_div_pd(x, u), s));
+  }
+  for (; i < n; i++) out[i] = (mantissa[i] / unit) / scale;
+}
+
+/* two fields at a time */
+__attribute__((target("avx2"))) void
+decode_fields_avx2(const char *fields, int n, std::int64_t *mantissa,
+                   std::uint8_t *status) noexcept {
+  int k = 0;
+  for (; k + 2 <= n; k += 2) {
+    const char *f = fields + k * FIELD_CHARS;
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(f));
+    const __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    const __m256i is_digit =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    const unsigned blank =
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+    const unsigned digit = _mm256_movemask_epi8(is_digit);
+    const unsigned minus =
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+    status[k] = classify(blank, digit, minus, f[DOT_AT] == '.');
+    status[k + 1] = classify(blank >> 16, digit >> 16, minus >> 16,
+                             f[FIELD_CHARS + DOT_AT] == '.');
+    if (status[k] != FIELD_VALUE && status[k + 1] != FIELD_VALUE) continue;
+
+    const __m256i z = _mm256_and_si256(d, is_digit);
+    const __m256i w = _mm256_or_si256(
+        _mm256_and_si256(_mm256_slli_si256(z, 3),
+                         _mm256_setr_epi8(RNX_INT_LANES, RNX_INT_LANES)),
+        _mm256_and_si256(_mm256_slli_si256(z, 2),
+                         _mm256_setr_epi8(RNX_DEC_LANES, RNX_DEC_LANES)));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i w10 = _mm256_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                          10, 1, 10, 1, 10, 1);
+    const __m256i p = _mm256_packs_epi32(
+        _mm256_madd_epi16(_mm256_unpacklo_epi8(w, zero), w10),
+        _mm256_madd_epi16(_mm256_unpackhi_epi8(w, zero), w10));
+    const __m256i q = _mm256_madd_epi16(
+        p, _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1,
+                             100, 1, 100, 1));
+    const __m256i r = _mm256_madd_epi16(
+        _mm256_packs_epi32(q, q),
+        _mm256_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                          10000, 1, 10000, 1, 10000, 1));
+    alignas(32) std::int32_t s[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(s), r);
+    for (int j = 0; j < 2; j++) {
+      const std::int64_t x = (std::int64_t)s[4 * j] * 100000000 + s[4 * j + 1];
+      sign_mantissa(x, (minus >> (16 * j)) & VALUE_BITS, mantissa[k + j],
+                    status[k + j]);
+    }
+  }
+  for (; k < n; k++)
+    decode_one_sse2(fields + k * FIELD_CHARS, mantissa[k], status[k]);
+}
+
+__attribute__((target("avx2"))) void
+scale_values_avx2(const std::int64_t *mantissa, std::size_t n, double unit,
+                  double scale, double *out) noexcept {
+  const __m256d u = _mm256_set1_pd(unit);
+  const __m256d s = _mm256_set1_pd(scale);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    /* no packed int64 -> double conversion before AVX-512 */
+    const __m256d x =
+        _mm256_setr_pd((double)mantissa[i], (double)mantissa[i + 1],
+                       (double)mantissa[i + 2], (double)mantissa[i + 3]);
+    _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_div_pd(x, u), s));
+  }
+  for (; i < n; i++) out[i] = (mantissa[i] / unit) / scale;
+}
+
+/* four fields at a time */
+__attribute__((target("avx512f,avx512bw,avx512dq"))) void
+decode_fields_avx512(const char *fields, int n, std::int64_t *mantissa,
+                     std::uint8_t *status) noexcept {
+  int k = 0;
+  for (; k + 4 <= n; k += 4) {
+    const char *f = fields + k * FIELD_CHARS;
+    const __m512i v = _mm512_loadu_si512(f);
+    const __m512i d = _mm512_sub_epi8(v, _mm512_set1_epi8('0'));
+    const __mmask64 is_digit =
+        _mm512_cmple_epu8_mask(d, _mm512_set1_epi8(9));
+    const std::uint64_t blank =
+        _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' '));
+    const std::uint64_t digit = is_digit;
+    const std::uint64_t minus =
+        _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('-'));
+    bool any = false;
+    for (int j = 0; j < 4; j++) {
+      status[k + j] = classify(blank >> (16 * j), digit >> (16 * j),
+                               minus >> (16 * j),
+                               f[j * FIELD_CHARS + DOT_AT] == '.');
+      any |= (status[k + j] == FIELD_VALUE);
+    }
+    if (!any) continue;
+
+    /* RNX_INT_LANES and RNX_DEC_LANES, in each 128-bit lane */
+    const __m512i int_lanes =
+        _mm512_set4_epi64(0x000000ffffffffffLL, (long long)0xffffffffff000000ULL,
+                          0x000000ffffffffffLL, (long long)0xffffffffff000000ULL);
+    const __m512i dec_lanes = _mm512_set4_epi64(
+        (long long)0xffffff0000000000ULL, 0, (long long)0xffffff0000000000ULL, 0);
+    const __m512i z = _mm512_maskz_mov_epi8(is_digit, d);
+    const __m512i w = _mm512_or_si512(
+        _mm512_and_si512(_mm512_bslli_epi128(z, 3), int_lanes),
+        _mm512_and_si512(_mm512_bslli_epi128(z, 2), dec_lanes));
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i w10 = _mm512_set1_epi32(0x0001000a);
+    const __m512i p = _mm512_packs_epi32(
+        _mm512_madd_epi16(_mm512_unpacklo_epi8(w, zero), w10),
+        _mm512_madd_epi16(_mm512_unpackhi_epi8(w, zero), w10));
+    const __m512i q = _mm512_madd_epi16(p, _mm512_set1_epi32(0x00010064));
+    const __m512i r = _mm512_madd_epi16(_mm512_packs_epi32(q, q),
+                                        _mm512_set1_epi32(0x00012710));
+    alignas(64) std::int32_t s[16];
+    _mm512_store_si512(s, r);
+    for (int j = 0; j < 4; j++) {
+      const std::int64_t x = (std::int64_t)s[4 * j] * 100000000 + s[4 * j + 1];
+      sign_mantissa(x, (minus >> (16 * j)) & VALUE_BITS, mantissa[k + j],
+                    status[k + j]);
+    }
+  }
+  for (; k < n; k++)
+    decode_one_sse2(fields + k * FIELD_CHARS, mantissa[k], status[k]);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void
+scale_values_avx512(const std::int64_t *mantissa, std::size_t n, double unit,
+                    double scale, double *out) noexcept {
+  const __m512d u = _mm512_set1_pd(unit);
+  const __m512d s = _mm512_set1_pd(scale);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512d x = _mm512_cvtepi64_pd(_mm512_loadu_si512(mantissa + i));
+    _mm512_storeu_pd(out + i, _mm512_div_pd(_mm512_div_pd(x, u), s));
+  }
+  for (; i < n; i++) out[i] = (mantissa[i] / unit) / scale;
+}
+/* 64 flags at a time */
+__attribute__((target("avx2"))) void
+pack_flags_avx2(const char *flags, std::size_t n,
+                std::uint8_t *packed) noexcept {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi8(1);
+  const __m256i other = _mm256_set1_epi8(FLAG_OTHER);
+  /* low nibble (x1) plus high nibble (x16), per pair of flags */
+  const __m256i weights = _mm256_set1_epi16(0x1001);
+  std::size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m256i code[2];
+    for (int h = 0; h < 2; h++) {
+      const __m256i c = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(flags + i + 32 * h));
+      const __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+      const __m256i is_digit =
+          _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+      const __m256i is_blank = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+      const __m256i nondigit = _mm256_blendv_epi8(other, zero, is_blank);
+      code[h] = _mm256_maddubs_epi16(
+          _mm256_blendv_epi8(nondigit, _mm256_add_epi8(d, one), is_digit),
+          weights);
+    }
+    /* packus works per 128-bit lane; restore the order of the quadwords */
+    const __m256i bytes = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(code[0], code[1]), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(packed + i / 2), bytes);
+  }
+  if (i < n) pack_flags_generic(flags + i, n - i, packed + i / 2);
+}
+
+__attribute__((target("avx2"))) void
+flag_mask_avx2(const std::uint8_t *packed, std::size_t n, std::uint8_t lo,
+               std::uint8_t hi, std::uint64_t *mask) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i vlo = _mm256_set1_epi8(lo);
+  const __m256i range = _mm256_set1_epi8(hi - lo);
+  std::size_t w = 0;
+  for (; 64 * (w + 1) <= n && hi >= lo; w++) {
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(packed + 32 * w));
+    /* lo <= code <= hi, as (code - lo) <= (hi - lo), unsigned */
+    __m256i in[2];
+    in[0] = _mm256_sub_epi8(_mm256_and_si256(b, nibble), vlo);
+    in[1] = _mm256_sub_epi8(
+        _mm256_and_si256(_mm256_srli_epi16(b, 4), nibble), vlo);
+    for (auto &x : in)
+      x = _mm256_cmpeq_epi8(_mm256_min_epu8(x, range), x);
+    /* interleave even (low nibble) and odd (high nibble) flags */
+    const __m256i a = _mm256_unpacklo_epi8(in[0], in[1]);
+    const __m256i c = _mm256_unpackhi_epi8(in[0], in[1]);
+    const std::uint32_t m0 =
+        _mm256_movemask_epi8(_mm256_permute2x128_si256(a, c, 0x20));
+    const std::uint32_t m1 =
+        _mm256_movemask_epi8(_mm256_permute2x128_si256(a, c, 0x31));
+    mask[w] = m0 | ((std::uint64_t)m1 << 32);
+  }
+  if (64 * w < n)
+    flag_mask_generic(packed + 32 * w, n - 64 * w, lo, hi, mask + w);
+}
+#endif /* RNX_X86_KERNELS */
+
+/* ------------------------------------------------------------------------
+ * Dispatch
+ * ------------------------------------------------------------------------ */
+
+using decode_fn = void (*)(const char *, int, std::int64_t *,
+                           std::uint8_t *) noexcept;
+using pack_fn = void (*)(const char *, std::size_t, std::uint8_t *) noexcept;
+using mask_fn = void (*)(const std::uint8_t *, std::size_t, std::uint8_t,
+                         std::uint8_t, std::uint64_t *) noexcept;
+using scale_fn = void (*)(const std::int64_t *, std::size_t, double, double,
+                          double *) noexcept;
+
+/* the kernels in use; constant-initialized to the portable variants (so
+ * they are usable before dynamic initialization), then upgraded at load
+ * time
+ */
+Isa active = Isa::generic;
+decode_fn decode = decode_fields_generic;
+scale_fn scale = scale_values_generic;
+pack_fn pack = pack_flags_generic;
+mask_fn mask = flag_mask_generic;
+
+bool supported(Isa isa) noexcept {
+  switch (isa) {
+    case Isa::generic:
+      return true;
+#ifdef RNX_X86_KERNELS
+    case Isa::sse2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+    case Isa::avx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+    case Isa::avx512:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512dq");
+#endif
+    default:
+      return false;
+  }
+}
+
+/* select the best variant the CPU supports, at load time */
+struct Dispatcher {
+  Dispatcher() noexcept {
+    for (Isa isa : {Isa::avx512, Isa::avx2, Isa::sse2})
+      if (dso::doris_rnx::kernels::select_isa(isa)) break;
+  }
+} dispatcher;
+
+} /* unnamed namespace */
+
+dso::doris_rnx::kernels::Isa dso::doris_rnx::kernels::active_isa() noexcept {
+  return active;
+}
+
+const char *dso::doris_rnx::kernels::isa_name(Isa isa) noexcept {
+  switch (isa) {
+    case Isa::sse2:
+      return "sse2";
+    case Isa::avx2:
+      return "avx2";
+    case Isa::avx512:
+      return "avx512";
+    default:
+      return "generic";
+  }
+}
+
+bool dso::doris_rnx::kernels::select_isa(Isa isa) noexcept {
+  if (!supported(isa)) return false;
+  switch (isa) {
+#ifdef RNX_X86_KERNELS
+    case Isa::sse2:
+      decode = decode_fields_sse2;
+      scale = scale_values_sse2;
+      pack = pack_flags_generic;
+      mask = flag_mask_generic;
+      break;
+    case Isa::avx2:
+      decode = decode_fields_avx2;
+      scale = scale_values_avx2;
+      pack = pack_flags_avx2;
+      mask = flag_mask_avx2;
+      break;
+    case Isa::avx512:
+      decode = decode_fields_avx512;
+      scale = scale_values_avx512;
+      pack = pack_flags_avx2;
+      mask = flag_mask_avx2;
+      break;
+#endif
+    default:
+      decode = decode_fields_generic;
+      scale = scale_values_generic;
+      pack = pack_flags_generic;
+      mask = flag_mask_generic;
+      break;
+  }
+  active = isa;
+  return true;
+}
+
+void dso::doris_rnx::kernels::decode_fields(const char *fields, int n,
+                                            std::int64_t *mantissa,
+                                            std::uint8_t *status) noexcept {
+  decode(fields, n, mantissa, status);
+}
+
+void dso::doris_rnx::kernels::scale_values(const std::int64_t *mantissa,
+                                           std::size_t n, double unit,
+                                           double s, double *out) noexcept {
+  scale(mantissa, n, unit, s, out);
+}
+
+void dso::doris_rnx::kernels::pack_flags(const char *flags, std::size_t n,
+                                         std::uint8_t *packed) noexcept {
+  pack(flags, n, packed);
+}
+
+void dso::doris_rnx::kernels::flag_mask(const std::uint8_t *packed,
+                                        std::size_t n, std::uint8_t lo,
+                                        std::uint8_t hi,
+                                        std::uint64_t *m) noexcept {
+  mask(packed, n, lo, hi, m);
+}
@@ -0,0 +1,215 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_archive.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+namespace {
+/* blocks must be bitwise equal (missing values included) */
+void compare(const doris_rnx::DataBlock &a, const doris_rnx::DataBlock &b) {
+  assert(a.mheader.m_epoch == b.mheader.m_epoch);
+  assert(a.mheader.m_flag == b.mheader.m_flag);
+  assert(a.mheader.m_clock_flag == b.mheader.m_clock_flag);
+  assert(a.mheader.m_num_stations == b.mheader.m_num_stations);
+  assert(!std::memcmp(&a.mheader.m_clock_offset, &b.mheader.m_clock_offset,
+                      sizeof(double)));
+  assert(a.mbeacon_obs.size() == b.mbeacon_obs.size());
+  for (std::size_t j = 0; j < a.mbeacon_obs.size(); j++) {
+    const auto &x = a.mbeacon_obs[j];
+    const auto &y = b.mbeacon_obs[j];
+    assert(!std::strcmp(x.id(), y.id()));
+    assert(x.m_values.size() == y.m_values.size());
+    for (std::size_t k = 0; k < x.m_values.size(); k++) {
+      assert(!std::memcmp(&x.m_values[k].m_value, &y.m_values[k].m_value,
+                          sizeof(double)));
+      assert(x.m_values[k].m_flag1 == y.m_values[k].m_flag1);
+      assert(x.m_values[k].m_flag2 == y.m_values[k].m_flag2);
+    }
+  }
+}
+} /* unnamed namespace */
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx(argv[1]);
+  std::vector<doris_rnx::DataBlock> blocks;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) blocks.push_back(*it);
+  assert(!blocks.empty());
+
+  std::ifstream fin(argv[1], std::ios_base::binary | std::ios_base::ate);
+  const long rinex_size = fin.tellg();
+
+  /* a few chunk sizes, including a partial last chunk and single-epoch
+   * chunks
+   */
+  for (int chunk : {doris_rnx::DEFAULT_ARCHIVE_CHUNK_EPOCHS, 100, 7, 1}) {
+    std::stringstream ar(std::ios_base::in | std::ios_base::out |
+                         std::ios_base::binary);
+    {
+      doris_rnx::ArchiveWriter writer(ar, rnx.header(), chunk);
+      for (const auto &b : blocks) assert(!writer.append(b));
+      assert(!writer.flush());
+    }
+    const std::size_t size = ar.str().size();
+    printf("Chunk size %4d: RINEX size %ld, archive size %zu (ratio %.2f)\n",
+           chunk, rinex_size, size, (double)rinex_size / size);
+
+    doris_rnx::ArchiveReader reader(ar);
+    assert(reader.obs_codes() == rnx.header().obs_codes());
+    assert(reader.obs_scale_factors() == rnx.header().obs_scale_factors());
+    assert(!std::strcmp(reader.satellite_name(), rnx.satellite_name()));
+    doris_rnx::DataBlock block;
+    std::size_t i = 0;
+    int status;
+    while (!(status = reader.next(block))) {
+      assert(i < blocks.size());
+      compare(block, blocks[i]);
+      ++i;
+    }
+    assert(status < 0);
+    assert(i == blocks.size());
+  }
+
+  /* zone maps; skip chunks via filters */
+  {
+    constexpr int chunk = 50;
+    std::stringstream ar(std::ios_base::in | std::ios_base::out |
+                         std::ios_base::binary);
+    {
+      doris_rnx::ArchiveWriter writer(ar, rnx.header(), chunk);
+      for (const auto &b : blocks) assert(!writer.append(b));
+    }
+    const std::string data = ar.str();
+    const long num_chunks = (blocks.size() + chunk - 1) / chunk;
+
+    /* zone maps match the blocks of each chunk */
+    {
+      std::istringstream is(data);
+      doris_rnx::ArchiveReader reader(is);
+      doris_rnx::DataBlock block;
+      for (std::size_t i = 0; !reader.next(block); i++) {
+        const auto &zm = reader.zone_map();
+        assert(zm.m_num_epochs ==
+               std::min<int>(chunk, blocks.size() - (i / chunk) * chunk));
+        const auto &first = blocks[(i / chunk) * chunk];
+        assert(zm.m_first_epoch == first.mheader.m_epoch);
+        assert(!(block.mheader.m_epoch < zm.m_first_epoch));
+        assert(!(zm.m_last_epoch < block.mheader.m_epoch));
+        for (const auto &bobs : block.mbeacon_obs) {
+          assert(zm.may_have_beacon(bobs.id()));
+          for (std::size_t k = 0; k < bobs.m_values.size(); k++) {
+            const double v = bobs.m_values[k].m_value;
+            if (v == doris_rnx::OBSERVATION_VALUE_MISSING /
+                         rnx.header().obs_scale_factors()[k])
+              continue;
+            assert(zm.m_min[k] <= v && v <= zm.m_max[k]);
+          }
+        }
+      }
+      assert(reader.chunks_read() == num_chunks);
+      assert(!reader.chunks_skipped());
+    }
+
+    /* time window: only the chunks overlapping it are decoded */
+    {
+      const auto from = blocks[blocks.size() / 2].mheader.m_epoch;
+      const auto to = blocks[blocks.size() / 2 + chunk].mheader.m_epoch;
+      std::istringstream is(data);
+      doris_rnx::ArchiveReader reader(is);
+      reader.set_chunk_filter([&](const doris_rnx::ChunkZoneMap &zm) {
+        return zm.overlaps(from, to);
+      });
+      doris_rnx::DataBlock block;
+      std::size_t in_window = 0;
+      while (!reader.next(block)) {
+        in_window += !(block.mheader.m_epoch < from) &&
+                     !(to < block.mheader.m_epoch);
+      }
+      assert(in_window == chunk + 1);
+      assert(reader.chunks_read() <= 3);
+      assert(reader.chunks_read() + reader.chunks_skipped() == num_chunks);
+    }
+
+    /* a beacon that is never observed: all chunks skipped */
+    {
+      std::istringstream is(data);
+      doris_rnx::ArchiveReader reader(is);
+      reader.set_chunk_filter([](const doris_rnx::ChunkZoneMap &zm) {
+        return zm.may_have_beacon("D99");
+      });
+      doris_rnx::DataBlock block;
+      assert(reader.next(block) < 0);
+      assert(reader.chunks_skipped() == num_chunks);
+    }
+
+    /* corrupt chunks: the offset of the first chunk frame is the size of an
+     * archive with no blocks
+     */
+    std::stringstream empty(std::ios_base::in | std::ios_base::out |
+                            std::ios_base::binary);
+    { doris_rnx::ArchiveWriter writer(empty, rnx.header(), chunk); }
+    const std::size_t first = empty.str().size();
+    auto u32 = [](const std::string &s, std::size_t pos) {
+      std::uint32_t v = 0;
+      for (int i = 0; i < 4; i++)
+        v |= (std::uint32_t)(unsigned char)s[pos + i] << (8 * i);
+      return v;
+    };
+
+    /* a (zone map) size that would wrap around */
+    {
+      std::string bad = data;
+      for (int i = 4; i < 8; i++) bad[first + i] = (char)0xff;
+      std::istringstream is(bad);
+      doris_rnx::ArchiveReader reader(is);
+      doris_rnx::DataBlock block;
+      assert(reader.next(block) > 0);
+      assert(reader.next(block));
+    }
+
+    /* a payload that cannot be decoded: no epochs served off it, reading
+     * goes on with the next chunk
+     */
+    {
+      std::string bad = data;
+      const std::size_t zsize = u32(bad, first + 4);
+      const std::size_t pos = first + 8 + zsize + 4;
+      const std::size_t psize = u32(bad, pos - 4);
+      for (std::size_t i = 0; i < psize; i++) bad[pos + i] = (char)0xff;
+      std::istringstream is(bad);
+      doris_rnx::ArchiveReader reader(is);
+      doris_rnx::DataBlock block;
+      assert(reader.next(block) > 0);
+      assert(!reader.next(block));
+      assert(block.mheader.m_epoch == blocks[chunk].mheader.m_epoch);
+    }
+  }
+
+  /* not an archive */
+  std::istringstream bad("not an archive");
+  bool thrown = false;
+  try {
+    doris_rnx::ArchiveReader reader(bad);
+  } catch (std::exception &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  printf("All checks ok\n");
+  return 0;
+}
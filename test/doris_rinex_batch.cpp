@@ -0,0 +1,92 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_batch.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX] ...\n", argv[0]);
+    return 1;
+  }
+
+  /* reference: number of blocks per file, read sequentially */
+  std::vector<std::string> files;
+  std::vector<long> expected;
+  for (int i = 1; i < argc; i++) {
+    DorisObsRinex rnx(argv[i]);
+    long n = 0;
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ++n;
+    files.emplace_back(argv[i]);
+    expected.push_back(n);
+  }
+  /* repeat the list, so that there are more files than reads in flight */
+  const std::size_t num_files = files.size();
+  for (int r = 0; r < 20; r++) {
+    for (std::size_t i = 0; i < num_files; i++) {
+      files.push_back(files[i]);
+      expected.push_back(expected[i]);
+    }
+  }
+  /* plus a file that does not exist */
+  files.emplace_back("/nonexistent/file.001");
+  expected.push_back(-1);
+
+  /* plus files that are not RINEX (garbage, empty), and one with a bad first
+   * block; all fail, without stopping the others
+   */
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  const auto eoh = content.find("END OF HEADER");
+  assert(eoh != std::string::npos);
+  content[content.find('>', eoh) + 2] = 'x';
+  const std::string base(argv[1]);
+  const std::vector<std::pair<std::string, std::string>> bad = {
+      {base + ".garbage", "this is not a RINEX file\n"},
+      {base + ".empty", ""},
+      {base + ".badblock", content}};
+  for (const auto &f : bad) {
+    std::ofstream(f.first, std::ios_base::binary) << f.second;
+    files.push_back(f.first);
+    expected.push_back(-1);
+  }
+
+  printf("io_uring available: %s\n",
+         doris_rnx::io_uring_available() ? "yes" : "no");
+
+  for (bool uring : {true, false}) {
+    std::vector<std::atomic<long>> blocks(files.size());
+    for (auto &b : blocks) b = -1;
+    doris_rnx::BatchOptions opts;
+    opts.m_num_threads = 4;
+    opts.m_queue_depth = 8;
+    opts.m_use_io_uring = uring;
+    const int failed = doris_rnx::ingest_files(
+        files,
+        [&](std::size_t index, DorisObsRinex &rnx) {
+          long n = 0;
+          for (auto it = rnx.begin(); it != rnx.end(); ++it) ++n;
+          blocks[index] = n;
+        },
+        opts);
+    assert(failed == 1 + (int)bad.size());
+    for (std::size_t i = 0; i < files.size(); i++)
+      assert(blocks[i] == expected[i]);
+    printf("Batch of %zu files (io_uring requested: %d) ok\n", files.size(),
+           uring);
+  }
+
+  for (const auto &f : bad) std::remove(f.first.c_str());
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "doris_rinex.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* checkpoint after block k of fn (serialized), resume off a new instance of
+ * fn2 and check the remaining epochs
+ */
+void check_resume(const char *fn, const char *fn2,
+                  const std::vector<Datetime<nanoseconds>> &epochs,
+                  std::size_t k) {
+  char buf[doris_rnx::Checkpoint::SERIALIZED_SIZE];
+  {
+    DorisObsRinex rnx(fn);
+    auto it = rnx.begin();
+    for (std::size_t i = 0; i < k; i++) ++it;
+    const auto cp = rnx.checkpoint(it);
+    assert(cp.has_last_epoch() == (k < epochs.size()));
+    if (cp.has_last_epoch()) assert(cp.last_epoch() == epochs[k]);
+    cp.serialize(buf);
+  }
+
+  doris_rnx::Checkpoint cp;
+  assert(!cp.deserialize(buf));
+  DorisObsRinex rnx(fn2);
+  std::size_t i = k + 1;
+  for (auto it = rnx.resume(cp); it != rnx.end(); ++it) {
+    assert(it->mheader.m_epoch == epochs[i]);
+    ++i;
+  }
+  assert(i >= epochs.size());
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr,
+            "Error. Usage %s [DORIS RINEX] [COMPRESSED DORIS RINEX (.Z/.gz, "
+            "optional)]\n",
+            argv[0]);
+    return 1;
+  }
+
+  std::vector<Datetime<nanoseconds>> epochs;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it)
+      epochs.push_back(it->mheader.m_epoch);
+  }
+  assert(epochs.size() > 2);
+
+  /* first, middle, last block and end */
+  for (std::size_t k :
+       {std::size_t(0), epochs.size() / 2, epochs.size() - 1, epochs.size()})
+    check_resume(argv[1], argv[1], epochs, k);
+
+  /* compressed files: resume by skipping (checkpoints are interchangeable
+   * with the uncompressed file)
+   */
+  if (argc == 3) {
+    check_resume(argv[2], argv[2], epochs, epochs.size() / 2);
+    check_resume(argv[1], argv[2], epochs, epochs.size() / 3);
+  }
+
+  /* a bad checkpoint is rejected */
+  doris_rnx::Checkpoint cp;
+  char buf[doris_rnx::Checkpoint::SERIALIZED_SIZE] = {'\0'};
+  assert(cp.deserialize(buf));
+
+  /* a file with a different header does not match the checkpoint */
+  {
+    DorisObsRinex rnx(argv[1]);
+    auto it = rnx.begin();
+    cp = rnx.checkpoint(++it);
+  }
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  const auto pgm = content.find("PGM / RUN BY / DATE");
+  assert(pgm != std::string::npos && pgm > 60);
+  content[pgm - 60] = (content[pgm - 60] == 'x') ? 'y' : 'x';
+  const std::string fn = std::string(argv[1]) + ".checkpoint";
+  {
+    std::ofstream fout(fn, std::ios_base::binary);
+    fout << content;
+  }
+  {
+    DorisObsRinex rnx(fn.c_str());
+    bool thrown = false;
+    try {
+      rnx.resume(cp);
+    } catch (std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+  std::remove(fn.c_str());
+
+  printf("Checkpoint tests ok for %d epochs\n", (int)epochs.size());
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_compact.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+namespace {
+std::vector<doris_rnx::DataBlock> collect(DorisObsRinex &rnx) {
+  std::vector<doris_rnx::DataBlock> blocks;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) blocks.push_back(*it);
+  return blocks;
+}
+
+/* values must be bitwise equal (missing values included) */
+void compare(const std::vector<doris_rnx::DataBlock> &a,
+             const std::vector<doris_rnx::DataBlock> &b) {
+  assert(a.size() == b.size());
+  for (std::size_t i = 0; i < a.size(); i++) {
+    assert(a[i].mheader.m_epoch == b[i].mheader.m_epoch);
+    assert(a[i].mheader.m_flag == b[i].mheader.m_flag);
+    assert(a[i].mheader.m_clock_flag == b[i].mheader.m_clock_flag);
+    assert(!std::memcmp(&a[i].mheader.m_clock_offset,
+                        &b[i].mheader.m_clock_offset, sizeof(double)));
+    assert(a[i].mbeacon_obs.size() == b[i].mbeacon_obs.size());
+    for (std::size_t j = 0; j < a[i].mbeacon_obs.size(); j++) {
+      const auto &x = a[i].mbeacon_obs[j];
+      const auto &y = b[i].mbeacon_obs[j];
+      assert(!std::strcmp(x.id(), y.id()));
+      assert(x.m_values.size() == y.m_values.size());
+      for (std::size_t k = 0; k < x.m_values.size(); k++) {
+        assert(!std::memcmp(&x.m_values[k].m_value, &y.m_values[k].m_value,
+                            sizeof(double)));
+        assert(x.m_values[k].m_flag1 == y.m_values[k].m_flag1);
+        assert(x.m_values[k].m_flag2 == y.m_values[k].m_flag2);
+      }
+    }
+  }
+}
+} /* unnamed namespace */
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference */
+  DorisObsRinex rnx(argv[1]);
+  const auto blocks = collect(rnx);
+  assert(!blocks.empty());
+
+  /* RINEX to compact RINEX */
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  std::ostringstream crx;
+  assert(!doris_rnx::rinex_to_compact(fin, crx));
+  const std::string compact = crx.str();
+  fin.clear();
+  fin.seekg(0, std::ios_base::end);
+  printf("RINEX size: %ld, compact RINEX size: %zu (ratio %.2f)\n",
+         (long)fin.tellg(), compact.size(),
+         (double)fin.tellg() / compact.size());
+
+  /* parse compact RINEX, decoding block by block */
+  DorisObsRinex crnx(std::make_unique<doris_rnx::MemorySource>(
+                         compact.data(), compact.size()),
+                     "compact");
+  assert(crnx.header().is_compact());
+  assert(crnx.header().obs_codes() == rnx.header().obs_codes());
+  compare(blocks, collect(crnx));
+  /* iterate twice (i.e. decoder is reset on rewinding) */
+  compare(blocks, collect(crnx));
+
+  /* seek (linear for compact files) */
+  const auto &target = blocks[blocks.size() / 2];
+  auto it = crnx.seek(target.mheader.m_epoch);
+  assert(it != crnx.end() && it->mheader.m_epoch == target.mheader.m_epoch);
+  assert(it->mbeacon_obs.size() == target.mbeacon_obs.size());
+
+  /* compact RINEX back to RINEX, and parse */
+  std::istringstream cin(compact);
+  std::ostringstream out;
+  assert(!doris_rnx::compact_to_rinex(cin, out));
+  const std::string restored = out.str();
+  DorisObsRinex rrnx(std::make_unique<doris_rnx::MemorySource>(
+                         restored.data(), restored.size()),
+                     "restored");
+  assert(!rrnx.header().is_compact());
+  compare(blocks, collect(rrnx));
+
+  /* converting the restored file gives the same compact file, bar the
+   * CRINEX PROG / DATE line
+   */
+  std::istringstream rin(restored);
+  std::ostringstream crx2;
+  assert(!doris_rnx::rinex_to_compact(rin, crx2));
+  const std::string compact2 = crx2.str();
+  assert(compact2.size() == compact.size());
+  assert(compact2.substr(162) == compact.substr(162));
+
+  /* special events, with and without an epoch, with special records (i.e.
+   * header lines), before the 3rd block: decoded as in RINEX, i.e. the one
+   * with an epoch is a block without observations
+   */
+  {
+    fin.seekg(0);
+    const std::string content((std::istreambuf_iterator<char>(fin)),
+                              std::istreambuf_iterator<char>());
+    std::size_t at = content.find("END OF HEADER");
+    for (int i = 0; i < 3; i++) at = content.find("\n>", at) + 1;
+    std::string event = content.substr(at, content.find('\n', at) - at);
+    event.replace(31, 6, "  3  2");
+    std::string noepoch(37, ' ');
+    noepoch[0] = '>';
+    noepoch.replace(31, 6, "  4  1");
+    const std::string hline =
+        "THIS IS A COMMENT                                           COMMENT\n";
+    const std::string events = content.substr(0, at) + event + "\n" + hline +
+                               hline + noepoch + "\n" + hline +
+                               content.substr(at);
+    DorisObsRinex ernx(std::make_unique<doris_rnx::MemorySource>(
+                           events.data(), events.size()),
+                       "events");
+    const auto eblocks = collect(ernx);
+    assert(eblocks.size() == blocks.size() + 1);
+    assert(eblocks[2].mheader.m_flag == 3 && eblocks[2].mbeacon_obs.empty());
+
+    std::istringstream ein(events);
+    std::ostringstream ecrx;
+    assert(!doris_rnx::rinex_to_compact(ein, ecrx));
+    const std::string ecompact = ecrx.str();
+    DorisObsRinex ecrnx(std::make_unique<doris_rnx::MemorySource>(
+                            ecompact.data(), ecompact.size()),
+                        "compact events");
+    compare(eblocks, collect(ecrnx));
+
+    /* cut within the special records of the event: truncated */
+    const auto ev = ecompact.find(event);
+    assert(ev != std::string::npos);
+    const std::string cut =
+        ecompact.substr(0, ecompact.find('\n', ev) + 1) + hline;
+    DorisObsRinex cutrnx(std::make_unique<doris_rnx::MemorySource>(
+                             cut.data(), cut.size()),
+                         "compact cut");
+    bool thrown = false;
+    try {
+      collect(cutrnx);
+    } catch (const std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  printf("All checks ok\n");
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_decompress.hpp"
+#include "doris_rinex_policy.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    fprintf(stderr,
+            "Error. Usage %s [DORIS RINEX] [COMPRESSED DORIS RINEX (.Z/.gz)] "
+            "...\n",
+            argv[0]);
+    return 1;
+  }
+
+  /* reference, uncompressed */
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+  DorisObsRinex rnx(argv[1]);
+  std::vector<doris_rnx::DataBlock> blocks;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) blocks.push_back(*it);
+  assert(!blocks.empty());
+
+  for (int i = 2; i < argc; i++) {
+    /* decompressed bytes must match the reference */
+    doris_rnx::Compression type;
+    auto src = doris_rnx::decompressing_source(
+        std::make_unique<doris_rnx::FileSource>(argv[i], 4096), &type);
+    assert(type != doris_rnx::Compression::none);
+    std::string dcontent;
+    char buf[1000];
+    std::streamsize n;
+    while ((n = src->sgetn(buf, sizeof(buf))) > 0) dcontent.append(buf, n);
+    assert(dcontent == content);
+
+    /* parse compressed file */
+    DorisObsRinex crnx(argv[i]);
+    std::size_t j = 0;
+    for (auto it = crnx.begin(); it != crnx.end(); ++it) {
+      assert(j < blocks.size());
+      assert(it->mheader.m_epoch == blocks[j].mheader.m_epoch);
+      assert(it->mbeacon_obs.size() == blocks[j].mbeacon_obs.size());
+      ++j;
+    }
+    assert(j == blocks.size());
+
+    /* a .gz file with a bad CRC (the trailer is the CRC32 and the size of
+     * the decompressed data) must fail at the end, not read as a clean EOF
+     */
+    if (type == doris_rnx::Compression::gzip) {
+      std::ifstream gin(argv[i], std::ios_base::binary);
+      std::string bad((std::istreambuf_iterator<char>(gin)),
+                      std::istreambuf_iterator<char>());
+      assert(bad.size() > 8);
+      bad[bad.size() - 8] ^= 0x01;
+
+      DorisObsRinex brnx(std::make_unique<doris_rnx::MemorySource>(
+                             bad.data(), bad.size()),
+                         "bad crc");
+      bool thrown = false;
+      try {
+        for (auto it = brnx.begin(); it != brnx.end(); ++it)
+          ;
+      } catch (const std::runtime_error &) {
+        thrown = true;
+      }
+      assert(thrown);
+
+      DorisObsReader<> reader(DorisObsRinex(
+          std::make_unique<doris_rnx::MemorySource>(bad.data(), bad.size()),
+          "bad crc"));
+      doris_rnx::DataBlock block;
+      int status;
+      j = 0;
+      while (!(status = reader.next(block))) ++j;
+      assert(status > 0 && j == blocks.size());
+    }
+    printf("Compressed file %s ok\n", argv[i]);
+  }
+
+  return 0;
+}
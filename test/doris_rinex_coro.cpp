@@ -0,0 +1,169 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_coro.hpp"
+#include <cstdio>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+#ifndef RNX_HAVE_COROUTINES
+int main() {
+  printf("Coroutine tests skipped (not compiled as C++20)\n");
+  return 0;
+}
+#else
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dso;
+
+/* append the data blocks to the files, in turn, pausing in between */
+void writer(const std::vector<std::string> &files, const std::string &content,
+            const std::vector<long> &offsets) {
+  std::vector<std::ofstream> fouts;
+  for (const auto &fn : files)
+    fouts.emplace_back(fn, std::ios_base::binary | std::ios_base::app);
+  for (std::size_t i = 0; i + 1 < offsets.size(); i++) {
+    for (auto &fout : fouts) {
+      fout.write(content.data() + offsets[i], offsets[i + 1] - offsets[i]);
+      fout.flush();
+    }
+    if (!(i % 8)) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference: offsets of all data blocks (and the end of the last one) and
+   * epochs
+   */
+  std::vector<long> offsets;
+  std::vector<Datetime<nanoseconds>> epochs;
+  {
+    DorisObsRinex rnx(argv[1]);
+    auto c = rnx.cursor();
+    offsets.push_back(std::streamoff(c.tell()));
+    doris_rnx::DataBlock block;
+    while (!c.next(block)) {
+      offsets.push_back(std::streamoff(c.tell()));
+      epochs.push_back(block.mheader.m_epoch);
+    }
+  }
+  assert(epochs.size() > 2);
+
+  /* generator over a file; twice, each time from the first block */
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (int pass = 0; pass < 2; pass++) {
+      std::size_t i = 0;
+      for (const auto &block : doris_rnx::blocks(rnx))
+        assert(block.mheader.m_epoch == epochs[i++]);
+      assert(i == epochs.size());
+    }
+  }
+
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+  const std::vector<std::string> files{std::string(argv[1]) + ".coro0",
+                                       std::string(argv[1]) + ".coro1",
+                                       std::string(argv[1]) + ".coro2"};
+
+  /* generator over a (complete) followed file; ends on timeout */
+  {
+    {
+      std::ofstream fout(files[0], std::ios_base::binary);
+      fout << content;
+    }
+    DorisRinexFollower f(files[0].c_str());
+    std::size_t i = 0;
+    for (const auto &block : doris_rnx::blocks(f, 0))
+      assert(block.mheader.m_epoch == epochs[i++]);
+    assert(i == epochs.size());
+  }
+
+  /* many growing files, read on one thread */
+  {
+    for (const auto &fn : files) {
+      std::ofstream fout(fn, std::ios_base::binary | std::ios_base::trunc);
+      fout.write(content.data(), offsets[0]);
+    }
+    std::vector<std::unique_ptr<DorisRinexFollower>> followers;
+    for (const auto &fn : files)
+      followers.push_back(std::make_unique<DorisRinexFollower>(fn.c_str()));
+
+    /* waits on the followers' descriptors, without a poll interval */
+    doris_rnx::FollowLoop loop;
+    std::vector<std::size_t> counts(files.size(), 0);
+    /* order in which blocks were read (file index) */
+    std::vector<int> order;
+    auto stage = [&](int k) -> doris_rnx::FollowLoop::Task {
+      doris_rnx::DataBlock block;
+      auto &f = *followers[k];
+      while (counts[k] < epochs.size()) {
+        const int status = co_await loop.next(f, block);
+        assert(!status);
+        assert(block.mheader.m_epoch == epochs[counts[k]]);
+        ++counts[k];
+        order.push_back(k);
+      }
+      /* all read; wait until stopped from another thread */
+      assert(co_await loop.next(f, block) < 0);
+    };
+    for (int k = 0; k < (int)files.size(); k++) loop.spawn(stage(k));
+    assert(loop.size() == files.size());
+
+    std::thread t(writer, std::cref(files), std::cref(content),
+                  std::cref(offsets));
+    std::thread s([&]() {
+      t.join();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      for (auto &f : followers) f->stop();
+    });
+    loop.run();
+    s.join();
+    assert(!loop.size());
+    for (const auto c : counts) assert(c == epochs.size());
+
+    /* blocks of the files were read interleaved */
+    int switches = 0;
+    for (std::size_t i = 1; i < order.size(); i++)
+      switches += (order[i] != order[i - 1]);
+    assert(switches >= (int)epochs.size());
+  }
+
+  /* exceptions of tasks are rethrown by run */
+  {
+    DorisRinexFollower f(files[0].c_str());
+    doris_rnx::FollowLoop loop;
+    auto failing = [&]() -> doris_rnx::FollowLoop::Task {
+      doris_rnx::DataBlock block;
+      co_await loop.next(f, block);
+      throw std::runtime_error("stage failed");
+    };
+    loop.spawn(failing());
+    bool thrown = false;
+    try {
+      loop.run();
+    } catch (const std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown && !loop.size());
+  }
+
+  for (const auto &fn : files) std::remove(fn.c_str());
+
+  printf("Coroutine tests ok for %d epochs, %d files\n", (int)epochs.size(),
+         (int)files.size());
+  return 0;
+}
+#endif
@@ -0,0 +1,75 @@
+#include "doris_rinex.hpp"
+#include <cstdio>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* scan [from, to) epochs with a cursor; check against the reference */
+void scan(DorisRinexCursor c, const std::vector<Datetime<nanoseconds>> &ref,
+          int from, int to, int *ok) {
+  doris_rnx::DataBlock block;
+  int count = 0;
+  assert(!c.seek(ref[from]));
+  for (int i = from; i < to; i++) {
+    if (c.next(block)) break;
+    if (block.mheader.m_epoch != ref[i]) break;
+    ++count;
+  }
+  *ok = (count == to - from);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc!=2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx (argv[1]);
+
+  /* collect all epochs, reading the file sequentially */
+  std::vector<Datetime<nanoseconds>> epochs;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) {
+    epochs.push_back(it->mheader.m_epoch);
+  }
+  assert(epochs.size() > 2);
+
+  /* forward and backward using one cursor */
+  auto c = rnx.cursor();
+  doris_rnx::DataBlock block;
+  int i = 0;
+  while (!c.next(block)) {
+    assert(block.mheader.m_epoch == epochs[i]);
+    ++i;
+  }
+  assert(i == (int)epochs.size());
+  while (!c.prev(block)) {
+    --i;
+    assert(block.mheader.m_epoch == epochs[i]);
+  }
+  assert(i == 0);
+
+  /* copies are independent */
+  assert(!c.next(block));
+  auto c2 = c;
+  assert(!c.next(block) && block.mheader.m_epoch == epochs[1]);
+  assert(!c2.prev(block) && block.mheader.m_epoch == epochs[0]);
+
+  /* two threads, scanning different halves of the file */
+  const int half = epochs.size() / 2;
+  int ok1 = 0, ok2 = 0;
+  std::thread t1(scan, rnx.cursor(), std::cref(epochs), 0, half, &ok1);
+  std::thread t2(scan, rnx.cursor(), std::cref(epochs), half,
+                 (int)epochs.size(), &ok2);
+  t1.join();
+  t2.join();
+  assert(ok1 && ok2);
+
+  printf("Cursor tests ok for %d epochs\n", (int)epochs.size());
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_diagnostics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* a copy of a diagnostic (its pointers are only valid in the sink) */
+struct Collected {
+  doris_rnx::DiagLevel m_level;
+  int m_code;
+  long m_line;
+  long m_offset;
+  std::string m_text;
+};
+
+void collect(const doris_rnx::Diagnostic &d, void *data) {
+  static_cast<std::vector<Collected> *>(data)->push_back(
+      Collected{d.m_level, d.m_code, d.m_line, (long)d.m_offset,
+                d.m_text ? d.m_text : ""});
+}
+
+/* number of diagnostics with the given code */
+long count(const std::vector<Collected> &v, int code) {
+  return std::count_if(v.begin(), v.end(),
+                       [=](const Collected &c) { return c.m_code == code; });
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  std::vector<Collected> diags;
+  doris_rnx::set_diagnostics_sink(collect, &diags);
+
+  /* a valid file: nothing above debug level */
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it)
+      ;
+    assert(std::none_of(diags.begin(), diags.end(), [](const Collected &c) {
+      return c.m_level != doris_rnx::DiagLevel::debug;
+    }));
+    diags.clear();
+  }
+
+  /* header: a bad STATION REFERENCE line and an unknown label; line numbers
+   * and offsets point at the offending lines
+   */
+  {
+    std::string bad = content;
+    const auto eol = bad.find("STATION REFERENCE");
+    assert(eol != std::string::npos);
+    const long offset = (long)bad.rfind('\n', eol) + 1;
+    const long line = 1 + std::count(bad.begin(), bad.begin() + offset, '\n');
+    const std::string unknown =
+        "SOMETHING                                                   "
+        "UNKNOWN LABEL\n";
+    bad[offset] = 'X';
+    bad.insert(offset, unknown);
+    std::istringstream is(bad);
+    DorisRinexHeader hdr;
+    assert(hdr.read(is));
+
+    assert(count(diags, doris_rnx::diag::HEADER_STATION_REFERENCE) == 1);
+    const auto &d = diags.back();
+    assert(d.m_level == doris_rnx::DiagLevel::error);
+    assert(d.m_line == line + 1);
+    assert(d.m_offset == offset + (long)unknown.size());
+    assert(d.m_text[0] == 'X');
+    assert(count(diags, doris_rnx::diag::HEADER_LINE_IGNORED) ==
+           (doris_rnx::DIAG_MIN_LEVEL > 0 ? 0 : 1));
+    diags.clear();
+  }
+
+  /* data: a malformed beacon line */
+  {
+    DorisObsRinex rnx(argv[1]);
+    auto c = rnx.cursor();
+    doris_rnx::DataBlock block;
+    assert(!c.next(block));
+    const long offset = (long)content.find("\nD", std::streamoff(c.tell())) + 1;
+    std::string bad = content;
+    bad[offset] = 'X';
+
+    DorisObsRinex strict(std::make_unique<doris_rnx::MemorySource>(
+        bad.data(), bad.size()));
+    bool thrown = false;
+    try {
+      for (auto it = strict.begin(); it != strict.end(); ++it)
+        ;
+    } catch (std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+    assert(count(diags, doris_rnx::diag::DATA_EXPECTED_BEACON) == 1);
+    const auto it = std::find_if(diags.begin(), diags.end(), [](auto &d) {
+      return d.m_code == doris_rnx::diag::DATA_EXPECTED_BEACON;
+    });
+    assert(it->m_offset == offset && it->m_text[0] == 'X');
+    diags.clear();
+
+    /* a null sink discards everything */
+    doris_rnx::set_diagnostics_sink(nullptr);
+    DorisObsRinex quiet(std::make_unique<doris_rnx::MemorySource>(
+        bad.data(), bad.size()));
+    try {
+      for (auto i = quiet.begin(); i != quiet.end(); ++i)
+        ;
+    } catch (std::runtime_error &) {
+    }
+    assert(diags.empty());
+  }
+
+  assert(std::string(doris_rnx::diagnostic_message(92)) ==
+         "APPROX POSITION XYZ");
+
+  doris_rnx::set_diagnostics_sink(doris_rnx::stderr_sink);
+  printf("Diagnostics tests ok\n");
+
+  return 0;
+}
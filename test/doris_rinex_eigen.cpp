@@ -0,0 +1,92 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_eigen.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ref.push_back(*it);
+  }
+
+  DorisObsReader<> reader(argv[1]);
+  const auto &codes = reader.header().obs_codes();
+  const int num_obs = codes.size();
+
+  /* per epoch: views over an ObservationMatrix */
+  doris_rnx::ObservationMatrix<double> m;
+  for (const auto &block : ref) {
+    assert(!reader.next(m));
+    const auto x = doris_rnx::observations(m);
+    const int num_beacons = block.mbeacon_obs.size();
+    assert(x.rows() == num_beacons && x.cols() == num_obs);
+    assert(x.data() == m.m_values.data());
+    for (int k = 0; k < num_obs; k++) {
+      const auto col = doris_rnx::observable(m, codes[k]);
+      assert(col.size() == num_beacons);
+      for (int b = 0; b < num_beacons; b++) {
+        const double y = block.mbeacon_obs[b].m_values[k].m_value;
+        assert(x(b, k) == y && col(b) == y);
+        assert(&col.coeffRef(b) == &m.m_values[b * num_obs + k]);
+      }
+    }
+  }
+  assert(reader.next(m) < 0);
+
+  /* views write through */
+  doris_rnx::observations(m).setZero();
+  for (double v : m.m_values) assert(v == 0e0);
+
+  /* whole file: per observable columns of an ObservationTable */
+  doris_rnx::ObservationTable<double> table;
+  reader.rewind();
+  while (!reader.next(table))
+    ;
+  assert(table.num_epochs() == ref.size());
+  std::size_t row = 0;
+  for (std::size_t i = 0; i < ref.size(); i++) {
+    for (const auto &b : ref[i].mbeacon_obs) {
+      assert(table.epoch(row).m_epoch == ref[i].mheader.m_epoch);
+      assert(!std::strcmp(table.beacon_id(row), b.id()));
+      for (int k = 0; k < num_obs; k++)
+        assert(doris_rnx::observable(table, k)(row) == b.m_values[k].m_value);
+      ++row;
+    }
+  }
+  assert(row == table.num_rows());
+  const auto l1 = doris_rnx::observable(
+      table, DorisObservationCode{DorisObservationType::phase, 1});
+  assert(l1.size() == (long)row && l1.data() == table.values(0));
+  assert(doris_rnx::observable(table, DorisObservationCode{
+                                          DorisObservationType::phase, 2})
+             .size() == (long)row);
+
+  /* float values */
+  doris_rnx::ObservationTable<float> ftable;
+  reader.rewind();
+  while (!reader.next(ftable))
+    ;
+  assert(ftable.num_rows() == table.num_rows());
+  const auto fx = doris_rnx::observable(ftable, num_obs - 1);
+  const auto dx = doris_rnx::observable(table, num_obs - 1);
+  assert((fx.cast<double>() - dx).cwiseAbs().maxCoeff() <=
+         1e-6 * dx.cwiseAbs().maxCoeff());
+
+  printf("Eigen view tests ok for %d epochs, %d rows\n", (int)ref.size(),
+         (int)row);
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_flags.hpp"
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* the char a flag is given as by FlagColumns::flag */
+char expected(char c) {
+  return (c == ' ' || (c >= '0' && c <= '9')) ? c : '?';
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* kernels: every instruction set against the portable one, for random
+   * flags and sizes around the vector widths
+   */
+  {
+    std::mt19937 gen(7);
+    const char chars[] = " 0123456789 x  ";
+    std::vector<char> flags(2000);
+    for (auto &c : flags) c = chars[gen() % (sizeof(chars) - 1)];
+    for (auto isa : {doris_rnx::kernels::Isa::generic,
+                     doris_rnx::kernels::Isa::sse2,
+                     doris_rnx::kernels::Isa::avx2,
+                     doris_rnx::kernels::Isa::avx512}) {
+      if (!doris_rnx::kernels::select_isa(isa)) continue;
+      for (std::size_t n : {1, 2, 63, 64, 65, 127, 128, 129, 1000, 2000}) {
+        std::vector<std::uint8_t> packed((n + 1) / 2);
+        doris_rnx::kernels::pack_flags(flags.data(), n, packed.data());
+        for (std::size_t i = 0; i < n; i++)
+          assert(((packed[i / 2] >> (4 * (i & 1))) & 0xf) ==
+                 doris_rnx::kernels::flag_code(flags[i]));
+        for (auto range : {std::pair<int, int>{1, 15}, {0, 0}, {3, 3},
+                           {2, 11}, {15, 15}, {5, 4}}) {
+          doris_rnx::RowMask m((n + 63) / 64, ~0ULL);
+          doris_rnx::kernels::flag_mask(packed.data(), n, range.first,
+                                        range.second, m.data());
+          for (std::size_t i = 0; i < 64 * m.size(); i++) {
+            const int code = (i < n) ? doris_rnx::kernels::flag_code(flags[i])
+                                     : -1;
+            const bool in = code >= range.first && code <= range.second;
+            assert((bool)((m[i / 64] >> (i % 64)) & 1) == in);
+          }
+        }
+      }
+    }
+  }
+
+  /* a whole file */
+  DorisObsReader<> reader(argv[1]);
+  doris_rnx::ObservationTable<double> table;
+  while (!reader.next(table))
+    ;
+  const doris_rnx::FlagColumns f(table);
+  assert(f.num_rows() == table.num_rows() && f.num_obs() == table.num_obs());
+
+  std::size_t total = 0;
+  for (int k = 0; k < f.num_obs(); k++) {
+    for (int which = 1; which <= 2; which++) {
+      const auto &raw = (which == 1) ? table.m_flags1[k] : table.m_flags2[k];
+      const auto flagged = f.flagged(k, which);
+      std::map<std::string, std::size_t> ref;
+      std::size_t n = 0;
+      for (std::size_t i = 0; i < f.num_rows(); i++) {
+        assert(f.flag(i, k, which) == expected(raw[i]));
+        if (raw[i] != ' ') {
+          ++n;
+          ++ref[table.beacon_id(i)];
+        }
+      }
+      assert(doris_rnx::FlagColumns::count(flagged) == n);
+      const auto counts = f.count_by_beacon(flagged);
+      for (std::size_t b = 0; b < counts.size(); b++)
+        assert(counts[b] == ref[f.beacon_ids()[b]]);
+      total += n;
+
+      /* equality, and combinations of masks */
+      const auto seven = f.equal(k, which, '7');
+      assert(doris_rnx::FlagColumns::count(doris_rnx::mask_and(seven, flagged)) ==
+             doris_rnx::FlagColumns::count(seven));
+      assert(doris_rnx::FlagColumns::count(doris_rnx::mask_or(seven, flagged)) == n);
+    }
+  }
+
+  printf("Flag tests ok for %d rows (%d flags set)\n", (int)f.num_rows(),
+         (int)total);
+  return 0;
+}
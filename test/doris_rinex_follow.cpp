@@ -0,0 +1,126 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_follow.hpp"
+#include <poll.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* append the data blocks to fn, each one in two pieces (the first one
+ * ending mid-line), pausing in between
+ */
+void writer(const char *fn, const std::string &content,
+            const std::vector<long> &offsets) {
+  std::ofstream fout(fn, std::ios_base::binary | std::ios_base::app);
+  for (std::size_t i = 0; i + 1 < offsets.size(); i++) {
+    const long size = offsets[i + 1] - offsets[i];
+    const long half = size / 2;
+    fout.write(content.data() + offsets[i], half);
+    fout.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    fout.write(content.data() + offsets[i] + half, size - half);
+    fout.flush();
+    if (!(i % 8)) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+void follow(const char *fn, const std::string &content,
+            const std::vector<long> &offsets,
+            const std::vector<Datetime<nanoseconds>> &epochs,
+            bool use_inotify) {
+  /* start off with the header only */
+  {
+    std::ofstream fout(fn, std::ios_base::binary | std::ios_base::trunc);
+    fout.write(content.data(), offsets[0]);
+  }
+
+  doris_rnx::FollowOptions opts;
+  opts.m_use_inotify = use_inotify;
+  opts.m_poll_interval_ms = 1;
+  DorisRinexFollower f(fn, opts);
+  assert(f.uses_inotify() || !use_inotify);
+  assert(std::streamoff(f.tell()) == offsets[0]);
+
+  /* nothing there yet */
+  doris_rnx::DataBlock block;
+  assert(f.next(block, 0) < 0);
+  assert(f.next(block, 10) < 0);
+
+  std::thread t(writer, fn, std::cref(content), std::cref(offsets));
+  for (std::size_t i = 0; i < epochs.size(); i++) {
+    assert(!f.next(block, 5000));
+    assert(block.mheader.m_epoch == epochs[i]);
+    assert(std::streamoff(f.tell()) == offsets[i + 1]);
+  }
+  t.join();
+
+  /* the descriptor to wait on signals appends (with inotify) */
+  assert(f.wait_fd() >= 0);
+  assert(f.wait_interval_ms() == (f.uses_inotify() ? -1 : 1));
+  struct pollfd p{f.wait_fd(), POLLIN, 0};
+  assert(f.next(block, 0) < 0);
+  assert(!::poll(&p, 1, 0));
+  if (f.uses_inotify()) {
+    {
+      /* the start of a block that never completes */
+      std::ofstream fout(fn, std::ios_base::binary | std::ios_base::app);
+      fout << "> ";
+    }
+    assert(::poll(&p, 1, 5000) == 1);
+    /* cleared by next */
+    assert(f.next(block, 0) < 0);
+    assert(!::poll(&p, 1, 0));
+  }
+
+  /* all read; wait until stopped from another thread */
+  std::thread s([&f]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    f.stop();
+  });
+  assert(f.next(block) < 0);
+  s.join();
+  assert(::poll(&p, 1, 0) == 1);
+  assert(std::streamoff(f.tell()) == offsets.back());
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  /* offsets of all data blocks (and the end of the last one) and epochs */
+  DorisObsRinex rnx(argv[1]);
+  auto c = rnx.cursor();
+  std::vector<long> offsets{(long)std::streamoff(c.tell())};
+  std::vector<Datetime<nanoseconds>> epochs;
+  doris_rnx::DataBlock block;
+  while (!c.next(block)) {
+    offsets.push_back(std::streamoff(c.tell()));
+    epochs.push_back(block.mheader.m_epoch);
+  }
+  assert(epochs.size() > 2);
+  assert(offsets.back() == (long)content.size());
+
+  const std::string fn = std::string(argv[1]) + ".follow";
+  follow(fn.c_str(), content, offsets, epochs, true);
+  follow(fn.c_str(), content, offsets, epochs, false);
+  std::remove(fn.c_str());
+
+  printf("Follow tests ok for %d epochs\n", (int)epochs.size());
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "doris_rinex_kernels.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso::doris_rnx;
+
+/* a random observation field (value plus flags), of FIELD_CHARS chars */
+std::string random_field(std::mt19937_64 &gen) {
+  char buf[64];
+  const int kind = gen() % 8;
+  if (kind == 0) {
+    /* blank */
+    std::snprintf(buf, sizeof(buf), "%14s", "");
+  } else if (kind == 1) {
+    /* irregular: other number of decimals, garbage or a negative zero */
+    const char *odd[] = {"1.23",    "-5.",     "12.3456", "1-2.345",
+                         "  12 .345", "abc.def", "--1.000", "1e3.000",
+                         ".123",    "-0.000"};
+    std::snprintf(buf, sizeof(buf), "%14s", odd[gen() % 10]);
+  } else {
+    /* F14.3, of any magnitude */
+    const int digits = 1 + gen() % 13;
+    std::int64_t m = 1;
+    for (int i = 0; i < digits; i++) m *= 10;
+    m = (std::int64_t)(gen() % m) * ((gen() & 1) ? -1 : 1);
+    std::snprintf(buf, sizeof(buf), "%14.3f", m / 1e3);
+  }
+  std::string f(buf, 14);
+  f += (gen() & 1) ? ' ' : char('0' + gen() % 10);
+  f += (gen() & 1) ? ' ' : char('0' + gen() % 10);
+  return f;
+}
+
+int main() {
+  std::mt19937_64 gen(42);
+  constexpr int N = 20000;
+  std::string fields;
+  for (int i = 0; i < N; i++) fields += random_field(gen);
+
+  /* reference: the portable kernels, checked against from_chars */
+  assert(kernels::select_isa(kernels::Isa::generic));
+  std::vector<std::int64_t> ref_m(N);
+  std::vector<std::uint8_t> ref_s(N);
+  kernels::decode_fields(fields.data(), N, ref_m.data(), ref_s.data());
+  int counts[3] = {0, 0, 0};
+  for (int i = 0; i < N; i++) {
+    const char *f = fields.data() + i * kernels::FIELD_CHARS;
+    ++counts[ref_s[i]];
+    const char *begin = f, *end = f + 14;
+    while (begin < end && *begin == ' ') ++begin;
+    if (ref_s[i] == kernels::FIELD_BLANK) {
+      assert(begin == end);
+    } else if (ref_s[i] == kernels::FIELD_VALUE) {
+      double v;
+      assert(std::from_chars(begin, end, v).ec == std::errc{});
+      assert(v == ref_m[i] / 1e3);
+      /* the sign survives, including that of a zero */
+      assert(std::signbit(v) == (ref_m[i] < 0));
+    }
+  }
+  assert(counts[0] && counts[1] && counts[2]);
+
+  std::vector<double> ref_v(N);
+  kernels::scale_values(ref_m.data(), N, 1e3, 10., ref_v.data());
+
+  /* every other instruction set: same results */
+  int tested = 1;
+  for (auto isa : {kernels::Isa::sse2, kernels::Isa::avx2,
+                   kernels::Isa::avx512}) {
+    if (!kernels::select_isa(isa)) continue;
+    assert(kernels::active_isa() == isa);
+    ++tested;
+    std::vector<std::int64_t> m(N, 0);
+    std::vector<std::uint8_t> s(N);
+    /* all counts, to exercise the remainders */
+    for (int n = 1; n <= 5; n++) {
+      for (int i = 0; i + n <= N; i += n)
+        kernels::decode_fields(fields.data() + i * kernels::FIELD_CHARS, n,
+                               m.data() + i, s.data() + i);
+      for (int i = 0; i < N - N % n; i++) {
+        assert(s[i] == ref_s[i]);
+        if (s[i] == kernels::FIELD_VALUE) assert(m[i] == ref_m[i]);
+      }
+    }
+    /* a negative zero is left to the parser, alone or amid other fields */
+    {
+      std::string zeros;
+      for (const char *z : {"        -0.000  ", "        -0.000 1",
+                            "       -00.000  ", "         0.000  "})
+        zeros += std::string(z, kernels::FIELD_CHARS);
+      for (int k = 0; k < 8; k++) zeros += "        -0.000  ";
+      const int nz = zeros.size() / kernels::FIELD_CHARS;
+      for (int n = 1; n <= nz; n++) {
+        kernels::decode_fields(zeros.data(), n, m.data(), s.data());
+        for (int i = 0; i < n; i++) {
+          if (i == 3) {
+            assert(s[i] == kernels::FIELD_VALUE && m[i] == 0);
+          } else {
+            assert(s[i] == kernels::FIELD_IRREGULAR);
+          }
+        }
+      }
+    }
+    std::vector<double> v(N);
+    for (std::size_t n : {(std::size_t)N, (std::size_t)N - 3, (std::size_t)7}) {
+      kernels::scale_values(ref_m.data(), n, 1e3, 10., v.data());
+      assert(!std::memcmp(v.data(), ref_v.data(), n * sizeof(double)));
+    }
+    printf("Kernels %s ok\n", kernels::isa_name(isa));
+  }
+
+  printf("Kernel tests ok (%d instruction sets, %d/%d/%d fields "
+         "value/blank/irregular)\n",
+         tested, counts[0], counts[1], counts[2]);
+  return 0;
+}
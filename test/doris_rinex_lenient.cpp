@@ -0,0 +1,181 @@
+#include "doris_rinex.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* a DorisObsRinex over content; seekable or not */
+DorisObsRinex open(const std::string &content, bool seekable) {
+  if (seekable)
+    return DorisObsRinex(std::make_unique<doris_rnx::MemorySource>(
+        content.data(), content.size()));
+  std::size_t at = 0;
+  return DorisObsRinex(std::make_unique<doris_rnx::ReaderSource>(
+      [&content, at](char *buf, std::size_t n) mutable {
+        n = std::min(n, content.size() - at);
+        std::memcpy(buf, content.data() + at, n);
+        at += n;
+        return n;
+      }));
+}
+
+/* read all blocks in lenient mode; collect their epochs and the skipped
+ * ranges
+ */
+void read_all(const std::string &content, bool seekable,
+              std::vector<Datetime<nanoseconds>> &epochs,
+              std::vector<doris_rnx::SkippedRange> &skipped) {
+  epochs.clear();
+  skipped.clear();
+  auto rnx = open(content, seekable);
+  rnx.set_lenient(true, [&](const doris_rnx::SkippedRange &r) {
+    skipped.push_back(r);
+  });
+  for (auto it = rnx.begin(); it != rnx.end(); ++it)
+    epochs.push_back(it->mheader.m_epoch);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  /* reference epochs and block offsets */
+  DorisObsRinex rnx(argv[1]);
+  auto c = rnx.cursor();
+  std::vector<long> offsets{(long)std::streamoff(c.tell())};
+  std::vector<Datetime<nanoseconds>> ref;
+  doris_rnx::DataBlock block;
+  while (!c.next(block)) {
+    offsets.push_back(std::streamoff(c.tell()));
+    ref.push_back(block.mheader.m_epoch);
+  }
+  assert(ref.size() > 4);
+  const std::size_t k = ref.size() / 2;
+
+  std::vector<Datetime<nanoseconds>> epochs;
+  std::vector<doris_rnx::SkippedRange> skipped;
+
+  /* a malformed beacon line in block k: block k is skipped */
+  {
+    std::string bad = content;
+    const auto pos = bad.find("\nD", offsets[k]);
+    assert(pos != std::string::npos && (long)pos < offsets[k + 1]);
+    bad[pos + 1] = 'X';
+    for (bool seekable : {true, false}) {
+      read_all(bad, seekable, epochs, skipped);
+      assert(epochs.size() == ref.size() - 1);
+      assert(std::equal(epochs.begin(), epochs.begin() + k, ref.begin()));
+      assert(std::equal(epochs.begin() + k, epochs.end(), ref.begin() + k + 1));
+      assert(skipped.size() == 1);
+      assert(skipped[0].m_begin == offsets[k]);
+      assert(skipped[0].m_end == offsets[k + 1]);
+      assert(skipped[0].m_error > 0);
+    }
+
+    /* not lenient: iteration throws */
+    auto strict = open(bad, true);
+    bool thrown = false;
+    try {
+      for (auto it = strict.begin(); it != strict.end(); ++it)
+        ;
+    } catch (std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+
+  /* block k truncated (its last line removed): the following block, whose
+   * record line is consumed as a beacon line, is not lost
+   */
+  {
+    const long last_line =
+        (long)content.rfind('\n', offsets[k + 1] - 2) + 1;
+    const std::string bad =
+        content.substr(0, last_line) + content.substr(offsets[k + 1]);
+    read_all(bad, true, epochs, skipped);
+    assert(epochs.size() == ref.size() - 1);
+    assert(epochs[k] == ref[k + 1]);
+    assert(skipped.size() == 1 && skipped[0].m_begin == offsets[k]);
+  }
+
+  /* a truncated last block: skipped up to EOF */
+  {
+    const std::string bad =
+        content.substr(0, offsets[ref.size() - 1] +
+                              (offsets[ref.size()] - offsets[ref.size() - 1]) /
+                                  2);
+    read_all(bad, true, epochs, skipped);
+    assert(epochs.size() == ref.size() - 1);
+    assert(skipped.size() == 1);
+  }
+
+  /* special events, with and without an epoch, with embedded header lines;
+   * no lenient mode needed
+   */
+  {
+    std::string record = content.substr(offsets[k], 60);
+    record = record.substr(0, record.find('\n'));
+    std::string event = record;
+    event.replace(31, 6, "  3  2");
+    std::string noepoch(37, ' ');
+    noepoch[0] = '>';
+    noepoch.replace(31, 6, "  4  1");
+    const std::string hline =
+        "THIS IS A COMMENT                                           COMMENT\n";
+    const std::string bad = content.substr(0, offsets[k]) + event + "\n" +
+                            hline + hline + noepoch + "\n" + hline +
+                            content.substr(offsets[k]);
+    auto events = open(bad, true);
+    std::size_t i = 0, num_events = 0;
+    for (auto it = events.begin(); it != events.end(); ++it) {
+      if (it->mheader.m_flag > 1) {
+        assert(it->mbeacon_obs.empty() && it->mheader.m_epoch == ref[k]);
+        ++num_events;
+        continue;
+      }
+      assert(it->mheader.m_epoch == ref[i]);
+      ++i;
+    }
+    assert(i == ref.size() && num_events == 1);
+
+    /* the file ends before all special records of the event are there:
+     * truncated, not a clean EOF
+     */
+    const std::string cut =
+        content.substr(0, offsets[k]) + event + "\n" + hline;
+    auto strict = open(cut, true);
+    bool thrown = false;
+    try {
+      for (auto it = strict.begin(); it != strict.end(); ++it)
+        ;
+    } catch (std::runtime_error &) {
+      thrown = true;
+    }
+    assert(thrown);
+    read_all(cut, true, epochs, skipped);
+    assert(epochs.size() == k);
+    assert(skipped.size() == 1 && skipped[0].m_begin == offsets[k]);
+    assert(skipped[0].m_error > 0);
+  }
+
+  printf("Lenient tests ok for %d epochs\n", (int)ref.size());
+
+  return 0;
+}
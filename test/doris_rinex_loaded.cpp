@@ -0,0 +1,165 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_loaded.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef RNX_HAVE_PARALLEL_STL
+#include <algorithm>
+#include <execution>
+#endif
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* sum of the values of an epoch (missing ones included) */
+double epoch_sum(const doris_rnx::EpochView<double> &e) {
+  double sum = 0e0;
+  for (int b = 0; b < e.num_beacons(); b++)
+    for (int k = 0; k < e.num_obs(); k++)
+      sum += e.value(b, k);
+  return sum;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it)
+      if (it->mheader.m_flag <= 1) ref.push_back(*it);
+  }
+
+  doris_rnx::LoadedRinex<> data(argv[1]);
+  static_assert(std::is_same_v<std::iterator_traits<decltype(
+                                   data.begin())>::iterator_category,
+                               std::random_access_iterator_tag>);
+  assert(data.size() == ref.size());
+  assert(data.end() - data.begin() == (long)ref.size());
+
+  /* epochs and values, as the reference blocks */
+  std::size_t records = 0;
+  for (std::size_t i = 0; i < ref.size(); i++) {
+    const auto &e = data[i];
+    assert(e.epoch() == ref[i].mheader.m_epoch);
+    assert(e.num_beacons() == (int)ref[i].mbeacon_obs.size());
+    for (int b = 0; b < e.num_beacons(); b++) {
+      const auto &bobs = ref[i].mbeacon_obs[b];
+      assert(!std::strcmp(e.beacon_id(b), bobs.id()));
+      for (int k = 0; k < e.num_obs(); k++) {
+        assert(e.value(b, k) == bobs.m_values[k].m_value);
+        assert(e.flag1(b, k) == bobs.m_values[k].m_flag1);
+        assert(e.flag2(b, k) == bobs.m_values[k].m_flag2);
+      }
+    }
+    records += e.num_beacons();
+  }
+
+  /* epochs in a time interval */
+  if (ref.size() > 4) {
+    const auto r = data.between(ref[1].mheader.m_epoch, ref[4].mheader.m_epoch);
+    assert(r.size() == 3);
+    assert(r[0].epoch() == ref[1].mheader.m_epoch);
+    assert(r.begin() + 3 == r.end());
+    assert(data.between(ref[4].mheader.m_epoch, ref[1].mheader.m_epoch)
+               .empty());
+  }
+
+  /* records of a beacon */
+  {
+    const char *id = ref[0].mbeacon_obs[0].id();
+    const auto recs = data.beacon(id);
+    std::size_t n = 0;
+    for (const auto &block : ref)
+      for (const auto &b : block.mbeacon_obs)
+        if (!std::strcmp(b.id(), id)) {
+          assert(recs[n].epoch() == block.mheader.m_epoch);
+          assert(recs[n].value(0) == b.m_values[0].m_value);
+          ++n;
+        }
+    assert(recs.size() == n);
+    assert(data.beacon("X99").empty());
+  }
+
+  /* epochs without beacons, in the middle and last */
+  {
+    std::ifstream fin(argv[1], std::ios_base::binary);
+    const std::string content((std::istreambuf_iterator<char>(fin)),
+                              std::istreambuf_iterator<char>());
+    std::vector<std::size_t> at;
+    for (auto p = content.find("\n>", content.find("END OF HEADER"));
+         p != std::string::npos; p = content.find("\n>", p + 1))
+      at.push_back(p + 1);
+    assert(at.size() == data.size() && at.size() > 4);
+    auto no_beacons = [&](std::size_t from) {
+      std::string rec = content.substr(from, content.find('\n', from) - from);
+      rec.replace(34, 3, "  0");
+      return rec + "\n";
+    };
+    const std::string zero = content.substr(0, at[2]) + no_beacons(at[2]) +
+                             content.substr(at[3], at.back() - at[3]) +
+                             no_beacons(at.back());
+    DorisObsReader<> reader(DorisObsRinex(
+        std::make_unique<doris_rnx::MemorySource>(zero.data(), zero.size()),
+        "no beacons"));
+    doris_rnx::LoadedRinex<> z(reader);
+    const std::size_t n = z.size();
+    assert(n == data.size());
+    for (std::size_t i = 0; i < n; i++) {
+      assert(z[i].epoch() == data[i].epoch());
+      assert(z[i].header().m_num_stations == z[i].num_beacons());
+    }
+    assert(!z[2].num_beacons() && !z[n - 1].num_beacons());
+    assert(z[3].num_beacons() == data[3].num_beacons());
+    const auto r = z.between(data[2].epoch(), data[n - 1].epoch());
+    assert(r.size() == n - 3 && !r[0].num_beacons());
+  }
+
+  /* epochs processed in parallel */
+  double serial = 0e0;
+  for (const auto &e : data) serial += epoch_sum(e);
+  std::vector<double> sums(data.size());
+#ifdef RNX_HAVE_PARALLEL_STL
+  std::for_each(std::execution::par, data.begin(), data.end(),
+                [&](const doris_rnx::EpochView<double> &e) {
+                  sums[&e - &data[0]] = epoch_sum(e);
+                });
+#else
+  {
+    /* threads split the epochs by index */
+    const unsigned nt = 4;
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < nt; t++)
+      pool.emplace_back([&, t]() {
+        for (std::size_t i = t; i < data.size(); i += nt)
+          sums[i] = epoch_sum(data[i]);
+      });
+    for (auto &t : pool) t.join();
+  }
+#endif
+  double parallel = 0e0;
+  for (const auto s : sums) parallel += s;
+  assert(parallel == serial);
+
+  /* views survive a move */
+  const auto first = data[0];
+  doris_rnx::LoadedRinex<> moved(std::move(data));
+  assert(moved[0].value(0, 0) == first.value(0, 0));
+
+  printf("Loaded tests ok for %d epochs, %d records\n", (int)moved.size(),
+         (int)records);
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_mixed_table.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ref.push_back(*it);
+  }
+
+  DorisObsReader<> reader(argv[1]);
+  const auto &hdr = reader.header();
+  const int num_obs = hdr.obs_codes().size();
+  const auto &scale = hdr.obs_scale_factors();
+
+  /* default precisions, then with fixed-point phases */
+  std::vector<doris_rnx::ColumnPrecision> precisions;
+  for (const auto &code : hdr.obs_codes())
+    precisions.push_back(code.m_type == DorisObservationType::phase
+                             ? doris_rnx::ColumnPrecision::fixed
+                             : doris_rnx::default_precision(code));
+
+  for (int pass = 0; pass < 2; pass++) {
+    doris_rnx::MixedPrecisionTable table =
+        pass ? doris_rnx::MixedPrecisionTable(hdr, precisions)
+             : doris_rnx::MixedPrecisionTable(hdr);
+    reader.rewind();
+    while (!reader.next(table))
+      ;
+    assert(table.num_epochs() == ref.size());
+
+    std::size_t row = 0;
+    for (const auto &block : ref) {
+      for (const auto &b : block.mbeacon_obs) {
+        assert(!std::strcmp(table.beacon_id(row), b.id()));
+        assert(table.epoch(row).m_epoch == block.mheader.m_epoch);
+        for (int k = 0; k < num_obs; k++) {
+          const auto &y = b.m_values[k];
+          const double x = table.value(row, k);
+          assert(table.flag1(row, k) == y.m_flag1);
+          assert(table.flag2(row, k) == y.m_flag2);
+          if (y.m_value == doris_rnx::OBSERVATION_VALUE_MISSING / scale[k]) {
+            assert(table.missing(row, k) && x == y.m_value);
+            continue;
+          }
+          assert(!table.missing(row, k));
+          switch (table.precision(k)) {
+            case doris_rnx::ColumnPrecision::float32:
+              assert(table.float32_values(k) && !table.float64_values(k));
+              assert(std::abs(x - y.m_value) <= 1e-6 * std::abs(y.m_value));
+              break;
+            case doris_rnx::ColumnPrecision::float64:
+              assert(table.float64_values(k)[row] == y.m_value);
+              assert(x == y.m_value);
+              break;
+            case doris_rnx::ColumnPrecision::fixed:
+              assert(table.fixed_values(k) && x == y.m_value);
+              break;
+          }
+        }
+        ++row;
+      }
+    }
+    assert(row == table.num_rows());
+
+    /* float32 columns take half the memory of doubles */
+    int num_float32 = 0;
+    for (int k = 0; k < num_obs; k++)
+      num_float32 +=
+          (table.precision(k) == doris_rnx::ColumnPrecision::float32);
+    assert(table.value_bytes() ==
+           row * (8 * num_obs - 4 * num_float32));
+    printf("Mixed precision table (%d float32 columns): %.1f bytes of values "
+           "per record (%d as DataBlock)\n",
+           num_float32, (double)table.value_bytes() / row,
+           (int)(num_obs * sizeof(doris_rnx::RinexObservationValue)));
+  }
+
+  printf("Mixed precision tests ok for %d epochs\n", (int)ref.size());
+  return 0;
+}
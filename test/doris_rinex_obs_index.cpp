@@ -0,0 +1,63 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_policy.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx(argv[1]);
+  const auto &hdr = rnx.header();
+  const auto &codes = hdr.obs_codes();
+
+  /* same as a linear search */
+  for (std::size_t k = 0; k < codes.size(); k++) {
+    const auto it = std::find(codes.begin(), codes.end(), codes[k]);
+    assert(hdr.obs_index(codes[k]) == (int)(it - codes.begin()));
+  }
+
+  /* observables not recorded */
+  {
+    const std::vector<DorisObservationCode> some = {
+        DorisObservationCode{DorisObservationType::pseudorange, 2},
+        DorisObservationCode{DorisObservationType::ground_pressure}};
+    const doris_rnx::ObservationColumns columns(some);
+    assert(columns(some[0]) == 0 && columns(some[1]) == 1);
+    assert(columns(DorisObservationCode{DorisObservationType::phase, 1}) < 0);
+    assert(columns(DorisObservationCode{DorisObservationType::pseudorange,
+                                        1}) < 0);
+    assert(doris_rnx::ObservationColumns()(some[0]) < 0);
+  }
+
+  /* data blocks (array of structs and struct of arrays) */
+  DorisObsReader<doris_rnx::Trusted> reader(argv[1]);
+  doris_rnx::ObservationMatrix<double> m;
+  int epochs = 0;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it, ++epochs) {
+    const auto &block = *it;
+    assert(!reader.next(m));
+    for (std::size_t b = 0; b < block.mbeacon_obs.size(); b++) {
+      for (std::size_t k = 0; k < codes.size(); k++) {
+        const int col = hdr.obs_index(codes[k]);
+        assert(block.column(codes[k]) == col && m.column(codes[k]) == col);
+        assert(block.value(b, codes[k]) ==
+               &block.mbeacon_obs[b].m_values[col]);
+        assert(*m.value(b, codes[k]) == m.value(b, col));
+      }
+    }
+  }
+  assert(epochs > 0);
+
+  printf("Observable index tests ok for %d epochs\n", epochs);
+  return 0;
+}
@@ -0,0 +1,205 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_pipeline.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+using doris_rnx::epoch_to_ns;
+
+/* blocks kept by the filter */
+bool keep(const doris_rnx::DataBlock &b) {
+  return b.mheader.m_flag <= 1 && b.mbeacon_obs.size() > 1;
+}
+
+/* pass segmentation: a new pass starts after a gap of more than 30 sec;
+ * needs blocks in order
+ */
+struct PassCounter {
+  std::map<std::string, std::int64_t> m_last;
+  std::map<std::string, int> m_passes;
+  void operator()(const doris_rnx::DataBlock &b) {
+    const auto t = epoch_to_ns(b.mheader.m_epoch);
+    for (const auto &bobs : b.mbeacon_obs) {
+      const auto it = m_last.find(bobs.id());
+      if (it == m_last.end() || t - it->second > 30000000000L)
+        ++m_passes[bobs.id()];
+      m_last[bobs.id()] = t;
+    }
+  }
+};
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref, kept;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ref.push_back(*it);
+  }
+  PassCounter ref_passes;
+  for (const auto &b : ref)
+    if (keep(b)) {
+      kept.push_back(b);
+      ref_passes(b);
+    }
+  assert(!kept.empty() && kept.size() < ref.size());
+
+  DorisObsReader<> reader(argv[1]);
+  for (std::size_t capacity : {1, 4, 64}) {
+    reader.rewind();
+    PassCounter passes;
+    std::vector<Datetime<nanoseconds>> order;
+    doris_rnx::ObservationTable<double> table;
+    doris_rnx::Pipeline p(doris_rnx::next_source(reader), capacity);
+    p.transform([](doris_rnx::DataBlock &b) { return keep(b); }, 4)
+        /* a combination, in place */
+        .transform(
+            [](doris_rnx::DataBlock &b) {
+              for (auto &bobs : b.mbeacon_obs)
+                bobs.m_values[0].m_value -= bobs.m_values[1].m_value;
+              return true;
+            },
+            3)
+        .sink([&](const doris_rnx::DataBlock &b) {
+          passes(b);
+          order.push_back(b.mheader.m_epoch);
+        })
+        .sink(doris_rnx::storage_sink(table));
+    assert(p.num_stages() == 4);
+    p.run();
+
+    /* single-threaded stages saw blocks in order */
+    assert(order.size() == kept.size());
+    for (std::size_t i = 0; i < kept.size(); i++)
+      assert(order[i] == kept[i].mheader.m_epoch);
+    assert(passes.m_passes == ref_passes.m_passes);
+
+    /* values, as transformed */
+    assert(table.num_epochs() == kept.size());
+    std::size_t row = 0;
+    for (const auto &b : kept)
+      for (const auto &bobs : b.mbeacon_obs) {
+        assert(!std::strcmp(table.beacon_id(row), bobs.id()));
+        assert(table.value(row, 0) ==
+               bobs.m_values[0].m_value - bobs.m_values[1].m_value);
+        for (int k = 1; k < table.num_obs(); k++)
+          assert(table.value(row, k) == bobs.m_values[k].m_value);
+        ++row;
+      }
+    assert(row == table.num_rows());
+
+    const auto &stats = p.stats();
+    assert(stats.size() == 5);
+    assert(stats[0].m_blocks_out == ref.size());
+    assert(stats[1].m_blocks_in == ref.size());
+    assert(stats[1].m_blocks_out == kept.size());
+    for (int s = 2; s < 5; s++)
+      assert(stats[s].m_blocks_in == kept.size() &&
+             stats[s].m_blocks_out == kept.size());
+  }
+
+  /* backpressure: a slow sink holds back the source */
+  {
+    reader.rewind();
+    std::size_t n = 0;
+    doris_rnx::Pipeline p(doris_rnx::next_source(reader), 2);
+    p.sink([&](const doris_rnx::DataBlock &) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      ++n;
+    });
+    p.run();
+    assert(n == ref.size());
+    assert(p.stats()[0].m_full_waits > 0);
+  }
+
+  /* a block held up before an ordered stage: blocks after it are kept
+   * aside, but the source is held back, so that they are bounded (by the
+   * queue capacity plus the threads feeding the queue)
+   */
+  {
+    reader.rewind();
+    const std::size_t capacity = 4;
+    const int threads = 4;
+    std::atomic<std::size_t> passed{0};
+    std::size_t passed_while_held = 0;
+    std::vector<Datetime<nanoseconds>> order;
+    doris_rnx::Pipeline p(doris_rnx::next_source(reader), capacity);
+    p.transform(
+         [&](doris_rnx::DataBlock &b) {
+           if (b.mheader.m_epoch == ref[0].mheader.m_epoch) {
+             std::this_thread::sleep_for(std::chrono::milliseconds(50));
+             passed_while_held = passed;
+           } else {
+             ++passed;
+           }
+           return true;
+         },
+         threads)
+        .sink([&](const doris_rnx::DataBlock &b) {
+          order.push_back(b.mheader.m_epoch);
+        });
+    p.run();
+    assert(order.size() == ref.size());
+    for (std::size_t i = 0; i < ref.size(); i++)
+      assert(order[i] == ref[i].mheader.m_epoch);
+    assert(passed_while_held < capacity + threads);
+    assert(p.stats()[0].m_full_waits > 0);
+  }
+
+  /* a stage failing stops the run; its exception is rethrown */
+  {
+    reader.rewind();
+    std::atomic<int> n{0};
+    doris_rnx::Pipeline p(doris_rnx::next_source(reader), 4);
+    p.transform(
+         [&](doris_rnx::DataBlock &) {
+           if (++n == 10) throw std::runtime_error("stage failed");
+           return true;
+         },
+         2)
+        .sink([](const doris_rnx::DataBlock &) {});
+    bool thrown = false;
+    try {
+      p.run();
+    } catch (const std::runtime_error &e) {
+      thrown = !std::strcmp(e.what(), "stage failed");
+    }
+    assert(thrown);
+  }
+
+  /* no stages: blocks are just read */
+  {
+    reader.rewind();
+    doris_rnx::Pipeline p(doris_rnx::next_source(reader));
+    p.run();
+    assert(p.stats()[0].m_blocks_out == ref.size());
+  }
+
+  bool thrown = false;
+  try {
+    doris_rnx::Pipeline(doris_rnx::next_source(reader)).sink({}, 0);
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  printf("Pipeline tests ok for %d epochs (%d kept)\n", (int)ref.size(),
+         (int)kept.size());
+  return 0;
+}
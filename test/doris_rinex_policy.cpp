@@ -0,0 +1,167 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_policy.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* seconds elapsed while calling f */
+template <typename F> double timed(F &&f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ref.push_back(*it);
+  }
+  assert(ref.size() > 2);
+
+  DorisObsReader<> checked(argv[1]);
+  DorisObsReader<doris_rnx::Trusted> trusted(argv[1]);
+  const auto &scale = checked.header().obs_scale_factors();
+  const int num_obs = scale.size();
+
+  /* checked, array of structs (double): same as DorisObsRinex */
+  {
+    doris_rnx::DataBlock block;
+    std::size_t i = 0;
+    for (; !checked.next(block); ++i) {
+      assert(i < ref.size());
+      assert(block.mheader.m_epoch == ref[i].mheader.m_epoch);
+      assert(block.mbeacon_obs.size() == ref[i].mbeacon_obs.size());
+      for (std::size_t b = 0; b < block.mbeacon_obs.size(); b++) {
+        const auto &x = block.mbeacon_obs[b];
+        const auto &y = ref[i].mbeacon_obs[b];
+        assert(!std::strcmp(x.id(), y.id()));
+        for (int k = 0; k < num_obs; k++) {
+          assert(x.m_values[k].m_value == y.m_values[k].m_value);
+          assert(x.m_values[k].m_flag1 == y.m_values[k].m_flag1);
+          assert(x.m_values[k].m_flag2 == y.m_values[k].m_flag2);
+        }
+      }
+    }
+    assert(i == ref.size());
+  }
+
+  /* trusted, struct of arrays (double and float) */
+  {
+    doris_rnx::ObservationMatrix<double> m;
+    doris_rnx::ObservationMatrix<float> f;
+    DorisObsReader<doris_rnx::Trusted> &r = trusted;
+    for (std::size_t i = 0; i < ref.size(); i++) {
+      assert(!r.next(m));
+      assert(m.mheader.m_epoch == ref[i].mheader.m_epoch);
+      assert(m.num_beacons() == (int)ref[i].mbeacon_obs.size());
+      for (int b = 0; b < m.num_beacons(); b++) {
+        const auto &y = ref[i].mbeacon_obs[b];
+        assert(!std::strcmp(m.beacon_id(b), y.id()));
+        for (int k = 0; k < num_obs; k++) {
+          assert(m.value(b, k) == y.m_values[k].m_value);
+          assert(m.flag1(b, k) == y.m_values[k].m_flag1);
+          assert(m.flag2(b, k) == y.m_values[k].m_flag2);
+        }
+      }
+    }
+    assert(r.next(m) < 0);
+
+    r.rewind();
+    for (std::size_t i = 0; i < ref.size(); i++) {
+      assert(!r.next(f));
+      for (int b = 0; b < f.num_beacons(); b++) {
+        for (int k = 0; k < num_obs; k++) {
+          const double y = ref[i].mbeacon_obs[b].m_values[k].m_value;
+          if (y == doris_rnx::OBSERVATION_VALUE_MISSING / scale[k]) continue;
+          assert(std::abs(f.value(b, k) - y) <= 1e-6 * std::abs(y) + 1e-30);
+        }
+      }
+    }
+  }
+
+  /* fixed point, via a callback: exact */
+  {
+    /* reference values, in the order parsed */
+    std::vector<double> values;
+    for (const auto &block : ref)
+      for (const auto &b : block.mbeacon_obs)
+        for (const auto &v : b.m_values) values.push_back(v.m_value);
+
+    trusted.rewind();
+    std::size_t i = 0;
+    auto storage = doris_rnx::callback_storage<doris_rnx::FixedPoint>(
+        [&](const doris_rnx::RinexDataRecordHeader &, const char *, int k,
+            const doris_rnx::BasicObservationValue<doris_rnx::FixedPoint>
+                &v) {
+          assert(i < values.size());
+          const double y = values[i++];
+          if (v.m_value ==
+              doris_rnx::ValueTraits<doris_rnx::FixedPoint>::missing()) {
+            assert(y == doris_rnx::OBSERVATION_VALUE_MISSING / scale[k]);
+          } else {
+            assert(std::abs(v.m_value.to_double(scale[k]) - y) <=
+                   1e-12 * std::abs(y));
+          }
+        });
+    while (!trusted.next(storage))
+      ;
+    assert(i == values.size());
+  }
+
+  /* a malformed beacon line: checked fails, trusted reads through */
+  {
+    std::ifstream fin(argv[1], std::ios_base::binary);
+    std::string content((std::istreambuf_iterator<char>(fin)),
+                        std::istreambuf_iterator<char>());
+    const auto pos = content.rfind("\nD");
+    content[pos + 1] = 'X';
+    auto source = [&] {
+      return std::make_unique<doris_rnx::MemorySource>(content.data(),
+                                                       content.size());
+    };
+    DorisObsReader<> c{DorisObsRinex(source())};
+    DorisObsReader<doris_rnx::Trusted> t{DorisObsRinex(source())};
+    doris_rnx::ObservationMatrix<double> m;
+    int status;
+    std::size_t n = 0;
+    while (!(status = c.next(m))) ++n;
+    assert(status > 0 && n == ref.size() - 1);
+    for (n = 0; !(status = t.next(m)); ++n)
+      ;
+    assert(status < 0 && n == ref.size());
+  }
+
+  /* timing */
+  doris_rnx::DataBlock block;
+  doris_rnx::ObservationMatrix<double> m;
+  checked.rewind();
+  trusted.rewind();
+  const double t1 = timed([&] { while (!checked.next(block)); });
+  const double t2 = timed([&] { while (!trusted.next(m)); });
+  printf("Policy tests ok for %d epochs (checked/AoS %.4fs, trusted/SoA "
+         "%.4fs)\n",
+         (int)ref.size(), t1, t2);
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include "doris_rinex.hpp"
+#include <cstdio>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc!=2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx (argv[1]);
+
+  /* collect all epochs, reading the file sequentially */
+  std::vector<Datetime<nanoseconds>> epochs;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) {
+    epochs.push_back(it->mheader.m_epoch);
+  }
+  assert(!epochs.empty());
+
+  /* walk the file backwards */
+  int i = (int)epochs.size();
+  for (auto it = rnx.rbegin(); it != rnx.rend(); ++it) {
+    --i;
+    assert(i >= 0);
+    assert(it->mheader.m_epoch == epochs[i]);
+  }
+  assert(i == 0);
+
+  /* walk forward and back again, using a bidirectional iterator */
+  auto it = rnx.bbegin();
+  i = 0;
+  for (; it != rnx.bend(); ++it) {
+    assert(it->mheader.m_epoch == epochs[i]);
+    ++i;
+  }
+  assert(i == (int)epochs.size());
+  do {
+    --it;
+    --i;
+    assert(it->mheader.m_epoch == epochs[i]);
+  } while (i);
+  assert(it == rnx.bbegin());
+  assert(--it == rnx.bend());
+
+  printf("Reverse/Bidirectional iteration ok for %d epochs\n",
+         (int)epochs.size());
+
+  return 0;
+}
@@ -0,0 +1,48 @@
+#include "doris_rinex.hpp"
+#include <cstdio>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+int main(int argc, char *argv[]) {
+  if (argc!=2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx (argv[1]);
+
+  /* collect all epochs, reading the file sequentially */
+  std::vector<Datetime<nanoseconds>> epochs;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) {
+    epochs.push_back(it->mheader.m_epoch);
+  }
+  assert(!epochs.empty());
+
+  /* seeking to any epoch should give the same block */
+  for (int i = 0; i < (int)epochs.size(); i++) {
+    auto it = rnx.seek(epochs[i]);
+    assert(it != rnx.end());
+    assert(it->mheader.m_epoch == epochs[i]);
+    /* and we should be able to go on from there */
+    int count = 0;
+    for (; it != rnx.end(); ++it) ++count;
+    assert(count == (int)epochs.size() - i);
+  }
+
+  /* seeking before the first epoch gives the first block */
+  auto it = rnx.seek(epochs[0].add_seconds(nanoseconds(-1)));
+  assert(it != rnx.end() && it->mheader.m_epoch == epochs[0]);
+
+  /* seeking past the last epoch gives end() */
+  it = rnx.seek(epochs.back().add_seconds(nanoseconds(1)));
+  assert(it == rnx.end());
+
+  printf("Seek tests ok for %d epochs\n", (int)epochs.size());
+
+  return 0;
+}
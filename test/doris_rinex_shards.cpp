@@ -0,0 +1,188 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_shards.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+/* what a shard saw of a beacon: epochs and first value, in order */
+struct Track {
+  std::vector<Datetime<nanoseconds>> m_epochs;
+  std::vector<double> m_values;
+};
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference tracks, per beacon id */
+  std::map<std::string, Track> ref;
+  std::size_t num_records = 0;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it)
+      for (const auto &bobs : it->mbeacon_obs) {
+        ref[bobs.id()].m_epochs.push_back(it->mheader.m_epoch);
+        ref[bobs.id()].m_values.push_back(bobs.m_values[0].m_value);
+        ++num_records;
+      }
+  }
+
+  DorisObsReader<> reader(argv[1]);
+
+  /* interned beacons: the header ones first, in order */
+  {
+    doris_rnx::BeaconIndex index(reader.header());
+    const auto &stations = reader.header().stations();
+    assert(index.size() == (int)stations.size());
+    for (int i = 0; i < index.size(); i++) {
+      assert(index.find(stations[i].code()) == i);
+      assert(!std::strcmp(index.id(i), stations[i].code()));
+    }
+    assert(index.find("X99") < 0);
+    assert(index.intern("X99") == (int)stations.size());
+    assert(index.intern("X99") == (int)stations.size());
+    assert(index.find("X99") == (int)stations.size());
+  }
+
+  for (int num_shards : {1, 3, 8}) {
+    reader.rewind();
+    /* state owned by every shard: tracks per beacon, and its thread */
+    std::vector<std::map<int, Track>> tracks(num_shards);
+    std::vector<std::thread::id> owners(num_shards);
+    doris_rnx::BeaconShards shards(
+        reader.header(), num_shards,
+        [&](int shard, const doris_rnx::BeaconRecord &r) {
+          if (owners[shard] == std::thread::id())
+            owners[shard] = std::this_thread::get_id();
+          assert(owners[shard] == std::this_thread::get_id());
+          assert(r.m_beacon % num_shards == shard);
+          auto &t = tracks[shard][r.m_beacon];
+          t.m_epochs.push_back(r.m_header->m_epoch);
+          t.m_values.push_back(r.m_obs->m_values[0].m_value);
+        },
+        4);
+    shards.run(doris_rnx::next_source(reader));
+
+    /* every beacon seen by a single shard, in order */
+    std::size_t n = 0;
+    for (int s = 0; s < num_shards; s++) {
+      for (const auto &it : tracks[s]) {
+        const auto &r = ref.at(shards.beacons().id(it.first));
+        assert(it.second.m_epochs == r.m_epochs);
+        assert(it.second.m_values == r.m_values);
+      }
+      n += tracks[s].size();
+      assert(shards.records()[s] ==
+             [&]() {
+               std::size_t c = 0;
+               for (const auto &it : tracks[s]) c += it.second.m_epochs.size();
+               return c;
+             }());
+    }
+    assert(n == ref.size());
+    std::size_t total = 0;
+    for (const auto c : shards.records()) total += c;
+    assert(total == num_records);
+  }
+
+  /* a beacon not in the header: interned while shards run, with an index
+   * past the header ones; shards grow their own state for it
+   */
+  {
+    std::ifstream fin(argv[1], std::ios_base::binary);
+    std::string content((std::istreambuf_iterator<char>(fin)),
+                        std::istreambuf_iterator<char>());
+    const auto &stations = reader.header().stations();
+    const int num_stations = stations.size();
+    assert(doris_rnx::BeaconIndex(reader.header()).find("D99") < 0);
+    /* the first data line of the 3rd block */
+    std::size_t at = content.find("END OF HEADER");
+    for (int i = 0; i < 3; i++) at = content.find("\n>", at) + 1;
+    at = content.find('\n', at) + 1;
+    const std::string old_id = content.substr(at, 3);
+    content.replace(at, 3, "D99");
+
+    DorisObsReader<> xreader(DorisObsRinex(
+        std::make_unique<doris_rnx::MemorySource>(content.data(),
+                                                  content.size()),
+        "unknown beacon"));
+    const int num_shards = 3;
+    std::vector<std::vector<std::size_t>> state(num_shards);
+    std::atomic<int> rejected{0};
+    doris_rnx::BeaconShards shards(
+        xreader.header(), num_shards,
+        [&](int shard, const doris_rnx::BeaconRecord &r) {
+          assert(r.m_beacon < r.m_num_beacons &&
+                 r.m_num_beacons >= num_stations);
+          auto &st = state[shard];
+          if (r.m_beacon >= (int)st.size()) st.resize(r.m_num_beacons);
+          ++st[r.m_beacon];
+          if (!std::strcmp(r.m_obs->id(), "D99")) {
+            assert(r.m_beacon == num_stations);
+            try {
+              shards.beacons();
+            } catch (const std::runtime_error &) {
+              ++rejected;
+            }
+          }
+        });
+    shards.run(doris_rnx::next_source(xreader));
+    assert(rejected == 1);
+
+    const auto &index = shards.beacons();
+    assert(index.size() == num_stations + 1);
+    assert(!std::strcmp(index.id(num_stations), "D99"));
+    const int s = num_stations % num_shards;
+    assert((int)state[s].size() > num_stations && state[s][num_stations] == 1);
+    /* the beacon it replaced lost a record */
+    const int b = index.find(old_id.c_str());
+    assert(state[b % num_shards][b] + 1 == ref.at(old_id).m_epochs.size());
+  }
+
+  /* a handler failing stops the run; its exception is rethrown */
+  {
+    reader.rewind();
+    doris_rnx::BeaconShards shards(
+        reader.header(), 2,
+        [&](int, const doris_rnx::BeaconRecord &r) {
+          if (r.m_beacon % 2) throw std::runtime_error("handler failed");
+        },
+        1);
+    bool thrown = false;
+    try {
+      shards.run(doris_rnx::next_source(reader));
+    } catch (const std::runtime_error &e) {
+      thrown = !std::strcmp(e.what(), "handler failed");
+    }
+    assert(thrown);
+  }
+
+  bool thrown = false;
+  try {
+    doris_rnx::BeaconShards(reader.header(), 0,
+                            [](int, const doris_rnx::BeaconRecord &) {});
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  printf("Shard tests ok for %d beacons, %d records\n", (int)ref.size(),
+         (int)num_records);
+  return 0;
+}
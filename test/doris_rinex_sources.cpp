@@ -0,0 +1,87 @@
+#include "doris_rinex.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+std::vector<Datetime<nanoseconds>> epochs_of(DorisObsRinex &rnx) {
+  std::vector<Datetime<nanoseconds>> epochs;
+  for (auto it = rnx.begin(); it != rnx.end(); ++it) {
+    epochs.push_back(it->mheader.m_epoch);
+  }
+  return epochs;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc!=2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  DorisObsRinex rnx (argv[1]);
+  const auto epochs = epochs_of(rnx);
+  assert(!epochs.empty());
+
+  /* whole file in memory */
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  /* read from a memory buffer */
+  {
+    DorisObsRinex mrnx(std::make_unique<doris_rnx::MemorySource>(
+        content.data(), content.size()));
+    assert(epochs_of(mrnx) == epochs);
+    /* memory is seekable */
+    assert(mrnx.rbegin()->mheader.m_epoch == epochs.back());
+  }
+
+  /* read from a user-supplied reader, in (tiny) chunks */
+  {
+    std::size_t at = 0;
+    auto reader = [&](char *buf, std::size_t n) -> std::size_t {
+      n = std::min(n, std::min((std::size_t)7, content.size() - at));
+      std::memcpy(buf, content.data() + at, n);
+      at += n;
+      return n;
+    };
+    DorisObsRinex rrnx(std::make_unique<doris_rnx::ReaderSource>(reader, 100));
+    assert(epochs_of(rrnx) == epochs);
+  }
+
+  /* read from a pipe */
+  {
+    FILE *p = popen((std::string("cat ") + argv[1]).c_str(), "r");
+    assert(p);
+    DorisObsRinex prnx(std::make_unique<doris_rnx::FdSource>(fileno(p)));
+    assert(epochs_of(prnx) == epochs);
+    pclose(p);
+  }
+
+  /* file with a small buffer; seeking goes through the source */
+  {
+    DorisObsRinex frnx(std::make_unique<doris_rnx::FileSource>(argv[1], 64));
+    assert(epochs_of(frnx) == epochs);
+    const int mid = epochs.size() / 2;
+    auto it = frnx.seek(epochs[mid]);
+    assert(it != frnx.end() && it->mheader.m_epoch == epochs[mid]);
+    int i = epochs.size();
+    for (auto rit = frnx.rbegin(); rit != frnx.rend(); ++rit)
+      assert(rit->mheader.m_epoch == epochs[--i]);
+    assert(!i);
+  }
+
+  printf("Input source tests ok for %d epochs\n", (int)epochs.size());
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_watch.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+
+void write_file(const std::string &fn, const std::string &content) {
+  std::ofstream fout(fn, std::ios_base::binary);
+  fout << content;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference */
+  long expected = 0;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ++expected;
+  }
+  std::ifstream fin(argv[1], std::ios_base::binary);
+  const std::string content((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+
+  char tmpl[] = "/tmp/doris_rinex_watchXXXXXX";
+  assert(mkdtemp(tmpl));
+  const std::string dir(tmpl);
+
+  /* one file already there */
+  write_file(dir + "/existing.001", content);
+
+  std::mutex mtx;
+  std::set<std::string> seen;
+  std::atomic<int> wrong{0};
+  doris_rnx::WatchOptions opts;
+  opts.m_num_threads = 2;
+  opts.m_max_pending = 2;
+  opts.m_scan_existing = true;
+  doris_rnx::DirectoryWatcher watcher(
+      {dir},
+      [&](const std::string &path, DorisObsRinex &rnx) {
+        long n = 0;
+        for (auto it = rnx.begin(); it != rnx.end(); ++it) ++n;
+        if (n != expected) ++wrong;
+        std::lock_guard<std::mutex> lock(mtx);
+        seen.insert(path.substr(dir.size() + 1));
+      },
+      opts);
+
+  /* written before run(); must not be missed */
+  write_file(dir + "/early.rnx", content);
+
+  int failed = -1;
+  std::thread t([&] { failed = watcher.run(); });
+
+  /* written in place, moved in, not matching */
+  write_file(dir + "/inplace.001", content);
+  write_file(dir + "/tmp.part", content);
+  assert(!std::rename((dir + "/tmp.part").c_str(),
+                      (dir + "/moved.001").c_str()));
+  write_file(dir + "/ignored.txt", content);
+  for (int i = 0; i < 8; i++)
+    write_file(dir + "/many" + std::to_string(i) + ".001", content);
+
+  /* corrupt files: not RINEX, and a bad first block; they fail, without
+   * stopping the watcher
+   */
+  write_file(dir + "/corrupt.001", "this is not a RINEX file\n");
+  std::string badblock = content;
+  badblock[badblock.find('>', badblock.find("END OF HEADER")) + 2] = 'x';
+  write_file(dir + "/badblock.001", badblock);
+
+  const std::size_t num_expected = 4 + 8;
+  const long num_corrupt = 2;
+  for (int i = 0; i < 500; i++) {
+    if (watcher.files_processed() >= (long)num_expected + num_corrupt) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  watcher.stop();
+  t.join();
+
+  assert(failed == num_corrupt && !wrong);
+  assert(seen.size() == num_expected);
+  assert(seen.count("existing.001") && seen.count("early.rnx") &&
+         seen.count("inplace.001") && seen.count("moved.001"));
+  assert(!seen.count("ignored.txt") && !seen.count("corrupt.001") &&
+         !seen.count("badblock.001"));
+  assert(watcher.files_processed() == (long)num_expected + num_corrupt);
+  assert(watcher.files_failed() == num_corrupt);
+
+  for (const auto &name : {"existing.001", "early.rnx", "inplace.001",
+                           "moved.001", "ignored.txt", "corrupt.001",
+                           "badblock.001"})
+    std::remove((dir + "/" + name).c_str());
+  for (int i = 0; i < 8; i++)
+    std::remove((dir + "/many" + std::to_string(i) + ".001").c_str());
+  std::remove(dir.c_str());
+
+  printf("Watch tests ok for %d files\n", (int)seen.size());
+
+  return 0;
+}
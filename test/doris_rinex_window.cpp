@@ -0,0 +1,95 @@
+#include "doris_rinex.hpp"
+#include "doris_rinex_window.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+using namespace dso;
+using doris_rnx::epoch_to_ns;
+
+/* the window holds the latest blocks, within span and capacity */
+void check(const doris_rnx::ObservationWindow<> &w,
+           const std::vector<doris_rnx::DataBlock> &ref, std::size_t i,
+           double span, std::size_t capacity) {
+  std::size_t n = 1;
+  while (n < capacity && n <= i &&
+         epoch_to_ns(ref[i].mheader.m_epoch) -
+                 epoch_to_ns(ref[i - n].mheader.m_epoch) <=
+             (std::int64_t)(span * 1e9))
+    ++n;
+  assert(w.size() == n);
+  const int num_obs = ref[i].mbeacon_obs[0].m_values.size();
+  for (std::size_t age = 0; age < n; age++) {
+    const auto &block = ref[i - age];
+    assert(w.epoch(age) == block.mheader.m_epoch);
+    assert(w.block(age).num_beacons() == (int)block.mbeacon_obs.size());
+    for (const auto &b : block.mbeacon_obs) {
+      const int row = w.find_beacon(age, b.id());
+      assert(row >= 0 && !std::strcmp(w.block(age).beacon_id(row), b.id()));
+      for (int k = 0; k < num_obs; k++) {
+        /* a beacon may be listed twice in a block; the first one is found */
+        const auto &first = block.mbeacon_obs[row];
+        assert(*w.value(age, b.id(), k) == first.m_values[k].m_value);
+      }
+    }
+  }
+  assert(!w.value(0, "X99", 0));
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Error. Usage %s [DORIS RINEX]\n", argv[0]);
+    return 1;
+  }
+
+  /* reference blocks */
+  std::vector<doris_rnx::DataBlock> ref;
+  {
+    DorisObsRinex rnx(argv[1]);
+    for (auto it = rnx.begin(); it != rnx.end(); ++it) ref.push_back(*it);
+  }
+  assert(ref.size() > 4);
+  const double span =
+      (epoch_to_ns(ref[2].mheader.m_epoch) -
+       epoch_to_ns(ref[0].mheader.m_epoch)) *
+      1e-9;
+
+  for (std::size_t capacity : {1, 2, 5}) {
+    /* fed off the iterator */
+    {
+      DorisObsRinex rnx(argv[1]);
+      doris_rnx::ObservationWindow<> w(rnx.header(), span, capacity);
+      std::size_t i = 0;
+      for (auto it = rnx.begin(); it != rnx.end(); ++it, ++i) {
+        w.push(*it);
+        check(w, ref, i, span, capacity);
+      }
+    }
+
+    /* read into directly; no allocations once full */
+    {
+      DorisObsReader<> reader(argv[1]);
+      doris_rnx::ObservationWindow<> w(reader.header(), span, capacity);
+      /* the slots (one more than the capacity) are seen in turn */
+      std::set<const double *> slots;
+      std::size_t i = 0;
+      for (; !reader.next(w); ++i) {
+        check(w, ref, i, span, capacity);
+        const double *data = w.block(0).m_values.data();
+        if (i >= 10 && i < 10 + capacity + 1) slots.insert(data);
+        if (i >= 10 + capacity + 1) assert(slots.count(data));
+      }
+      assert(i == ref.size());
+    }
+  }
+
+  printf("Window tests ok for %d epochs (span %.1fs)\n", (int)ref.size(),
+         span);
+  return 0;
+}